@@ -0,0 +1,141 @@
+// -------------------------------------------------------
+// bench_commit — file I/O and COM calls of one commit, overlapped
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_commit [mb] [com_ms]          (default 64 100)
+//
+// Runs CommitPipeline on a [mb] MB part against FakeSw, a
+// stand-in for SwConnection whose property calls and thumbnail
+// each take [com_ms] ms (out-of-process COM calls into a busy
+// SolidWorks are of that order).  Each run writes new bytes to
+// the part first, so the file is really read and stored:
+//   file only    — no document side: the I/O alone
+//   COM only     — the FakeSw calls alone
+//   serial       — properties and thumbnail, then the pipeline
+//                  without them: the order before CommitPipeline
+//   overlapped   — the pipeline as CommitEngine runs it
+// overlapped should come close to max(file only, COM only).
+// -------------------------------------------------------
+
+#include "commit_pipeline.h"
+#include "repository.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+// The SwConnection methods DocumentSourceFor calls, each taking
+// latency_ms the way a round trip to SolidWorks does
+class FakeSw {
+public:
+    explicit FakeSw(int latency_ms) : latency_(latency_ms) {}
+
+    Result GetMassProperties(double& mass, double& volume, double& area) {
+        Wait();
+        mass = 1.25, volume = 0.00046, area = 0.031;
+        return Result::success();
+    }
+    Result GetFeatureCount(int& count) { Wait(); count = 42; return Result::success(); }
+    Result GetMaterial(std::string& material) { Wait(); material = "6061 Alloy"; return Result::success(); }
+    Result GetBoundingBox(double& x, double& y, double& z) {
+        Wait();
+        x = 120, y = 80, z = 25;
+        return Result::success();
+    }
+    Result GetConfigCount(int& count) { Wait(); count = 3; return Result::success(); }
+    Result SaveThumbnail(const std::string& dest) {
+        Wait();
+        std::ofstream(dest, std::ios::binary) << "BM";
+        return Result::success();
+    }
+
+private:
+    void Wait() const { std::this_thread::sleep_for(std::chrono::milliseconds(latency_)); }
+    int latency_;
+};
+
+int main(int argc, char** argv) {
+    int mb     = argc > 1 ? std::atoi(argv[1]) : 64;
+    int com_ms = argc > 2 ? std::atoi(argv[2]) : 100;
+    if (mb <= 0 || com_ms < 0) {
+        std::fprintf(stderr, "usage: bench_commit [mb] [com_ms]\n");
+        return 1;
+    }
+
+    fs::path root = fs::temp_directory_path() / "swvcs-bench-commit";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    const fs::path part = root / "bracket.SLDPRT";
+
+    std::mt19937      rng(1);
+    std::vector<char> bytes(static_cast<size_t>(mb) << 20);
+    auto write_part = [&] {
+        for (auto& b : bytes) b = static_cast<char>(rng());
+        std::ofstream(part, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    // Repository logs as it goes; keep it out of the timings
+    std::ostringstream sink;
+    auto* saved = std::cout.rdbuf(sink.rdbuf());
+
+    Repository repo(root);
+    if (!repo.IsValid()) std::abort();
+    FakeSw         sw(com_ms);
+    CommitPipeline pipeline(repo);
+
+    // One commit of freshly written bytes; com_first reads the
+    // document before the pipeline instead of alongside it
+    auto commit = [&](const DocumentSource& doc, bool com_first) {
+        write_part();
+        Commit c;
+        c.message     = "bench";
+        c.timestamp   = "2025-01-01T00:00:00Z";
+        c.parent_hash = repo.GetHead();
+        c.sw_meta.doc_path = part.string();
+        c.sw_meta.doc_type = "Part";
+        StoreStats stats;
+        auto t0 = Clock::now();
+        if (com_first) {
+            ReadProperties(sw, c.sw_meta);
+            sw.SaveThumbnail((root / "thumb.bmp").string());
+        }
+        if (!pipeline.Run(part, doc, c, stats).ok) std::abort();
+        return Seconds(t0);
+    };
+
+    double t_file = commit(DocumentSource{}, false);
+
+    auto t0 = Clock::now();
+    Commit::SwMeta meta;
+    ReadProperties(sw, meta);
+    sw.SaveThumbnail((root / "thumb.bmp").string());
+    double t_com = Seconds(t0);
+
+    double t_serial     = commit(DocumentSource{}, true);
+    double t_overlapped = commit(DocumentSourceFor(sw, true), false);
+    std::cout.rdbuf(saved);
+
+    std::printf("%d MB part, 6 COM calls of %d ms, %u threads\n\n", mb, com_ms,
+                ThreadPool::Shared().Size());
+    std::printf("file only   %8.1f ms\n", t_file * 1e3);
+    std::printf("COM only    %8.1f ms\n", t_com * 1e3);
+    std::printf("serial      %8.1f ms\n", t_serial * 1e3);
+    std::printf("overlapped  %8.1f ms\n", t_overlapped * 1e3);
+
+    fs::remove_all(root);
+    return 0;
+}
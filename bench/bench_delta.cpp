@@ -0,0 +1,156 @@
+// -------------------------------------------------------
+// bench_delta — delta mode vs full chunked snapshots
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_delta [size_mb] [revisions] [delta_chain]
+//                                   (default 64 20 8)
+//
+// Commits a series of revisions of one synthetic file (each a
+// few small edits and an insertion, like re-saving a part) into
+// two scratch repositories — delta_chain 0 and delta_chain N —
+// and reports, for each:
+//   stored  — bytes on disk in blobs/ + chunks/
+//   store   — time to store all revisions
+//   restore — mean and worst time to restore one revision
+// -------------------------------------------------------
+
+#include "blob_store.h"
+#include "repository.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+static uintmax_t DiskUsage(const fs::path& dir) {
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto& e : fs::recursive_directory_iterator(dir, ec))
+        if (e.is_regular_file()) total += e.file_size();
+    return total;
+}
+
+// Part-file-like content: runs of repeated records mixed with noise
+static std::string MakeFile(size_t size, std::mt19937_64& rng) {
+    std::string data;
+    data.reserve(size);
+    while (data.size() < size) {
+        if (rng() % 3 == 0) {
+            for (int i = 0; i < 256; ++i) data += static_cast<char>(rng());
+        } else {
+            std::string record = "feature" + std::to_string(rng() % 500) + ";";
+            for (int i = 0; i < 32; ++i) data += record;
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+static void Edit(std::string& data, std::mt19937_64& rng) {
+    for (int i = 0; i < 20; ++i)
+        data[rng() % data.size()] ^= 0x5a;
+    data.insert(rng() % data.size(), "inserted block " + std::to_string(rng()));
+}
+
+struct RunResult {
+    uintmax_t stored    = 0;
+    double    store_s   = 0;
+    double    mean_ms   = 0;
+    double    worst_ms  = 0;
+    bool      ok        = true;
+};
+
+static RunResult Run(const fs::path& dir, int delta_chain,
+                     const std::vector<std::string>& revisions) {
+    RunResult out;
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    Repository repo(dir);
+    repo.SetConfig("delta_chain", std::to_string(delta_chain));
+
+    BlobStore                store(repo);
+    std::vector<std::string> hashes;
+    std::string              parent;
+    fs::path                 work = dir / "part.bin";
+
+    auto t0 = Clock::now();
+    for (const auto& rev : revisions) {
+        std::ofstream(work, std::ios::binary | std::ios::trunc)
+            .write(rev.data(), static_cast<std::streamsize>(rev.size()));
+        StoreStats  stats;
+        std::string hash;
+        if (!store.Store(work, hash, stats, parent).ok) { out.ok = false; return out; }
+        hashes.push_back(hash);
+        parent = hash;
+    }
+    out.store_s = Seconds(t0);
+    out.stored  = DiskUsage(repo.BlobsDir()) + DiskUsage(repo.ChunksDir());
+
+    double total = 0;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        t0 = Clock::now();
+        if (!store.Restore(hashes[i], work).ok) { out.ok = false; return out; }
+        double ms = Seconds(t0) * 1000.0;
+        total        += ms;
+        out.worst_ms  = std::max(out.worst_ms, ms);
+
+        std::ifstream f(work, std::ios::binary);
+        std::string   back{std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+        if (back != revisions[i]) out.ok = false;
+    }
+    out.mean_ms = total / static_cast<double>(hashes.size());
+
+    fs::remove_all(dir, ec);
+    return out;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb   = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 64;
+    int    revisions = (argc > 2) ? std::atoi(argv[2]) : 20;
+    int    chain     = (argc > 3) ? std::atoi(argv[3]) : 8;
+    if (size_mb == 0)   size_mb   = 64;
+    if (revisions <= 0) revisions = 20;
+    if (chain <= 0)     chain     = 8;
+
+    std::mt19937_64          rng(42);
+    std::vector<std::string> revs;
+    revs.push_back(MakeFile(size_mb << 20, rng));
+    for (int i = 1; i < revisions; ++i) {
+        revs.push_back(revs.back());
+        Edit(revs.back(), rng);
+    }
+
+    fs::path scratch = fs::temp_directory_path() / "swvcs-bench-delta";
+    RunResult full  = Run(scratch, 0, revs);
+    RunResult delta = Run(scratch, chain, revs);
+
+    std::printf("%d revisions of %zu MB, delta_chain %d\n\n", revisions, size_mb, chain);
+    std::printf("%-8s %12s %10s %14s %14s\n", "mode", "stored", "store s", "restore ms", "worst ms");
+    auto row = [](const char* name, const RunResult& r) {
+        std::printf("%-8s %12s %10.2f %14.1f %14.1f%s\n", name,
+                    Utils::FormatBytes(r.stored).c_str(), r.store_s, r.mean_ms, r.worst_ms,
+                    r.ok ? "" : "  FAILED");
+    };
+    row("chunked", full);
+    row("delta",   delta);
+
+    if (full.stored > 0) {
+        std::printf("\ndelta saves %.1f%% of storage for %+.1f ms per restore (worst %+.1f ms)\n",
+                    100.0 * (1.0 - static_cast<double>(delta.stored) / full.stored),
+                    delta.mean_ms - full.mean_ms, delta.worst_ms - full.worst_ms);
+    }
+    return (full.ok && delta.ok) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// -------------------------------------------------------
+// bench_graph — ancestry queries with and without CommitGraph
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_graph [commits] [queries]     (default 200000 2000)
+//
+// Saves a history of [commits] commits into a scratch repository:
+// one long line with a side branch every 100 commits (what a
+// revert followed by a commit leaves behind).  Then reports:
+//   load       — CommitGraph::Load() building the side file from
+//                the database, and again mapping the written file
+//   before     — "is the root an ancestor of HEAD" answered the
+//                old way, one LoadCommit per parent_hash step
+//   after      — IsAncestor and MergeBase on the loaded graph, for
+//                random pairs of commits
+//   resave     — Load() after commits A, B, A (the file reverted to
+//                A and committed again), which rebuilds the graph;
+//                aborts unless its first-parent line from HEAD is
+//                the one LoadCommit gives
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "commit_graph.h"
+#include "content_hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+static std::string HashOf(int i) {
+    std::string seed = "commit " + std::to_string(i);
+    return ContentHasher::Of(HashAlgo::Sha256, seed.data(), seed.size());
+}
+
+int main(int argc, char** argv) {
+    int commits = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 2000;
+    if (commits <= 1 || queries <= 0) {
+        std::fprintf(stderr, "usage: bench_graph [commits] [queries]\n");
+        return 1;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "swvcs-bench-graph";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<std::string> hashes;
+    {
+        Repository repo(dir);
+        if (!repo.IsValid()) std::abort();
+
+        std::string main_line;
+        for (int i = 0; i < commits; ++i) {
+            Commit c;
+            c.hash        = HashOf(i);
+            c.timestamp   = "2025-01-01T00:00:00Z";
+            c.parent_hash = main_line;
+            c.message     = "Revision " + std::to_string(i);
+            if (!repo.SaveCommit(c).ok) std::abort();
+            hashes.push_back(c.hash);
+            if (i % 100 != 99) main_line = c.hash;   // every 100th is a dead end
+        }
+        repo.SetHead(main_line);
+    }
+
+    Repository repo(dir);
+    const std::string head = repo.GetHead();
+    std::printf("%d commits, %d queries\n\n", commits, queries);
+
+    // load
+    fs::remove(repo.CommitGraphPath());
+    CommitGraph graph(repo);
+    auto t0 = Clock::now();
+    if (!graph.Load().ok) std::abort();
+    double build = Seconds(t0);
+    t0 = Clock::now();
+    if (!graph.Load().ok) std::abort();
+    double mapped = Seconds(t0);
+    std::printf("load      %10.1f ms build + write, %.3f ms mapped\n", build * 1e3, mapped * 1e3);
+
+    // before: walk parent_hash with LoadCommit from HEAD to the root
+    t0 = Clock::now();
+    Commit c;
+    size_t steps = 0;
+    for (std::string h = head; !h.empty(); h = c.parent_hash, ++steps)
+        if (!repo.LoadCommit(h, c).ok) std::abort();
+    double walk = Seconds(t0);
+    std::printf("before    %10.1f ms  root-is-ancestor-of-HEAD (%zu LoadCommit calls)\n",
+                walk * 1e3, steps);
+
+    // after
+    CommitGraph::Id root = graph.Find(hashes[0]);
+    CommitGraph::Id tip  = graph.Find(head);
+    t0 = Clock::now();
+    if (!graph.IsAncestor(root, tip)) std::abort();
+    std::printf("after     %10.3f ms  root-is-ancestor-of-HEAD\n", Seconds(t0) * 1e3);
+
+    std::mt19937 rng(1);
+    std::vector<CommitGraph::Id> pairs(2 * static_cast<size_t>(queries));
+    for (auto& id : pairs) id = graph.Find(hashes[rng() % hashes.size()]);
+
+    size_t yes = 0;
+    t0 = Clock::now();
+    for (int i = 0; i < queries; ++i) yes += graph.IsAncestor(pairs[2 * i], pairs[2 * i + 1]);
+    double anc = Seconds(t0);
+
+    size_t found = 0;
+    t0 = Clock::now();
+    for (int i = 0; i < queries; ++i)
+        found += graph.MergeBase(pairs[2 * i], pairs[2 * i + 1]) != CommitGraph::kNone;
+    double base = Seconds(t0);
+
+    std::printf("after     %10.2f us  per IsAncestor (%zu true)\n", anc / queries * 1e6, yes);
+    std::printf("after     %10.2f us  per MergeBase (%zu found)\n", base / queries * 1e6, found);
+
+    // resave: A is in the file when it is saved again on top of B
+    Commit a, b;
+    a.hash        = HashOf(commits);
+    a.timestamp   = "2025-01-02T00:00:00Z";
+    a.parent_hash = head;
+    b.hash        = HashOf(commits + 1);
+    b.timestamp   = "2025-01-03T00:00:00Z";
+    b.parent_hash = a.hash;
+    if (!repo.SaveCommit(a).ok || !graph.Write().ok || !repo.SaveCommit(b).ok) std::abort();
+    a.timestamp   = "2025-01-04T00:00:00Z";
+    a.parent_hash = b.hash;
+    if (!repo.SaveCommit(a).ok || !repo.SetHead(a.hash).ok) std::abort();
+
+    t0 = Clock::now();
+    if (!graph.Load().ok) std::abort();
+    double reload = Seconds(t0);
+
+    // The database has A and B as each other's parent: compare up
+    // to the first commit seen twice
+    std::vector<std::string> seen;
+    for (std::string h = a.hash; !h.empty() && std::find(seen.begin(), seen.end(), h) == seen.end();
+         h = c.parent_hash) {
+        if (!repo.LoadCommit(h, c).ok) std::abort();
+        CommitGraph::Id id = graph.Find(h);
+        if (id == CommitGraph::kNone || graph.Time(id) != c.time) std::abort();
+        seen.push_back(h);
+    }
+    CommitGraph::Id id = graph.Find(a.hash);
+    for (const auto& h : seen) {
+        if (graph.Hash(id) != h) std::abort();
+        id = graph.Parent(id);
+    }
+    if (id != CommitGraph::kNone) std::abort();
+    std::printf("resave    %10.1f ms  Load() after A, B, A (first-parent line matches)\n",
+                reload * 1e3);
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// -------------------------------------------------------
+// bench_import — importing a folder of old versions
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_import [files] [kb]           (default 2000 256)
+//
+// Writes [files] versions of a [kb] KB part, each a small edit of
+// the one before, into a scratch folder, then imports them into a
+// fresh repository twice:
+//   before — one file at a time, as CommitEngine does: Store, then
+//            SaveCommit and SetHead, each its own transaction
+//   after  — ImportEngine: a batch of files stored on the thread
+//            pool, then one transaction for the batch's commits
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "blob_store.h"
+#include "import_engine.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+int main(int argc, char** argv) {
+    int files = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int kb    = argc > 2 ? std::atoi(argv[2]) : 256;
+    if (files <= 0 || kb <= 0) {
+        std::fprintf(stderr, "usage: bench_import [files] [kb]\n");
+        return 1;
+    }
+
+    fs::path root = fs::temp_directory_path() / "swvcs-bench-import";
+    fs::remove_all(root);
+    fs::path old = root / "old";
+
+    std::mt19937      rng(1);
+    std::vector<char> part(static_cast<size_t>(kb) * 1024);
+    for (auto& b : part) b = static_cast<char>(rng());
+    std::vector<fs::path> paths;
+    for (int i = 0; i < files; ++i) {
+        for (int k = 0; k < 16; ++k) part[rng() % part.size()] = static_cast<char>(rng());
+        fs::path p = old / ("bracket_v" + std::to_string(i)) / "bracket.SLDPRT";
+        fs::create_directories(p.parent_path());
+        std::ofstream(p, std::ios::binary).write(part.data(), static_cast<std::streamsize>(part.size()));
+        fs::last_write_time(p, fs::file_time_type::clock::now() - std::chrono::minutes(files - i));
+        paths.push_back(p);
+    }
+
+    // Repository and ImportEngine log as they go; keep it out of the timings
+    std::ostringstream sink;
+    auto* saved = std::cout.rdbuf(sink.rdbuf());
+
+    // before
+    fs::create_directories(root / "before");
+    double before;
+    {
+        Repository repo(root / "before");
+        if (!repo.IsValid()) std::abort();
+        BlobStore store(repo);
+        auto t0 = Clock::now();
+        for (const auto& p : paths) {
+            Commit     c;
+            StoreStats stats;
+            if (!store.Store(p, c.hash, stats).ok) std::abort();
+            c.message     = "Imported " + p.parent_path().filename().string();
+            c.timestamp   = "2025-01-01T00:00:00Z";
+            c.parent_hash = repo.GetHead();
+            c.sw_meta.doc_path        = (repo.ProjectDir() / "bracket.SLDPRT").string();
+            c.sw_meta.blob_size_bytes = stats.logical_bytes;
+            if (!repo.SaveCommit(c).ok || !repo.SetHead(c.hash).ok) std::abort();
+        }
+        before = Seconds(t0);
+    }
+
+    // after
+    fs::create_directories(root / "after");
+    double      after;
+    ImportStats stats;
+    {
+        Repository repo(root / "after");
+        if (!repo.IsValid()) std::abort();
+        ImportEngine engine(repo);
+        auto t0 = Clock::now();
+        if (!engine.Run({ old }, ImportOptions{}, stats).ok) std::abort();
+        after = Seconds(t0);
+    }
+    std::cout.rdbuf(saved);
+    if (stats.commits != static_cast<size_t>(files)) std::abort();
+
+    std::printf("%d files of %d KB, %u threads\n\n", files, kb, ThreadPool::Shared().Size());
+    std::printf("before    %8.1f ms  (%.2f ms per file)\n", before * 1e3, before / files * 1e3);
+    std::printf("after     %8.1f ms  (%.2f ms per file)\n", after * 1e3, after / files * 1e3);
+
+    fs::remove_all(root);
+    return 0;
+}
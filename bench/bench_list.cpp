@@ -0,0 +1,111 @@
+// -------------------------------------------------------
+// bench_list — listing a long history: Commit vs CommitSummary
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_list [commits] [rounds]       (default 100000 5)
+//
+// Saves [commits] commits with realistic paths and messages into
+// a scratch repository, then lists all of them in one page:
+//   before — ListCommits: every column into a Commit
+//   after  — ListCommitSummaries: hash, timestamp, message and
+//            author into one StringArena
+// Reports time per listing and heap allocations, counted by
+// replacing the global operator new.
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "content_hash.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t n) {
+    ++g_allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+int main(int argc, char** argv) {
+    int commits = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds  = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (commits <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: bench_list [commits] [rounds]\n");
+        return 1;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "swvcs-bench-list";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::ostringstream sink;   // keep the repository's log out of the output
+    auto* saved = std::cout.rdbuf(sink.rdbuf());
+    {
+        Repository repo(dir);
+        if (!repo.IsValid()) std::abort();
+        std::vector<Commit> batch;
+        for (int i = 0; i < commits; ++i) {
+            Commit c;
+            std::string seed = "commit " + std::to_string(i);
+            c.hash      = ContentHasher::Of(HashAlgo::Sha256, seed.data(), seed.size());
+            c.timestamp = "2025-01-01T00:00:00Z";
+            c.message   = "Moved the mounting holes 2 mm inboard for revision " + std::to_string(i);
+            c.author    = i % 3 ? "jsmith" : "akumar";
+            c.sw_meta.doc_path = "C:\\Projects\\Conveyor\\Frame\\Subassemblies\\bracket_left_"
+                                 + std::to_string(i % 40) + ".SLDPRT";
+            c.sw_meta.doc_type = "Part";
+            c.sw_meta.material = "AISI 304";
+            batch.push_back(std::move(c));
+            if (batch.size() == 5000 || i + 1 == commits) {
+                if (!repo.SaveCommits(batch).ok) std::abort();
+                batch.clear();
+            }
+        }
+    }
+
+    Repository repo(dir, OpenMode::ReadOnly);
+    std::cout.rdbuf(saved);
+    CommitQuery all;
+
+    size_t before_allocs = 0, after_allocs = 0;
+    auto   t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        size_t start = g_allocations;
+        auto   page  = repo.ListCommits(all);
+        before_allocs = g_allocations - start;
+        if (page.size() != static_cast<size_t>(commits)) std::abort();
+    }
+    double before = Seconds(t0) / rounds;
+
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        size_t          start = g_allocations;
+        CommitSummaries page;
+        if (!repo.ListCommitSummaries(all, page).ok) std::abort();
+        after_allocs = g_allocations - start;
+        if (page.rows.size() != static_cast<size_t>(commits)) std::abort();
+    }
+    double after = Seconds(t0) / rounds;
+
+    std::printf("%d commits, %d rounds\n\n", commits, rounds);
+    std::printf("before    %8.1f ms  %9zu allocations  (ListCommits)\n", before * 1e3, before_allocs);
+    std::printf("after     %8.1f ms  %9zu allocations  (ListCommitSummaries)\n", after * 1e3, after_allocs);
+
+    fs::remove_all(dir);
+    return 0;
+}
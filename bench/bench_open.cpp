@@ -0,0 +1,149 @@
+// -------------------------------------------------------
+// bench_open — cost of opening a repository
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_open [commits] [rounds]       (default 10000 500)
+//
+// Every swvcs command opens the repository first, so its cost is
+// paid by every 'swvcs log' and 'swvcs status'.  Against a scratch
+// repository of [commits] commits, reports per open:
+//   before — what opening used to do on every run (directory
+//            creation, CREATE TABLE IF NOT EXISTS, ALTER TABLEs that
+//            fail, INSERT OR IGNOREs, one read per config key),
+//            replayed with plain SQLiteCpp
+//   after  — Repository's constructor: read version and hash_algo
+//   read   — the same with OpenMode::ReadOnly, as the query commands
+//            open it
+//   log    — open + HEAD + the first 20 commits, as 'swvcs log'
+//   status — open + HEAD + its commit, as 'swvcs status'
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "content_hash.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+// The old InitSchema, statement for statement
+static void OpenBefore(const fs::path& project) {
+    fs::path root = project / ".swvcs";
+    std::error_code ec;
+    for (const char* dir : { "", "blobs", "chunks", "packs", "thumbs" })
+        fs::create_directories(root / dir, ec);
+
+    SQLite::Database db((root / "swvcs.db").string(), SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.setBusyTimeout(5000);
+    db.execAndGet("PRAGMA journal_mode = WAL");
+    db.exec("PRAGMA synchronous = NORMAL");
+    db.exec("PRAGMA cache_size = -16384");
+    db.exec("PRAGMA mmap_size = 268435456");
+    db.exec("PRAGMA temp_store = MEMORY");
+
+    db.tableExists("commits");
+    for (const char* column : { "surface_area REAL", "material TEXT", "bbox_x REAL",
+                                "bbox_y REAL", "bbox_z REAL", "config_count INTEGER",
+                                "blob_size_bytes INTEGER", "stored_size_bytes INTEGER" }) {
+        try { db.exec(std::string("ALTER TABLE commits ADD COLUMN ") + column); }
+        catch (const SQLite::Exception&) {}
+    }
+    db.exec("CREATE TABLE IF NOT EXISTS documents (id INTEGER PRIMARY KEY, key TEXT NOT NULL UNIQUE, path TEXT NOT NULL)");
+    db.exec("CREATE TABLE IF NOT EXISTS stat_cache (doc_path TEXT PRIMARY KEY, size INTEGER NOT NULL, mtime_ns INTEGER NOT NULL, device INTEGER NOT NULL, inode INTEGER NOT NULL, hash TEXT NOT NULL, cached_ns INTEGER NOT NULL)");
+    db.exec("CREATE TABLE IF NOT EXISTS config (key TEXT PRIMARY KEY, value TEXT NOT NULL DEFAULT '')");
+    for (const char* key : { "version", "HEAD", "hash_algo", "compression_level",
+                             "compression_long", "delta_chain", "storage" }) {
+        SQLite::Statement q(db, "INSERT OR IGNORE INTO config (key, value) VALUES (?, '')");
+        q.bind(1, key);
+        q.exec();
+    }
+    for (const char* key : { "version", "version", "version", "hash_algo" }) {
+        SQLite::Statement q(db, "SELECT value FROM config WHERE key = ?");
+        q.bind(1, key);
+        q.executeStep();
+    }
+}
+
+int main(int argc, char** argv) {
+    int commits = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int rounds  = argc > 2 ? std::atoi(argv[2]) : 500;
+    if (commits <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: bench_open [commits] [rounds]\n");
+        return 1;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "swvcs-bench-open";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    // Repository logs every open; keep it out of the timings
+    std::ostringstream sink;
+    auto* saved = std::cout.rdbuf(sink.rdbuf());
+
+    {
+        Repository repo(dir);
+        if (!repo.IsValid()) std::abort();
+        std::string parent;
+        for (int i = 0; i < commits; ++i) {
+            Commit c;
+            std::string seed = "commit " + std::to_string(i);
+            c.hash        = ContentHasher::Of(HashAlgo::Sha256, seed.data(), seed.size());
+            c.timestamp   = "2025-01-01T00:00:00Z";
+            c.parent_hash = parent;
+            c.message     = "Revision " + std::to_string(i);
+            if (!repo.SaveCommit(c).ok) std::abort();
+            parent = c.hash;
+        }
+        repo.SetHead(parent);
+    }
+
+    auto per_open = [&](auto&& run) {
+        auto t0 = Clock::now();
+        for (int i = 0; i < rounds; ++i) run();
+        sink.str("");
+        return Seconds(t0) / rounds * 1e3;
+    };
+
+    double before = per_open([&] { OpenBefore(dir); });
+    double after  = per_open([&] {
+        Repository repo(dir);
+        if (!repo.IsValid()) std::abort();
+    });
+    double read = per_open([&] {
+        Repository repo(dir, OpenMode::ReadOnly);
+        if (!repo.IsValid()) std::abort();
+    });
+    double log = per_open([&] {
+        Repository  repo(dir, OpenMode::ReadOnly);
+        CommitQuery query;
+        query.limit = 20;
+        repo.GetHead();
+        if (repo.ListCommits(query).size() != 20) std::abort();
+    });
+    double status = per_open([&] {
+        Repository repo(dir, OpenMode::ReadOnly);
+        Commit     c;
+        if (!repo.LoadCommit(repo.GetHead(), c).ok) std::abort();
+    });
+
+    std::cout.rdbuf(saved);
+    std::printf("%d commits, %d rounds\n\n", commits, rounds);
+    std::printf("before    %8.3f ms per open\n", before);
+    std::printf("after     %8.3f ms per open\n", after);
+    std::printf("read      %8.3f ms per read-only open\n", read);
+    std::printf("log       %8.3f ms open + first 20 commits\n", log);
+    std::printf("status    %8.3f ms open + HEAD commit\n", status);
+
+    fs::remove_all(dir);
+    return 0;
+}
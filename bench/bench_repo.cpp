@@ -0,0 +1,185 @@
+// -------------------------------------------------------
+// bench_repo — commit metadata throughput of Repository
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_repo [commits] [lookups]      (default 2000 20000)
+//
+// Runs the same workload against two scratch databases:
+//   before — rollback journal, synchronous = FULL, and a fresh
+//            SQLite::Statement per call (how Repository used to
+//            work, reproduced here with plain SQLiteCpp)
+//   after  — Repository itself: WAL, synchronous = NORMAL,
+//            cached statements
+// and reports:
+//   commits/s — SaveCommit + SetHead, each its own transaction,
+//               as CommitEngine does
+//   lookups/s — GetHead + LoadCommit of a random full hash, as
+//               'swvcs status' / the GUI detail view do
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "content_hash.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+static Commit MakeCommit(int i, const std::string& parent) {
+    Commit c;
+    std::string seed = "commit " + std::to_string(i);
+    c.hash        = ContentHasher::Of(HashAlgo::Sha256, seed.data(), seed.size());
+    c.message     = "Revision " + std::to_string(i) + " - moved mounting holes";
+    char ts[32];
+    std::snprintf(ts, sizeof ts, "2025-01-%02dT%02d:%02d:%02dZ",
+                  1 + i / 86400 % 28, i / 3600 % 24, i / 60 % 60, i % 60);
+    c.timestamp   = ts;
+    c.author      = "bench";
+    c.parent_hash = parent;
+    c.sw_meta.doc_path      = "C:\\Projects\\Bracket\\bracket.SLDPRT";
+    c.sw_meta.doc_type      = "Part";
+    c.sw_meta.mass          = 0.25 + i * 1e-4;
+    c.sw_meta.feature_count = 40 + i % 7;
+    c.sw_meta.material      = "1060 Alloy";
+    return c;
+}
+
+struct Rates {
+    double commits_per_s = 0;
+    double lookups_per_s = 0;
+};
+
+// -------------------------------------------------------
+// before: the old access pattern on plain SQLiteCpp
+// -------------------------------------------------------
+
+static Rates RunBefore(const fs::path& dir, int commits, int lookups,
+                       std::vector<std::string>& hashes) {
+    SQLite::Database db((dir / "before.db").string(), SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.exec(R"(
+        CREATE TABLE commits (
+            hash TEXT PRIMARY KEY, message TEXT, timestamp TEXT, author TEXT,
+            parent_hash TEXT, doc_path TEXT, doc_type TEXT, mass REAL, volume REAL,
+            feature_count INTEGER, surface_area REAL, material TEXT, bbox_x REAL,
+            bbox_y REAL, bbox_z REAL, config_count INTEGER, blob_size_bytes INTEGER,
+            stored_size_bytes INTEGER);
+        CREATE TABLE config (key TEXT PRIMARY KEY, value TEXT);
+    )");
+
+    Rates       rates;
+    std::string parent;
+    auto        t0 = Clock::now();
+    for (int i = 0; i < commits; ++i) {
+        Commit c = MakeCommit(i, parent);
+        SQLite::Statement q(db, R"(
+            INSERT OR REPLACE INTO commits VALUES
+                (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?))");
+        q.bind(1, c.hash);
+        q.bind(2, c.message);
+        q.bind(3, c.timestamp);
+        q.bind(4, c.author);
+        q.bind(5, c.parent_hash);
+        q.bind(6, c.sw_meta.doc_path);
+        q.bind(7, c.sw_meta.doc_type);
+        q.bind(8, c.sw_meta.mass);
+        q.bind(9, c.sw_meta.volume);
+        q.bind(10, c.sw_meta.feature_count);
+        q.bind(11, c.sw_meta.surface_area);
+        q.bind(12, c.sw_meta.material);
+        q.bind(13, c.sw_meta.bbox_x);
+        q.bind(14, c.sw_meta.bbox_y);
+        q.bind(15, c.sw_meta.bbox_z);
+        q.bind(16, c.sw_meta.config_count);
+        q.bind(17, static_cast<long long>(0));
+        q.bind(18, static_cast<long long>(0));
+        q.exec();
+
+        SQLite::Statement h(db, "INSERT OR REPLACE INTO config (key, value) VALUES ('HEAD', ?)");
+        h.bind(1, c.hash);
+        h.exec();
+
+        hashes.push_back(c.hash);
+        parent = c.hash;
+    }
+    rates.commits_per_s = commits / Seconds(t0);
+
+    std::mt19937 rng(1);
+    t0 = Clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        SQLite::Statement h(db, "SELECT value FROM config WHERE key = 'HEAD'");
+        h.executeStep();
+        SQLite::Statement q(db, "SELECT * FROM commits WHERE hash = ? LIMIT 1");
+        q.bind(1, hashes[rng() % hashes.size()]);
+        if (!q.executeStep()) std::abort();
+    }
+    rates.lookups_per_s = lookups / Seconds(t0);
+    return rates;
+}
+
+// -------------------------------------------------------
+// after: Repository
+// -------------------------------------------------------
+
+static Rates RunAfter(const fs::path& dir, int commits, int lookups,
+                      const std::vector<std::string>& hashes) {
+    Repository repo(dir / "after");
+    if (!repo.IsValid()) std::abort();
+
+    Rates       rates;
+    std::string parent;
+    auto        t0 = Clock::now();
+    for (int i = 0; i < commits; ++i) {
+        Commit c = MakeCommit(i, parent);
+        if (!repo.SaveCommit(c).ok || !repo.SetHead(c.hash).ok) std::abort();
+        parent = c.hash;
+    }
+    rates.commits_per_s = commits / Seconds(t0);
+
+    std::mt19937 rng(1);
+    Commit       c;
+    t0 = Clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        repo.GetHead();
+        if (!repo.LoadCommit(hashes[rng() % hashes.size()], c).ok) std::abort();
+    }
+    rates.lookups_per_s = lookups / Seconds(t0);
+    return rates;
+}
+
+int main(int argc, char** argv) {
+    int commits = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int lookups = argc > 2 ? std::atoi(argv[2]) : 20000;
+    if (commits <= 0 || lookups <= 0) {
+        std::fprintf(stderr, "usage: bench_repo [commits] [lookups]\n");
+        return 1;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "swvcs-bench-repo";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<std::string> hashes;
+    Rates before = RunBefore(dir, commits, lookups, hashes);
+    Rates after  = RunAfter(dir, commits, lookups, hashes);
+
+    std::printf("%d commits, %d lookups\n\n", commits, lookups);
+    std::printf("%-8s %12s %12s\n", "", "commits/s", "lookups/s");
+    std::printf("%-8s %12.0f %12.0f\n", "before", before.commits_per_s, before.lookups_per_s);
+    std::printf("%-8s %12.0f %12.0f\n", "after",  after.commits_per_s,  after.lookups_per_s);
+    std::printf("%-8s %11.1fx %11.1fx\n", "speedup",
+                after.commits_per_s / before.commits_per_s,
+                after.lookups_per_s / before.lookups_per_s);
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,113 @@
+// -------------------------------------------------------
+// bench_search — commit message search with and without commits_fts
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_search [commits] [rounds]     (default 100000 20)
+//
+// Saves [commits] commits with messages drawn from a small CAD
+// vocabulary into a scratch repository, then times a few searches:
+//   before — a LIKE '%term%' scan over message, material and
+//            doc_path, which is what finding a commit by its
+//            message amounted to without the index
+//   after  — Repository::SearchCommits, best 20 matches
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "content_hash.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+static const char* const kVerbs[] = {
+    "Added", "Removed", "Moved", "Resized", "Mirrored", "Patterned", "Fixed", "Updated",
+};
+static const char* const kNouns[] = {
+    "fillet", "chamfer", "boss", "cut", "hole", "rib", "shell", "sketch", "mate", "thread",
+};
+static const char* const kWhere[] = {
+    "on top edge", "on base", "near mounting holes", "for clearance", "per review",
+    "for rev A", "for rev B", "for rev C", "to match drawing", "after FEA",
+};
+static const char* const kMaterials[] = {
+    "1060 Alloy", "AISI 304", "ABS", "Plain Carbon Steel", "6061-T6",
+};
+
+int main(int argc, char** argv) {
+    int commits = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds  = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (commits <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: bench_search [commits] [rounds]\n");
+        return 1;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "swvcs-bench-search";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    {
+        Repository repo(dir);
+        if (!repo.IsValid()) std::abort();
+        std::mt19937 rng(1);
+        auto pick = [&](const auto& words) { return words[rng() % std::size(words)]; };
+        for (int i = 0; i < commits; ++i) {
+            Commit c;
+            std::string seed = "commit " + std::to_string(i);
+            c.hash      = ContentHasher::Of(HashAlgo::Sha256, seed.data(), seed.size());
+            c.timestamp = "2025-01-01T00:00:00Z";
+            c.message   = std::string(pick(kVerbs)) + " " + pick(kNouns) + " " + pick(kWhere);
+            if (i % 5000 == 0) c.message += ", checked tolerance stackup";   // a rare word
+            c.sw_meta.material = pick(kMaterials);
+            c.sw_meta.doc_path = "C:\\Projects\\Rig\\part" + std::to_string(i % 500) + ".SLDPRT";
+            if (!repo.SaveCommit(c).ok) std::abort();
+        }
+    }
+
+    Repository repo(dir);
+    SQLite::Database db((dir / ".swvcs" / "swvcs.db").string(), SQLite::OPEN_READONLY);
+    const char* const queries[] = { "fillet", "\"rev C\"", "mirrored rib", "304", "part42", "stackup" };
+
+    std::printf("%d commits, %d rounds, best 20 of each\n\n", commits, rounds);
+    std::printf("%-14s %12s %12s\n", "query", "before ms", "after ms");
+    for (const char* text : queries) {
+        std::string word = text;
+        word.erase(std::remove(word.begin(), word.end(), '"'), word.end());
+        std::string like = "%" + word + "%";
+        SQLite::Statement scan(db, R"(
+            SELECT * FROM commits
+            WHERE message LIKE ?1 OR material LIKE ?1 OR doc_path LIKE ?1
+            ORDER BY time DESC LIMIT 20)");
+        auto t0 = Clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            scan.bind(1, like);
+            while (scan.executeStep()) {}
+            scan.reset();
+        }
+        double before = Seconds(t0) / rounds;
+
+        CommitQuery query;
+        query.limit = 20;
+        t0 = Clock::now();
+        size_t found = 0;
+        for (int r = 0; r < rounds; ++r) found = repo.SearchCommits(text, query).size();
+        double after = Seconds(t0) / rounds;
+        if (found == 0) std::abort();
+
+        std::printf("%-14s %12.2f %12.2f\n", text, before * 1e3, after * 1e3);
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// -------------------------------------------------------
+// bench_sha256 — SHA-256 throughput per implementation
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_sha256 [size_mb]          (default 256)
+//
+// For every implementation the CPU supports, reports:
+//   stream — one large buffer through Update()
+//   chunks — the same bytes as 64 KB chunks via HashMany()
+//            (the chunk store's access pattern)
+// -------------------------------------------------------
+
+#include "sha256.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    if (size_mb == 0) size_mb = 256;
+    const size_t size = size_mb << 20;
+
+    std::vector<uint8_t> data(size);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t v = rng();
+        std::memcpy(&data[i], &v, 8);
+    }
+
+    const size_t chunk = 64 * 1024;
+    std::vector<const uint8_t*> ptrs;
+    std::vector<size_t>         lens;
+    for (size_t off = 0; off < size; off += chunk) {
+        ptrs.push_back(data.data() + off);
+        lens.push_back(std::min(chunk, size - off));
+    }
+    std::vector<Sha256::Digest> digests(ptrs.size());
+
+    std::printf("%-8s %12s %12s\n", "impl", "stream MB/s", "chunks MB/s");
+    std::string reference;
+
+    for (Sha256Impl impl : {Sha256Impl::Scalar, Sha256Impl::Avx2, Sha256Impl::ShaNi}) {
+        if (!Sha256::Force(impl)) {
+            std::printf("%-8s %12s %12s\n", Sha256::Name(impl), "n/a", "n/a");
+            continue;
+        }
+
+        auto t0 = Clock::now();
+        std::string hex = Sha256::Of(data.data(), size);
+        double stream = Seconds(t0);
+
+        t0 = Clock::now();
+        Sha256::HashMany(ptrs.data(), lens.data(), ptrs.size(), digests.data());
+        double chunks = Seconds(t0);
+
+        if (reference.empty()) reference = hex;
+        const char* mismatch = (hex == reference) ? "" : "  MISMATCH";
+
+        std::printf("%-8s %12.0f %12.0f%s\n", Sha256::Name(impl),
+                    size_mb / stream, size_mb / chunks, mismatch);
+    }
+
+    // Hex encoding of one digest per 64 KB chunk
+    auto t0 = Clock::now();
+    size_t total = 0;
+    for (const auto& d : digests)
+        total += Utils::ToHex(d.data(), d.size()).size();
+    double hex_s = Seconds(t0);
+    std::printf("\nhex: %zu digests in %.3f ms (%zu chars)\n",
+                digests.size(), hex_s * 1000.0, total);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// -------------------------------------------------------
+// bench_tree — project snapshots of a large folder
+// -------------------------------------------------------
+// Build with -DSWVCS_BUILD_BENCH=ON, then:
+//   bench_tree [files] [kb]             (default 5000 64)
+//
+// Writes [files] parts of [kb] KB into 50 folders of a scratch
+// project, takes a first snapshot, changes three parts, then
+// times 'swvcs status' and snapshotting again:
+//   status — StatusEngine against the first snapshot: the walk,
+//            and reads of the three changed files only
+//   after  — TreeSnapshot as it runs: the stat cache vouches for
+//            the untouched files, only the three are read
+//   same   — nothing changed since: the walk and stat() calls alone
+//   before — the same snapshot with the stat cache emptied, so
+//            every file is read and hashed, which is what any
+//            snapshot without one would cost
+// -------------------------------------------------------
+
+#include "repository.h"
+#include "status_engine.h"
+#include "thread_pool.h"
+#include "tree_snapshot.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+// Written an hour ago, so the stat cache trusts it (racy window)
+static void WritePart(const fs::path& p, const std::vector<char>& bytes) {
+    fs::create_directories(p.parent_path());
+    std::ofstream(p, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    fs::last_write_time(p, fs::file_time_type::clock::now() - std::chrono::hours(1));
+}
+
+int main(int argc, char** argv) {
+    int files = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int kb    = argc > 2 ? std::atoi(argv[2]) : 64;
+    if (files <= 0 || kb <= 0) {
+        std::fprintf(stderr, "usage: bench_tree [files] [kb]\n");
+        return 1;
+    }
+
+    fs::path root = fs::temp_directory_path() / "swvcs-bench-tree";
+    fs::remove_all(root);
+
+    std::mt19937          rng(1);
+    std::vector<char>     part(static_cast<size_t>(kb) * 1024);
+    std::vector<fs::path> paths;
+    for (int i = 0; i < files; ++i) {
+        for (auto& b : part) b = static_cast<char>(rng());
+        fs::path p = root / ("assembly" + std::to_string(i % 50)) / ("part" + std::to_string(i) + ".SLDPRT");
+        WritePart(p, part);
+        paths.push_back(p);
+    }
+
+    // Repository logs as it goes; keep it out of the timings
+    std::ostringstream sink;
+    auto* saved = std::cout.rdbuf(sink.rdbuf());
+
+    Repository repo(root);
+    if (!repo.IsValid()) std::abort();
+    TreeSnapshot snapshot(repo);
+    TreeStats    first, before, after, same;
+    auto t0 = Clock::now();
+    if (!snapshot.Commit("first", first).ok) std::abort();
+    double t_first = Seconds(t0);
+
+    for (int i = 0; i < 3; ++i) {
+        for (auto& b : part) b = static_cast<char>(rng());
+        WritePart(paths[rng() % paths.size()], part);
+    }
+
+    WorkspaceStatus status;
+    t0 = Clock::now();
+    if (!StatusEngine(repo).Run(status).ok || status.changes.empty()) std::abort();
+    double t_status = Seconds(t0);
+
+    t0 = Clock::now();
+    if (!snapshot.Commit("three parts changed", after).ok) std::abort();
+    double t_after = Seconds(t0);
+
+    t0 = Clock::now();
+    if (snapshot.Commit("nothing changed", same).ok) std::abort();   // same tree: refused
+    double t_same = Seconds(t0);
+
+    // before: the same snapshot again, every file read
+    {
+        SQLite::Database db((root / ".swvcs" / "swvcs.db").string(), SQLite::OPEN_READWRITE);
+        db.exec("DELETE FROM stat_cache");
+    }
+    Tree        tree;
+    std::string hash;
+    t0 = Clock::now();
+    if (!snapshot.Build(tree, hash, before).ok) std::abort();
+    double t_before = Seconds(t0);
+    std::cout.rdbuf(saved);
+
+    std::printf("%d files of %d KB, %u threads\n\n", files, kb, ThreadPool::Shared().Size());
+    std::printf("first     %8.1f ms  (%zu files read)\n", t_first * 1e3, first.hashed);
+    std::printf("before    %8.1f ms  (%zu files read)\n", t_before * 1e3, before.hashed);
+    std::printf("status    %8.1f ms  (%zu files read)\n", t_status * 1e3, status.hashed);
+    std::printf("after     %8.1f ms  (%zu files read)\n", t_after * 1e3, after.hashed);
+    std::printf("same      %8.1f ms  (%zu files read)\n", t_same * 1e3, same.hashed);
+
+    fs::remove_all(root);
+    return 0;
+}
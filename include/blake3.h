@@ -0,0 +1,46 @@
+#pragma once
+
+// -------------------------------------------------------
+// Blake3
+// -------------------------------------------------------
+// Incremental BLAKE3 (default 32-byte output, unkeyed).
+//
+// BLAKE3 hashes a file as a binary tree of 1 KB chunks, so
+// independent subtrees can be hashed on different cores.
+// Update() collects input into 8 MB batches; each full batch
+// is split into equal subtrees that are hashed in parallel on
+// ThreadPool::Shared(), then folded into the running tree.
+// A 1 GB file therefore hashes at multi-core speed even
+// though it is a single stream.
+// -------------------------------------------------------
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Blake3 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Blake3();
+
+    void Update(const void* data, size_t len);
+
+    // Finish the hash.  Call once; the object is spent afterwards.
+    Digest      Final();
+    std::string HexDigest();
+
+    // Convenience: hash a single buffer (parallel if it is large).
+    static std::string Of(const void* data, size_t len);
+
+private:
+    using Cv = std::array<uint32_t, 8>;
+
+    std::vector<uint8_t> batch_;          // pending input, < one batch
+    uint64_t             batches_ = 0;    // full batches folded so far
+    std::vector<Cv>      stack_;          // chaining values of merged subtrees
+
+    void PushBatch();
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+// -------------------------------------------------------
+// BlobStore
+// -------------------------------------------------------
+// Content-addressed storage for snapshot bytes.
+//
+// A snapshot is split into content-defined chunks (see
+// Chunker) and each unique chunk is written once.  The
+// snapshot itself is a small manifest listing its chunks in
+// order, so consecutive saves of a large assembly only pay
+// for the regions that actually changed.
+//
+// Layout inside .swvcs/:
+//   blobs/{hash}.manifest   ← ordered chunk list of a snapshot
+//   blobs/{hash}.delta      ← zstd patch against another
+//                             snapshot (delta mode only)
+//   blobs/{hash}.bin        ← uncompressed full copy (storage
+//                             mode 'full', and repos created
+//                             before the chunk store)
+//   blobs/{hash}.tree       ← project snapshot: the snapshot
+//                             hash of every file (see TreeSnapshot)
+//   packs/pack-{id}.*       ← any of the above (and thumbnails)
+//                             consolidated by Repack()
+//   chunks/ab/{chunk-hash}  ← unique chunk bytes (zstd-compressed
+//                             unless compression_level is 0),
+//                             fanned out by the first two hex
+//                             characters; named by the hash of
+//                             the uncompressed bytes
+// -------------------------------------------------------
+
+#include "types.h"
+#include "compression.h"
+#include "content_hash.h"
+#include "pack_set.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Repository;
+
+namespace fs = std::filesystem;
+
+// What a Store() call actually did — reported by CommitEngine.
+struct StoreStats {
+    int64_t logical_bytes  = 0;      // size of the snapshot
+    int64_t written_bytes  = 0;      // bytes written to disk (compressed)
+    size_t  chunks         = 0;      // chunks in the snapshot
+    size_t  new_chunks     = 0;      // chunks not already in the store
+    bool    already_stored = false;  // identical snapshot was already there
+    int     delta_depth    = 0;      // > 0: stored as a delta, this deep in its chain
+    std::string copy_method;         // full copy: how it was copied (see FileCopy)
+};
+
+// Result of Rehash(): what to rewrite in the DB and delete afterwards.
+struct RehashPlan {
+    std::vector<std::pair<std::string, std::string>> snapshots;  // old → new snapshot (or tree) hash
+    std::vector<fs::path> old_objects;   // files still under their old names
+    size_t                chunks = 0;    // chunks rehashed
+    size_t                trees  = 0;    // of the snapshots, trees rewritten
+    size_t                groups = 0;    // of the snapshots, group commits renamed
+};
+
+// What a Repack() call did
+struct RepackStats {
+    size_t  objects = 0;   // loose objects moved into packs
+    int64_t bytes   = 0;   // their total size
+    size_t  packs   = 0;   // pack files written
+};
+
+class BlobStore {
+public:
+    explicit BlobStore(Repository& repo);
+
+    // True if a snapshot with this hash is stored in either form.
+    bool Has(const std::string& hash) const;
+
+    // Read src once, hashing and chunking it in the same pass, and
+    // store it.  hash receives the whole-file hash (repo's algorithm).
+    // Every object is written to a temp file and renamed into place.
+    // In delta mode (config delta_chain > 0) the snapshot is stored
+    // as a patch against base_hash when that is worthwhile.  In
+    // full-copy mode (config storage = full) src is copied whole,
+    // reflinked where the filesystem allows, and hashed from the copy.
+    Result Store(const fs::path& src, std::string& hash, StoreStats& stats,
+                 const std::string& base_hash = "");
+
+    // Reassemble snapshot hash into dst, overwriting it.  method
+    // (optional) receives how: a FileCopy method name for full
+    // copies, else "chunks", "delta chain" or "pack".
+    Result Restore(const std::string& hash, const fs::path& dst,
+                   std::string* method = nullptr);
+
+    // Logical size of a stored snapshot, or -1 if it is missing.
+    int64_t SnapshotSize(const std::string& hash) const;
+
+    // Hash algorithm migration (see HashMigration):
+    // Rehash() links every chunk and snapshot under its name in
+    // algorithm 'to', in parallel, and rewrites every tree to name
+    // them so, and renames group commits after their members
+    // (trees and groups count as snapshots in plan).  Old names are
+    // left in place, so the repo stays readable until the DB is
+    // switched over; then DropOld() removes them.
+    Result Rehash(HashAlgo to, RehashPlan& plan);
+    void   DropOld(const RehashPlan& plan);
+
+    // Move every loose object (chunks, snapshots, thumbnails, trees) into
+    // new pack files, then delete the loose copies.  Packed objects
+    // are read in place, so nothing else changes.
+    Result Repack(RepackStats& stats);
+
+    // Thumbnail image bytes of a snapshot, loose or packed.
+    bool ReadThumbnail(const std::string& hash, std::vector<char>& out) const;
+
+    // Store a tree object (entries sorted by path); hash receives
+    // its name, written_bytes what it added (0 if already stored).
+    Result StoreTree(const Tree& tree, std::string& hash, int64_t& written_bytes);
+    Result LoadTree(const std::string& hash, Tree& out) const;
+
+private:
+    // Fills buf with up to cap bytes; returns 0 at the end.
+    using ReadFn = std::function<size_t(char* buf, size_t cap)>;
+
+    Result StoreChunked(const ReadFn& read, std::string& hash, StoreStats& stats);
+    Result StoreFull(const fs::path& src, std::string& hash, StoreStats& stats);
+    Result StoreDelta(const fs::path& src, const std::string& base_hash,
+                      std::string& hash, StoreStats& stats);
+    int    DeltaDepth(const std::string& hash) const;
+    Result ExtractSnapshot(const std::string& hash, const fs::path& dst) const;
+
+    fs::path LoosePath(ObjectKind kind, const std::string& hash) const;
+    bool     HasObject(ObjectKind kind, const std::string& hash) const;
+    bool     ReadObject(ObjectKind kind, const std::string& hash, std::vector<char>& out) const;
+    bool     StreamObject(ObjectKind kind, const std::string& hash,
+                          const PackSet::Sink& sink) const;
+    std::vector<std::pair<std::string, fs::path>> ListLoose(ObjectKind kind) const;
+    std::vector<std::string> ListObjects(ObjectKind kind) const;
+    Result   RelinkObject(ObjectKind kind, const std::string& from, const std::string& to) const;
+
+    Repository&        repo_;
+    HashAlgo           algo_;
+    CompressionOptions compression_;
+    int                delta_chain_;   // 0 = delta mode off
+    int64_t            delta_max_;     // larger files get no delta; 0 = no limit
+    bool               full_copies_;   // storage = full
+    PackSet            packs_;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+// -------------------------------------------------------
+// Chunker
+// -------------------------------------------------------
+// Content-defined chunking (FastCDC-style gear hash with
+// normalised chunk sizes).  Cut points depend only on the
+// bytes near them, so an edit in the middle of a file only
+// changes the chunks around the edit — the rest of the file
+// splits exactly as before and dedups against earlier
+// snapshots in the chunk store.
+//
+// Usage (streaming):
+//   Chunker ck;
+//   size_t n = ck.Scan(buf, len, at_boundary);
+//   // buf[0..n) belongs to the current chunk; if at_boundary
+//   // is true the chunk ends there and a new one starts.
+// -------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+class Chunker {
+public:
+    static constexpr size_t kMinSize = 16 * 1024;
+    static constexpr size_t kAvgSize = 64 * 1024;
+    static constexpr size_t kMaxSize = 256 * 1024;
+
+    // Consume bytes from data until the current chunk ends or the
+    // buffer runs out.  Returns the number of bytes consumed.
+    size_t Scan(const uint8_t* data, size_t len, bool& at_boundary);
+
+    // Forget the current chunk (start of a new file).
+    void Reset() { size_ = 0; hash_ = 0; }
+
+private:
+    size_t   size_ = 0;   // bytes in the current chunk so far
+    uint64_t hash_ = 0;   // rolling gear hash
+};
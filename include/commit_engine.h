@@ -3,12 +3,15 @@
 // -------------------------------------------------------
 // CommitEngine
 // -------------------------------------------------------
-// Orchestrates creating a commit:
+// Orchestrates creating a commit (CommitAllOpen: a group commit
+// of every open document):
 //   1. Ask SwConnection to save the active doc
-//   2. Read the file bytes and compute a SHA-256 hash
-//   3. Copy the file into the blobs/ directory
-//   4. Optionally capture a thumbnail
-//   5. Write the Commit record via Repository
+//   2. At the same time (CommitPipeline):
+//        - stream the file once on a worker thread: hash +
+//          chunk store (BlobStore) in a single pass
+//        - read the properties and, optionally, a thumbnail
+//          over COM on this thread
+//   3. Write the Commit record via Repository
 // -------------------------------------------------------
 
 #include "types.h"
@@ -28,18 +31,17 @@ public:
     // capture_thumbnail: save a BMP preview alongside the snapshot
     Result Commit(const std::string& message, bool capture_thumbnail = true);
 
+    // Commit every document SolidWorks has loaded ('commit --all-open')
+    // as one group commit (see Commit in types.h): each is saved and
+    // its properties read in turn over COM, then all the files are
+    // hashed and stored at once on the thread pool.  Documents that
+    // haven't changed since their last commit are left out.
+    Result CommitAllOpen(const std::string& message);
+
 private:
     Repository&  repo_;
     SwConnection& sw_;
 
-    // Compute SHA-256 hash of a file and return it as a hex string.
-    // Returns empty string on failure.
-    static std::string HashFile(const std::filesystem::path& path);
-
-    // Copy src to dest (overwrites if exists).
-    static Result CopyBlob(const std::filesystem::path& src,
-                           const std::filesystem::path& dst);
-
     // Get current timestamp as ISO-8601 string.
     static std::string NowISO8601();
 
@@ -0,0 +1,109 @@
+#pragma once
+
+// -------------------------------------------------------
+// CommitGraph
+// -------------------------------------------------------
+// The parent links of every commit as integer ids, so that
+// ancestry questions — "is X an ancestor of HEAD", HEAD's
+// first-parent history, the merge base of two commits — don't
+// cost one LoadCommit per step.
+//
+//   .swvcs/commit-graph   ← side file, rebuilt from the commits table
+//
+// Format (little-endian):
+//   "SWVCSCGR"  u32 version (1)  u32 count
+//   u32 hash_algo  u32 reserved  i64 seq   — commits rows up to seq
+//   u32 fanout[256]                          are included
+//   count × u8 hash[32]                    — sorted; id = position
+//   count × { u32 parent, u32 generation, u32 skip, u32 reserved, i64 time }
+//
+// generation is 1 for a root commit and its parent's + 1 otherwise,
+// so an ancestor always has a smaller generation.  skip points
+// further back than parent (the skip list Bitcoin keeps over its
+// block index): AncestorAt() follows it to reach any generation in
+// O(log n) steps, which makes IsAncestor and MergeBase a few dozen
+// lookups even on a million-commit history.
+//
+// The file is memory-mapped and searched in place, like a pack
+// index.  Commits saved after it was written are read from the
+// database on Load(); once there are kMaxPending of them the file
+// is rewritten (unless the repository was opened read-only).  A
+// commit re-saved with another parent or time makes Load() drop
+// the file and start again from the whole table.
+// -------------------------------------------------------
+
+#include "mapped_file.h"
+#include "types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Repository;
+
+class CommitGraph {
+public:
+    using Id = uint32_t;
+    static constexpr Id     kNone       = 0xffffffff;
+    static constexpr size_t kMaxPending = 256;
+
+    explicit CommitGraph(Repository& repo);
+
+    // Map the side file (if any) and add the commits saved since.
+    Result Load();
+
+    // Rebuild the side file from the whole commits table, then Load().
+    Result Write();
+
+    size_t Size() const { return file_count_ + pending_.size(); }
+
+    // Id of a full hex hash, kNone if it isn't a commit.
+    Id Find(const std::string& hash) const;
+
+    std::string Hash(Id id) const;
+    Id          Parent(Id id) const;       // kNone for a root commit
+    uint32_t    Generation(Id id) const;   // 1 for a root commit
+    int64_t     Time(Id id) const;         // Unix seconds
+
+    // The ancestor of id with the given generation (id itself if it
+    // has it), kNone if generation is 0 or above id's.
+    Id AncestorAt(Id id, uint32_t generation) const;
+
+    // True if ancestor is descendant or one of its ancestors.
+    bool IsAncestor(Id ancestor, Id descendant) const;
+
+    // Newest commit that is an ancestor of both (kNone if they share
+    // no history).
+    Id MergeBase(Id a, Id b) const;
+
+private:
+    using Key = std::array<uint8_t, 32>;
+
+    struct Node {
+        Id       parent     = kNone;
+        uint32_t generation = 0;
+        Id       skip       = kNone;
+        int64_t  time       = 0;
+    };
+
+    void           Reset();
+    bool           MapFile();
+    Node           GetNode(Id id) const;
+    const uint8_t* KeyOf(Id id) const;
+    Id             FindKey(const uint8_t* key) const;
+    bool           Moved(const CommitLink& l) const;   // in the graph, other parent or time
+    void           AddLinks(const std::vector<CommitLink>& links);
+
+    Repository& repo_;
+    MappedFile  file_;
+    uint32_t    file_count_ = 0;
+    int64_t     seq_        = 0;   // newest commits row included
+
+    // Commits not in the file yet; their ids follow the file's
+    std::vector<Key>                    pending_keys_;
+    std::vector<Node>                   pending_;
+    std::unordered_map<std::string, Id> pending_ids_;   // raw hash → id
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+// -------------------------------------------------------
+// CommitPipeline
+// -------------------------------------------------------
+// The task graph behind CommitEngine::Commit, once the
+// document is saved:
+//
+//            ┌─ hash + store the file ──────────┐  worker thread
+//   saved ───┤                                   ├─ save commit, HEAD
+//            └─ properties + thumbnail over COM ─┘  calling (STA) thread
+//
+// The branches share nothing: the file side touches only the
+// store and the repository, the document side only SolidWorks
+// (its thumbnail goes to a temporary name and is renamed once
+// the hash is known).  A commit therefore takes as long as the
+// slower branch instead of both one after the other.
+//
+// No COM in here: the document side is a DocumentSource.
+// DocumentSourceFor builds one from SwConnection — or from
+// anything with the same methods, such as bench_commit's fake
+// connection with injected latencies.
+// -------------------------------------------------------
+
+#include "blob_store.h"
+#include "types.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+
+class Repository;
+
+namespace fs = std::filesystem;
+
+// What the document side of a commit does, on the calling thread
+struct DocumentSource {
+    std::function<void(Commit::SwMeta&)>      read_properties;   // may be empty
+    std::function<Result(const std::string&)> save_thumbnail;    // BMP to a path; empty = none
+};
+
+// Mass properties, feature count, material, bounding box and
+// configuration count of sw's active (or selected) document
+template <class Sw>
+void ReadProperties(Sw& sw, Commit::SwMeta& m) {
+    sw.GetMassProperties(m.mass, m.volume, m.surface_area);
+    sw.GetFeatureCount(m.feature_count);
+    sw.GetMaterial(m.material);
+    sw.GetBoundingBox(m.bbox_x, m.bbox_y, m.bbox_z);
+    sw.GetConfigCount(m.config_count);
+}
+
+template <class Sw>
+DocumentSource DocumentSourceFor(Sw& sw, bool capture_thumbnail) {
+    DocumentSource doc;
+    doc.read_properties = [&sw](Commit::SwMeta& m) { ReadProperties(sw, m); };
+    if (capture_thumbnail)
+        doc.save_thumbnail = [&sw](const std::string& path) { return sw.SaveThumbnail(path); };
+    return doc;
+}
+
+class CommitPipeline {
+public:
+    explicit CommitPipeline(Repository& repo);
+
+    // Store file (as a delta against c.parent_hash in delta mode)
+    // while doc reads the document, then save c and move HEAD to
+    // it.  The caller fills in c's message, time, parent, author,
+    // doc_path and doc_type; the hash, properties and sizes are
+    // filled in here.
+    Result Run(const fs::path& file, const DocumentSource& doc, ::Commit& c, StoreStats& stats);
+
+private:
+    Repository& repo_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// -------------------------------------------------------
+// Compression
+// -------------------------------------------------------
+// zstd compression of stored objects (chunks).  Settings come
+// from the config table:
+//   compression_level — zstd level 1..19, 0 = store raw (default 3)
+//   compression_long  — 1 = long-distance matching (default 0)
+//
+// A compressed object is a plain zstd frame, so it can be
+// inspected with the zstd command-line tool.  Objects that don't
+// start with the zstd frame magic are raw — repos written before
+// compression, or with compression_level 0 — and are read as is.
+// -------------------------------------------------------
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+struct CompressionOptions {
+    int  level         = 3;      // 0 = off
+    bool long_distance = false;
+};
+
+namespace Compression {
+
+// Encode data for storage into out.  With level 0 the bytes are
+// copied unchanged, unless they would be mistaken for a zstd frame
+// (then they are wrapped in one at level 1).
+bool Encode(const void* data, size_t len, const CompressionOptions& opts,
+            std::vector<char>& out);
+
+// Reverse of Encode: decompress a zstd frame, or copy raw bytes.
+bool Decode(const void* data, size_t len, std::vector<char>& out);
+
+// Receives encoded output a block at a time; false = write failed.
+using Sink = std::function<bool(const char* data, size_t len)>;
+
+// Binary delta of target against base, as a zstd frame that uses
+// base as its reference ("patch-from"): long-distance matching
+// finds unchanged regions anywhere in base, however far they moved.
+// Both are read in place (pass mapped files): besides zstd's match
+// tables only one output block is held, and the frame goes to sink
+// as it is produced.  Fails once the frame reaches limit bytes —
+// a delta that large isn't worth keeping.
+bool EncodeDelta(const void* base, size_t base_len,
+                 const void* target, size_t target_len,
+                 const CompressionOptions& opts, size_t limit, const Sink& sink);
+
+// Rebuild target from base and a delta made by EncodeDelta.  base
+// is read in place; out holds the whole target.
+bool DecodeDelta(const void* base, size_t base_len,
+                 const void* delta, size_t delta_len, std::vector<char>& out);
+
+} // namespace Compression
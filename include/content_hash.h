@@ -0,0 +1,49 @@
+#pragma once
+
+// -------------------------------------------------------
+// ContentHasher
+// -------------------------------------------------------
+// Hashes snapshot and chunk content with the algorithm the
+// repository was created with (config key 'hash_algo'):
+//   sha256 — default; every repo created before this option
+//   blake3 — tree hash, uses all cores on large files
+//
+// Both produce 32-byte digests, written as 64 hex characters,
+// so commit hashes look the same either way.
+// -------------------------------------------------------
+
+#include "blake3.h"
+#include "sha256.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+
+enum class HashAlgo {
+    Sha256,
+    Blake3,
+};
+
+// "sha256" / "blake3" — the spelling stored in the config table
+const char* HashAlgoName(HashAlgo algo);
+bool        ParseHashAlgo(const std::string& name, HashAlgo& out);
+
+class ContentHasher {
+public:
+    explicit ContentHasher(HashAlgo algo);
+
+    void        Update(const void* data, size_t len);
+    std::string HexDigest();
+
+    static std::string Of(HashAlgo algo, const void* data, size_t len);
+
+    // Hash count independent buffers (a batch of chunks) into hex.
+    // SHA-256 uses the multi-buffer kernel; BLAKE3 spreads the
+    // buffers over ThreadPool::Shared().
+    static void HashMany(HashAlgo algo, const uint8_t* const* data,
+                         const size_t* lens, size_t count, std::string* out);
+
+private:
+    std::variant<Sha256, Blake3> impl_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+// -------------------------------------------------------
+// DirWatcher
+// -------------------------------------------------------
+// Change notifications for a folder tree, from the OS rather
+// than by polling ('swvcs watch'):
+//   Windows — ReadDirectoryChangesW on the root, whole subtree
+//   Linux   — inotify, one watch per directory; directories
+//             created later are added as they appear
+// Other systems: Open() fails.  Wait() sleeps in the kernel
+// until something changes, so an idle watcher costs nothing.
+// .swvcs folders are not watched (Windows reports them with
+// the rest; callers filter by file type anyway).
+// -------------------------------------------------------
+
+#include "types.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct WatchBatch {
+    std::vector<fs::path> paths;        // created, written, renamed or deleted (may repeat)
+    bool                  overflow    = false;   // events were lost: rescan the tree
+    bool                  interrupted = false;   // Interrupt() was called
+};
+
+class DirWatcher {
+public:
+    DirWatcher() = default;
+    ~DirWatcher();
+
+    DirWatcher(const DirWatcher&)            = delete;
+    DirWatcher& operator=(const DirWatcher&) = delete;
+
+    Result Open(const fs::path& root);
+    void   Close();
+
+    // Block until something under the root changes, timeout_ms
+    // passes (-1 = no timeout) or Interrupt() is called.  Files
+    // already inside a newly created directory are reported too.
+    Result Wait(int timeout_ms, WatchBatch& out);
+
+    // Wake Wait() from another thread or a signal handler (it only
+    // writes to a pipe / sets an event, which is safe in both).
+    void Interrupt();
+
+private:
+    fs::path root_;
+#ifdef _WIN32
+    void* dir_        = nullptr;    // HANDLE
+    void* io_event_   = nullptr;    // HANDLE, signalled by the pending read
+    void* wake_event_ = nullptr;    // HANDLE, set by Interrupt()
+    void* overlapped_ = nullptr;    // OVERLAPPED*
+    std::vector<unsigned long> buffer_;   // DWORD-aligned notification records
+
+    Result Arm();
+#else
+    int fd_      = -1;              // inotify
+    int wake_[2] = { -1, -1 };      // self-pipe for Interrupt()
+    std::unordered_map<int, fs::path> dirs_;   // watch descriptor -> directory
+
+    Result AddTree(const fs::path& dir, std::vector<fs::path>* found);
+#endif
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+// -------------------------------------------------------
+// FileCopy
+// -------------------------------------------------------
+// Whole-file copy that lets the filesystem do the work where
+// it can.  Tried in order, first success wins:
+//
+//   1. reflink          — FICLONE: the copy shares the source's
+//                         extents (Btrfs, XFS, bcachefs), no
+//                         data is read or written
+//   2. copy_file_range  — in-kernel copy, no round trip
+//                         through user space (server-side on
+//                         NFS 4.2 / SMB)
+//      system copy      — CopyFileExW on Windows, which clones
+//                         blocks itself on ReFS / Dev Drive
+//   3. hard link        — only when the caller allows it: both
+//                         names must stay read-only, as store
+//                         objects do
+//   4. buffered copy    — read/write through a 1 MB buffer
+// -------------------------------------------------------
+
+#include "types.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace FileCopy {
+
+enum class Method {
+    Reflink,
+    CopyRange,
+    SystemCopy,
+    Hardlink,
+    Buffered,
+};
+
+// "reflink", "copy_file_range", ... for log output
+const char* MethodName(Method m);
+
+// Copy src to dst, which must not exist yet.  used receives the
+// method that succeeded.  On failure dst is not left behind.
+Result Copy(const fs::path& src, const fs::path& dst, bool allow_hardlink, Method& used);
+
+} // namespace FileCopy
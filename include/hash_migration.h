@@ -0,0 +1,28 @@
+#pragma once
+
+// -------------------------------------------------------
+// HashMigration
+// -------------------------------------------------------
+// Converts an existing repository to another content hash
+// algorithm ('swvcs migrate --hash <algo>'):
+//   1. Rehash every chunk and snapshot (in parallel) and link it
+//      and its thumbnail under the new name — old names stay valid
+//   2. Rewrite commits.hash / parent_hash / HEAD and hash_algo in
+//      one DB transaction
+//   3. Delete the old names (packed objects end up loose; run
+//      'swvcs repack' again afterwards)
+// If step 1 or 2 fails the repo is left on the old algorithm.
+// -------------------------------------------------------
+
+#include "types.h"
+#include "repository.h"
+
+class HashMigration {
+public:
+    explicit HashMigration(Repository& repo);
+
+    Result Run(HashAlgo to);
+
+private:
+    Repository& repo_;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+// -------------------------------------------------------
+// ImportEngine
+// -------------------------------------------------------
+// Turns folders of old versions (bracket_v1\, bracket_v2\,
+// bracket_FINAL2\, ...) into history ('swvcs import'):
+//   1. Find every .SLDPRT / .SLDASM / .SLDDRW under the given
+//      directories and order them by last write time
+//   2. Hash and store a batch of them at once on the thread pool
+//   3. Save the batch's commits and the new HEAD in one
+//      transaction, each version the parent of the next
+// SolidWorks isn't needed: a commit's properties (mass, material,
+// ...) stay empty unless a read_properties callback fills them in
+// ('swvcs import --properties' opens each file in SolidWorks for
+// it — one at a time, and slowly).
+// -------------------------------------------------------
+
+#include "types.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Repository;
+
+namespace fs = std::filesystem;
+
+struct ImportOptions {
+    // The document every file is a version of.  "" = the file's
+    // own name in the project folder, so bracket_v1\bracket.SLDPRT
+    // and bracket_v2\bracket.SLDPRT become one document's history.
+    std::string document;
+    size_t      batch = 256;   // files stored, then committed in one transaction
+
+    // Called for every new commit, on the calling thread, before it
+    // is saved: c.hash and c.sw_meta.doc_type are set, the rest of
+    // sw_meta is for the callback to fill in.
+    std::function<void(const fs::path& file, Commit& c)> read_properties;
+};
+
+struct ImportStats {
+    size_t  files         = 0;   // SolidWorks files found
+    size_t  commits       = 0;   // commits saved
+    size_t  duplicates    = 0;   // identical to a snapshot already committed, skipped
+    int64_t logical_bytes = 0;   // size of the files read
+    int64_t written_bytes = 0;   // bytes the store grew by
+};
+
+class ImportEngine {
+public:
+    explicit ImportEngine(Repository& repo);
+
+    // Import every SolidWorks file under dirs, oldest first, on top
+    // of HEAD.  Batches saved before a failure stay committed (with
+    // HEAD on the newest of them); re-running skips them as
+    // duplicates and carries on.
+    Result Run(const std::vector<fs::path>& dirs, const ImportOptions& options,
+               ImportStats& stats);
+
+private:
+    Repository& repo_;
+};
@@ -7,9 +7,11 @@
 #include "repository.h"
 #include "sw_connection.h"
 
+class QComboBox;
 class QListWidget;
 class QListWidgetItem;
 class QLabel;
+class QLineEdit;
 class QPushButton;
 class QTimer;
 
@@ -19,7 +21,8 @@ class QTimer;
 // Three-panel layout:
 //   Toolbar  │ [New Repo] [Open Repo]  repo path  |  SW status  [+ Commit]
 //   ─────────┼──────────────────────────────────────────────────────────────
-//   Left     │ Scrollable commit list (icon + hash + message)
+//   Left     │ Search box + document filter + scrollable commit list
+//            │ (icon + hash + message)
 //   Right    │ Thumbnail + metadata form + Revert button
 //   ─────────┴──────────────────────────────────────────────────────────────
 //   Status   │ SW connection info  │  HEAD hash
@@ -43,6 +46,8 @@ private:
     void setupUi();
     void loadRepo(const QString& dirPath, bool isNew = false);
     void refreshCommitList();
+    void refreshDocumentFilter();
+    void appendCommitPage();
     void showCommitDetail(const Commit& c);
     void clearDetail();
     void updateSwStatus();
@@ -57,7 +62,17 @@ private:
     QPushButton* commitBtn_;
 
     // ---- Left panel ----
+    QLineEdit*   searchBox_;
+    QTimer*      searchTimer_;                 // restarted per keystroke
+    std::string  listSearch_;                  // "" = whole history
+    static constexpr size_t kSearchLimit = 200;   // best matches shown
+    QComboBox*   docFilter_;                   // "All documents" or one file
+    std::string  listDoc_;                     // path shown, "" = all
     QListWidget* commitList_;
+    static constexpr size_t kListPage = 100;   // commits fetched per scroll
+    CommitCursor listCursor_;                  // last commit in the list
+    bool         listHasMore_ = false;
+    std::string  listHead_;                    // HEAD when the list was filled
 
     // ---- Right panel ----
     QLabel*      thumbLabel_;
@@ -0,0 +1,40 @@
+#pragma once
+
+// -------------------------------------------------------
+// MappedFile
+// -------------------------------------------------------
+// Read-only memory map of a whole file (pack indexes, the
+// commit-graph).  MapViewOfFile on Windows, mmap elsewhere.
+// Move-only; the mapping is released by Close() or the
+// destructor.
+// -------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const fs::path& path);
+    void Close();
+
+    const uint8_t* Data() const { return data_; }
+    size_t         Size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t         size_ = 0;
+#ifdef _WIN32
+    void*          mapping_ = nullptr;   // HANDLE
+#endif
+};
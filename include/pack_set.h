@@ -0,0 +1,112 @@
+#pragma once
+
+// -------------------------------------------------------
+// PackSet
+// -------------------------------------------------------
+// Read access to the pack files in .swvcs/packs/, written by
+// 'swvcs repack'.  A pack holds many loose objects (chunks,
+// manifests, deltas, full blobs, thumbnails, trees) in one file, so a
+// repository with years of history is a handful of files rather
+// than tens of thousands.
+//
+//   packs/pack-{id}.pack   ← object bytes, back to back, exactly
+//                            as they were stored loose
+//   packs/pack-{id}.idx    ← sorted (hash, kind) → offset, length
+//
+// Index format (little-endian):
+//   "SWVCSIDX"  u32 version (1)  u32 count
+//   u32 fanout[256]        — entries whose first hash byte <= i
+//   count × { u8 hash[32], u8 kind, u8 pad[7], u64 offset, u64 length }
+//
+// Indexes are memory-mapped and searched in place (fanout, then
+// binary search), so opening a pack costs nothing per object.
+// Object bytes are read with ordinary streaming file reads.
+// The .idx is renamed into place after its .pack, so a pack
+// without an index is an interrupted repack and is ignored.
+// -------------------------------------------------------
+
+#include "mapped_file.h"
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+enum class ObjectKind : uint8_t {
+    Chunk     = 1,
+    Manifest  = 2,
+    Delta     = 3,
+    Blob      = 4,   // legacy full copy
+    Thumbnail = 5,
+    Tree      = 6,
+};
+
+// One loose object to copy into a pack
+struct PackInput {
+    ObjectKind  kind;
+    std::string hash;
+    fs::path    path;
+};
+
+class PackSet {
+public:
+    // Receives consecutive pieces of an object
+    using Sink = std::function<void(const char* data, size_t len)>;
+
+    // Maps the index of every pack in dir (missing dir = no packs).
+    explicit PackSet(const fs::path& dir);
+
+    bool Has(ObjectKind kind, const std::string& hash) const;
+
+    // Stored bytes of an object, or -1 if it isn't packed.
+    int64_t Size(ObjectKind kind, const std::string& hash) const;
+
+    // Whole object into out.  Safe to call from several threads.
+    bool Read(ObjectKind kind, const std::string& hash, std::vector<char>& out) const;
+
+    // Object in 1 MB pieces, for large objects.
+    bool Stream(ObjectKind kind, const std::string& hash, const Sink& sink) const;
+
+    // Hashes of every packed object of one kind.
+    std::vector<std::string> List(ObjectKind kind) const;
+
+    // .pack and .idx files of every open pack
+    std::vector<fs::path> Files() const;
+    size_t PackCount() const { return packs_.size(); }
+
+    // Unmap every index (pack files can't be deleted while mapped
+    // on Windows).
+    void Close();
+
+    // Copy objects into new packs in dir, starting a new pack every
+    // kMaxPackBytes.  Loose files are left alone.  Each pack and
+    // index is flushed to disk before it is renamed into place, and
+    // dir after the last rename, so the caller may then delete the
+    // loose copies.
+    static constexpr uint64_t kMaxPackBytes = uint64_t{1} << 30;
+    static Result Write(const fs::path& dir, const std::vector<PackInput>& objects,
+                        size_t& packs_written);
+
+private:
+    struct Location {
+        const fs::path* pack   = nullptr;
+        uint64_t        offset = 0;
+        uint64_t        length = 0;
+    };
+
+    struct Pack {
+        fs::path   pack_path;
+        fs::path   index_path;
+        MappedFile index;
+        uint32_t   count = 0;
+    };
+
+    bool Find(ObjectKind kind, const std::string& hash, Location& loc) const;
+
+    std::vector<Pack> packs_;
+};
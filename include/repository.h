@@ -13,34 +13,53 @@
 //
 // Storage layout:
 //   .swvcs/
-//     swvcs.db       ← SQLite database (commits + config)
-//     blobs/         ← raw .SLDPRT snapshots (unchanged)
+//     swvcs.db       ← SQLite database (commits, config, stat cache)
+//     commit-graph   ← parent links for ancestry queries (see CommitGraph)
+//     blobs/         ← snapshot manifests (+ legacy full copies)
+//     chunks/        ← deduplicated snapshot chunks (see BlobStore)
 //     thumbs/        ← 256x256 BMP previews  (unchanged)
 // -------------------------------------------------------
 
 #include "types.h"
+#include "compression.h"
+#include "content_hash.h"
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <unordered_map>
 
 // Forward-declare SQLite::Database so the SQLiteCpp headers
 // are only compiled in repository.cpp, not everywhere.
-namespace SQLite { class Database; }
+namespace SQLite { class Database; class Statement; }
 
 namespace fs = std::filesystem;
 
+// ReadOnly opens an existing repository's database read-only: no
+// folders or database are created and no schema work is done, so
+// query commands take no write lock and need no write access.
+enum class OpenMode { ReadWrite, ReadOnly };
+
 class Repository {
 public:
-    // Open an existing repo or create a new one.
+    // Open an existing repo or (ReadWrite) create a new one.
     // project_dir: the folder that contains your .SLDPRT / .SLDASM files.
-    explicit Repository(const fs::path& project_dir);
+    explicit Repository(const fs::path& project_dir, OpenMode mode = OpenMode::ReadWrite);
 
     // Destructor defined in .cpp (SQLite::Database must be complete there).
     ~Repository();
 
+    // True if project_dir has a repository (without opening it).
+    static bool Exists(const fs::path& project_dir);
+
     // Returns true if the repo was opened / created successfully.
     bool IsValid() const { return valid_; }
+    bool IsReadOnly() const { return read_only_; }
+
+    // Opened ReadOnly, but the schema is older than this build and
+    // has to be upgraded by a ReadWrite open first.
+    bool NeedsUpgrade() const { return needs_upgrade_; }
 
     // -------------------------------------------------------
     // Commits
@@ -49,11 +68,95 @@ public:
     // Persist a new commit record to the database.
     Result SaveCommit(const Commit& c);
 
-    // Load a commit by its full hash or a 7+ char prefix.
+    // SaveCommit for many commits, then HEAD (unless head is empty),
+    // in one transaction — all are saved or none.  Used by ImportEngine
+    // and for group commits.
+    Result SaveCommits(const std::vector<Commit>& commits, const std::string& head = "");
+
+    // Load a commit by its full hash or a unique prefix of at least
+    // kMinHashPrefix hex digits.  A prefix shared by several commits
+    // fails with "Ambiguous hash prefix" rather than picking one.
+    static constexpr size_t kMinHashPrefix = 4;
     Result LoadCommit(const std::string& hash_prefix, Commit& out);
 
-    // Return all commits, newest first.
-    std::vector<Commit> ListCommits();
+    // Visit commits newest first (by time, ties by hash) until
+    // query.limit is reached or fn returns false.  Commits are read
+    // a page at a time by key, so the first one arrives in constant
+    // time however long the history, and no query is open while fn
+    // runs (fn may use the repository).  last, if given, receives
+    // the key of the last commit visited — pass it as query.after to
+    // continue from there.
+    using CommitVisitor = std::function<bool(const Commit&)>;
+    Result ForEachCommit(const CommitQuery& query, const CommitVisitor& fn,
+                         CommitCursor* last = nullptr);
+
+    // One page: up to query.limit commits (0 = all) after query.after.
+    // The members of a group commit are listed only with a
+    // query.doc_path, as that document's history; otherwise the
+    // group stands for them.
+    std::vector<Commit> ListCommits(const CommitQuery& query);
+
+    // The member commits of a group commit, by document path.
+    std::vector<Commit> ListGroupMembers(const std::string& group_hash);
+
+    // The same page, reading only the columns CommitSummary has, into
+    // out's arena (appended to what out holds).  For long lists: a
+    // page of 100k summaries is a few dozen allocations, where
+    // ListCommits makes several per commit.
+    Result ListCommitSummaries(const CommitQuery& query, CommitSummaries& out);
+
+    // Commits whose message, material or file path contain every
+    // term of text, best match first (a message match ranks above a
+    // material or path match).  Terms match the start of words;
+    // "double quotes" make a phrase.  query.doc_path, since and limit
+    // (0 = all) narrow the results; query.after is not used.
+    std::vector<Commit> SearchCommits(const std::string& text, const CommitQuery& query);
+
+    // Every working file that has commits, by path.
+    std::vector<Document> ListDocuments();
+
+    // documents.id of a path, 0 if it has no commits.
+    int64_t FindDocument(const std::string& path);
+
+    // Identity of a document path: two spellings of the same file
+    // (separators, "..", case on Windows) give the same key.
+    static std::string DocumentKey(const std::string& path);
+
+    // What a group commit's hash is taken over: its parent, time and
+    // message, and each member's snapshot and DocumentKey, in
+    // doc_path order.
+    static std::string GroupIdText(const Commit& group, const std::vector<Commit>& members);
+
+    int64_t CommitCount();
+
+    // Hash, parent and time of every commit saved after row
+    // after_seq, in save order — one scan, no Commit objects.  fn
+    // must not call back into the repository.  Used by CommitGraph.
+    using LinkVisitor = std::function<void(const CommitLink&)>;
+    Result ForEachCommitLink(int64_t after_seq, const LinkVisitor& fn);
+
+    // The same for the numeric metadata columns.  Used by TrendCache.
+    using MetricsVisitor = std::function<void(const CommitMetrics&)>;
+    Result ForEachCommitMetrics(int64_t after_seq, const MetricsVisitor& fn);
+
+    // Replace snapshot hashes everywhere they are used as keys
+    // (commits.hash, commits.parent_hash, commits.group_hash, HEAD)
+    // and record the new hash algorithm — all in one transaction.
+    // The stat cache and commit-graph are dropped, since their
+    // hashes are in the old algorithm.  Used by HashMigration.
+    Result RewriteHashes(const std::vector<std::pair<std::string, std::string>>& old_to_new,
+                         HashAlgo algo);
+
+    // -------------------------------------------------------
+    // Stat cache (one row per working file, see StatCache)
+    // -------------------------------------------------------
+    bool   LoadStatEntry(const std::string& doc_path, StatEntry& out);
+    Result SaveStatEntry(const StatEntry& e);
+
+    // Every row, and many rows in one transaction — for working on
+    // a whole project folder at once
+    Result LoadStatEntries(std::vector<StatEntry>& out);
+    Result SaveStatEntries(const std::vector<StatEntry>& entries);
 
     // -------------------------------------------------------
     // HEAD management
@@ -61,25 +164,125 @@ public:
     std::string GetHead();
     Result      SetHead(const std::string& hash);
 
+    // -------------------------------------------------------
+    // Config (key/value table: version, HEAD, hash_algo, ...)
+    // -------------------------------------------------------
+    std::string GetConfig(const std::string& key, const std::string& fallback = "");
+    Result      SetConfig(const std::string& key, const std::string& value);
+
+    // Content hash of this repository's snapshots and chunks.
+    HashAlgo GetHashAlgo() const { return hash_algo_; }
+
+    // zstd settings for new objects (compression_level, compression_long).
+    CompressionOptions GetCompressionOptions();
+
+    // Delta mode: longest chain of deltas before a full snapshot is
+    // stored again (config delta_chain).  0 = off, every snapshot full.
+    int GetDeltaChain();
+
+    // Delta mode: largest file stored as a delta, in bytes (config
+    // delta_max_mb, default 512); larger ones are stored as full
+    // snapshots.  0 = no limit.
+    int64_t GetDeltaMaxBytes();
+
+    // Full-copy mode (config storage = full): snapshots are stored
+    // as plain uncompressed files so they can be reflinked.
+    bool GetFullCopies();
+
+    // Choose the hash algorithm of a repository with no commits yet.
+    // Repos with history must be converted with HashMigration.
+    Result SetHashAlgo(HashAlgo algo);
+
     // -------------------------------------------------------
     // File paths — blobs and thumbnails stay on disk
     // -------------------------------------------------------
+    // Legacy full-copy blob ({hash}.bin).  New snapshots are stored
+    // as a manifest + chunks instead — go through BlobStore.
     fs::path BlobPath(const std::string& hash) const;
+    fs::path ManifestPath(const std::string& hash) const;
+    fs::path TreePath(const std::string& hash) const;
+    fs::path DeltaPath(const std::string& hash) const;
+    fs::path ChunkPath(const std::string& chunk_hash) const;
     fs::path ThumbnailPath(const std::string& hash) const;
+    fs::path CommitGraphPath() const { return repo_root_ / "commit-graph"; }
 
     // -------------------------------------------------------
     // Directory paths
     // -------------------------------------------------------
+    fs::path ProjectDir() const { return project_dir_; }
     fs::path Root()     const { return repo_root_; }
-    fs::path BlobsDir() const { return repo_root_ / "blobs"; }
+    fs::path BlobsDir()  const { return repo_root_ / "blobs"; }
+    fs::path ChunksDir() const { return repo_root_ / "chunks"; }
+    fs::path PacksDir()  const { return repo_root_ / "packs"; }
+    fs::path ThumbsDir() const { return repo_root_ / "thumbs"; }
 
 private:
     fs::path project_dir_;
     fs::path repo_root_;   // project_dir_ / ".swvcs"
     bool     valid_ = false;
+    bool     read_only_     = false;
+    bool     needs_upgrade_ = false;
+    int      version_       = 0;       // schema version after opening
+    HashAlgo hash_algo_ = HashAlgo::Sha256;
 
     std::unique_ptr<SQLite::Database> db_;
 
-    void Init();        // create dirs, open DB
-    void InitSchema();  // CREATE TABLE IF NOT EXISTS
+    // Compiled statements by SQL text.  Declared after db_ so they
+    // are finalized before the connection closes.
+    std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>> statements_;
+
+    // A statement borrowed from statements_ for one call: reset and
+    // its bindings cleared when the handle goes out of scope.
+    class CachedStatement {
+    public:
+        explicit CachedStatement(SQLite::Statement& q) : q_(q) {}
+        ~CachedStatement();
+        CachedStatement(const CachedStatement&)            = delete;
+        CachedStatement& operator=(const CachedStatement&) = delete;
+
+        SQLite::Statement& operator*()  { return q_; }
+        SQLite::Statement* operator->() { return &q_; }
+
+    private:
+        SQLite::Statement& q_;
+    };
+    CachedStatement Prepare(const std::string& sql);
+
+    static constexpr size_t kCommitPage = 64;   // rows per ForEachCommit page
+
+    void SetGroup(const Commit& c);   // record c.group_hash (v7)
+
+    // The ListCommits query selecting columns; row is called per row
+    using RowReader = std::function<void(SQLite::Statement&)>;
+    Result QueryCommitPage(const CommitQuery& query, const char* columns, const RowReader& row);
+
+    void Init();                 // create dirs, open DB
+    void ConfigureConnection();  // WAL + pragmas
+
+    // Schema (see "Schema" in repository.cpp)
+    static constexpr int kSchemaVersion = 7;
+    struct Migration {
+        int         version;     // config.version once applied
+        const char* what;
+        bool (Repository::*apply)();
+    };
+    static const Migration kMigrations[];
+
+    void ReadHeader(int& version, std::string& algo);
+    void OpenSchema(int& version);   // create or upgrade to kSchemaVersion
+    void CreateSchema();             // v5 layout of a new database
+    void CreateSupportTables();      // config + stat_cache
+    void CreateCommitsTable();       // v5 commits table + indexes
+    bool MigrateToV3();              // property columns
+    bool MigrateToV4();              // hex TEXT keys -> binary keys + time
+    bool MigrateToV5();              // documents table + commits.doc_id
+    bool MigrateToV6();              // commits_fts search index
+    bool MigrateToV7();              // commits.group_hash
+
+    // documents.id of path (0 if it has none); create adds the row.
+    // Throws SQLite::Exception.
+    int64_t DocumentId(const std::string& path, bool create);
+
+    // Config read that throws SQLite::Exception (usable inside Init)
+    std::string GetConfigUnchecked(const std::string& key, const std::string& fallback = "");
 };
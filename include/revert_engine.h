@@ -5,15 +5,22 @@
 // -------------------------------------------------------
 // Restores the working file to a previously committed state:
 //   1. Close the document in SolidWorks (so the file is unlocked)
-//   2. Copy the blob back over the working file
+//   2. Restore the stored snapshot over the working file
 //   3. Reopen the file in SolidWorks
 //   4. Update HEAD
+// A group commit ('commit --all-open') restores each of its
+// files the same way, and a project snapshot ('snapshot') each
+// file that differs from it: those open in SolidWorks are closed
+// first and reopened after, and HEAD moves to the group or tree.
 // -------------------------------------------------------
 
 #include "types.h"
 #include "repository.h"
 #include "sw_connection.h"
 
+#include <string>
+#include <vector>
+
 class RevertEngine {
 public:
     RevertEngine(Repository& repo, SwConnection& sw);
@@ -24,6 +31,15 @@ public:
     Result Revert(const std::string& hash_prefix);
 
 private:
+    struct FileVersion {
+        std::string hash;   // snapshot to restore
+        std::string path;   // over this working file
+    };
+
+    Result RevertGroup(const Commit& group);
+    Result RevertTree(const Commit& tree_commit);
+    Result RestoreAll(const Commit& target, const std::vector<FileVersion>& files);
+
     Repository&   repo_;
     SwConnection& sw_;
 };
\ No newline at end of file
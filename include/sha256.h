@@ -0,0 +1,64 @@
+#pragma once
+
+// -------------------------------------------------------
+// Sha256
+// -------------------------------------------------------
+// Portable incremental SHA-256.  Feed bytes with Update() as
+// they are read, then call Final() / HexDigest() once.
+//
+// The compression function is picked once at startup from
+// what the CPU supports:
+//   ShaNi  — x86 SHA extensions (single stream, fastest)
+//   Avx2   — scalar single stream, 8-lane AVX2 for HashMany()
+//   Scalar — plain C++, any platform
+//
+// Used for whole-file snapshot hashes and for naming chunks
+// in the chunk store (BlobStore).
+// -------------------------------------------------------
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class Sha256Impl {
+    Scalar,
+    Avx2,
+    ShaNi,
+};
+
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void Update(const void* data, size_t len);
+
+    // Finish the hash.  Call once; the object is spent afterwards.
+    Digest      Final();
+    std::string HexDigest();
+
+    // Convenience: hash a single buffer.
+    static std::string Of(const void* data, size_t len);
+
+    // Hash count independent buffers (e.g. a batch of chunks).
+    // Uses the 8-lane AVX2 kernel when that is the active
+    // implementation; otherwise hashes them one after another.
+    static void HashMany(const uint8_t* const* data, const size_t* lens,
+                         size_t count, Digest* out);
+
+    // Implementation selection.  Active() is the best one the CPU
+    // supports unless Force() was called (benchmarks only — not
+    // thread-safe).  Force() returns false if impl is unsupported.
+    static Sha256Impl  Active();
+    static bool        Supported(Sha256Impl impl);
+    static bool        Force(Sha256Impl impl);
+    static const char* Name(Sha256Impl impl);
+
+private:
+    uint32_t state_[8];
+    uint8_t  block_[64];
+    size_t   block_len_ = 0;   // bytes buffered in block_
+    uint64_t total_     = 0;   // bytes fed so far
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+// -------------------------------------------------------
+// StatCache
+// -------------------------------------------------------
+// Remembers the size, last write time and file id of each
+// working file when it was hashed (stat_cache table), like
+// git's index.  If all three still match, the file hasn't
+// changed and its hash is known without reading a byte —
+// 'swvcs status' and 'swvcs commit' of an untouched 500 MB
+// assembly cost one stat() instead of a full read.
+//
+// Racy timestamps: a write that lands in the same timestamp
+// tick as the hash leaves size and mtime unchanged.  An
+// entry is therefore only trusted if the file's mtime is
+// at least kRacyWindowNs older than the moment the entry
+// was recorded; anything newer is rehashed (and re-recorded,
+// so the next lookup is trusted).
+// -------------------------------------------------------
+
+#include "types.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Repository;
+
+namespace fs = std::filesystem;
+
+// What stat() says about a file right now
+struct FileStat {
+    bool     valid    = false;
+    int64_t  size     = 0;
+    int64_t  mtime_ns = 0;
+    uint64_t device   = 0;
+    uint64_t inode    = 0;
+};
+
+class StatCache {
+public:
+    // Covers FAT's 2 s timestamps and SMB servers that round to
+    // whole seconds; NTFS and ext4 are far finer.
+    static constexpr int64_t kRacyWindowNs = 2'000'000'000;
+
+    explicit StatCache(Repository& repo);
+
+    // Size, last write time and file id of path.  mtime_ns uses
+    // the same clock as NowNs().
+    static FileStat Stat(const fs::path& path);
+    static int64_t  NowNs();
+
+    // Cached hash of path if the file provably hasn't changed since
+    // it was recorded, else "".  now receives the current stat —
+    // take it before reading the file and pass it to Record().
+    std::string Lookup(const fs::path& path, FileStat* now = nullptr);
+
+    // Remember that path, as it was when 'seen' was taken, has hash.
+    void Record(const fs::path& path, const FileStat& seen, const std::string& hash);
+
+    // Hash of path from the cache, or by reading the file (then
+    // cached).  from_cache tells which.
+    Result Hash(const fs::path& path, std::string& hash, bool& from_cache);
+
+    // Hash of path by reading it, bypassing the cache.  Touches no
+    // database, so it may be called from several threads.
+    Result HashContents(const fs::path& path, std::string& hash) const;
+
+    // For a whole project folder at once: Preload() reads every row
+    // into memory in one query, and Lookup(path, now) then checks a
+    // stat the caller already took against it — no database access,
+    // so it may be called from several threads.  RecordAll saves the
+    // new rows (see Entry) in one transaction.
+    Result      Preload();
+    std::string Lookup(const fs::path& path, const FileStat& now) const;
+    StatEntry   Entry(const fs::path& path, const FileStat& seen, const std::string& hash) const;
+    void        RecordAll(const std::vector<StatEntry>& entries);
+
+private:
+    static std::string Key(const fs::path& path);
+    static bool        Matches(const StatEntry& e, const FileStat& st);
+
+    Repository& repo_;
+    std::unordered_map<std::string, StatEntry> preloaded_;   // by Key()
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+// -------------------------------------------------------
+// StatusEngine
+// -------------------------------------------------------
+// Which SolidWorks files in the project folder differ from
+// the newest project snapshot ('swvcs status'):
+//   1. Walk the folder on the thread pool, stat()ing each file
+//      (TreeSnapshot::Walk), and merge it with the snapshot's
+//      tree by path — files on one side only are new or deleted
+//   2. For the rest, the preloaded stat cache vouches for most;
+//      a different size proves a change without reading
+//   3. Only the remaining files are read and hashed, in parallel
+// Nothing goes into the store, so on a 5000-file project
+// the cost is the walk plus one read per file touched since
+// it was last hashed.
+// -------------------------------------------------------
+
+#include "types.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Repository;
+
+struct FileChange {
+    enum class Kind { Modified, New, Deleted };
+    Kind        kind = Kind::Modified;
+    std::string path;           // relative to the project folder, '/'-separated
+};
+
+struct WorkspaceStatus {
+    bool                    have_snapshot = false;
+    Commit                  snapshot;         // compared against, if have_snapshot
+    std::vector<FileChange> changes;          // sorted by path
+    size_t                  files  = 0;       // SolidWorks files in the folder now
+    size_t                  hashed = 0;       // read (the stat cache couldn't vouch for them)
+};
+
+class StatusEngine {
+public:
+    explicit StatusEngine(Repository& repo);
+
+    // Compare the project folder with its newest snapshot.  Without
+    // one there is nothing to compare: only files is filled in.
+    // Hashes computed here are recorded in the stat cache unless the
+    // repository is open read-only.
+    Result Run(WorkspaceStatus& status);
+
+private:
+    Repository& repo_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+// -------------------------------------------------------
+// StringArena
+// -------------------------------------------------------
+// Bump allocator for the strings of one query result.  Strings
+// are copied end to end into a few large blocks (each twice the
+// size of the last, up to kMaxBlock) and handed out as
+// string_views, so a page of 100k commit summaries costs a couple
+// of dozen allocations rather than several per row.  Nothing is
+// freed until the arena is: the views live exactly as long as it.
+//
+// Intern() additionally keeps one copy per distinct value, for
+// columns with few of them (author names).
+//
+// Moving the arena keeps its views valid (the blocks don't move);
+// copying it is not allowed.
+// -------------------------------------------------------
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+class StringArena {
+public:
+    static constexpr size_t kFirstBlock = 4 * 1024;
+    static constexpr size_t kMaxBlock   = 1024 * 1024;
+
+    StringArena() = default;
+    StringArena(StringArena&&) noexcept            = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+    StringArena(const StringArena&)                = delete;
+    StringArena& operator=(const StringArena&)     = delete;
+
+    // n bytes, valid as long as the arena, not aligned.
+    char* Allocate(size_t n);
+
+    // A copy of s.
+    std::string_view Add(std::string_view s);
+
+    // A copy of s shared with every earlier Intern() of the same value.
+    std::string_view Intern(std::string_view s);
+
+    // Drop every string (the views become invalid) and all blocks
+    // but the newest, which is reused.
+    void Clear();
+
+    size_t Blocks() const { return blocks_.size(); }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_size_ = 0;   // size of blocks_.back()
+    char*  next_       = nullptr;
+    size_t left_       = 0;
+
+    std::unordered_set<std::string_view> interned_;
+};
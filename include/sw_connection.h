@@ -30,6 +30,7 @@
 #endif
 
 #include <string>
+#include <vector>
 
 struct ActiveDocInfo {
     std::string path;        // full file path
@@ -59,13 +60,25 @@ public:
     // Get info about whichever document is currently active.
     Result GetActiveDocInfo(ActiveDocInfo& out);
 
-    // Ask SolidWorks to save the active document to its current path.
+    // Every document SolidWorks has loaded: open windows and the
+    // parts and sub-assemblies open assemblies load.
+    Result ListOpenDocs(std::vector<ActiveDocInfo>& out);
+
+    // Point the save and metadata helpers below at an open document
+    // other than the active one, without activating its window.  The
+    // next GetActiveDocInfo() points them back at the active one.
+    Result SelectDoc(const std::string& path);
+
+    // Ask SolidWorks to save the active (or selected) document to its current path.
     Result SaveActiveDoc();
 
     // Close the active document (prompts SW if there are unsaved changes
     // unless force_close = true, which discards them).
     Result CloseActiveDoc(bool force_close = false);
 
+    // Close the open document at path, active or not.
+    Result CloseDoc(const std::string& path);
+
     // Open a file in SolidWorks.
     Result OpenDoc(const std::string& file_path);
 
@@ -94,6 +107,8 @@ private:
     IDispatch* sw_app_  = nullptr;   // SldWorks.Application
     IDispatch* sw_doc_  = nullptr;   // IModelDoc2
 
+    void ReadDocInfo(IDispatch* doc, ActiveDocInfo& out);
+
     // Helper: invoke a COM method on an IDispatch object by name.
     HRESULT Invoke(IDispatch* disp, const wchar_t* method,
                    WORD flags, VARIANT* result,
@@ -0,0 +1,51 @@
+#pragma once
+
+// -------------------------------------------------------
+// ThreadPool
+// -------------------------------------------------------
+// Fixed set of worker threads for CPU-bound storage work
+// (hashing, rehashing).  ThreadPool::Shared() sizes itself to
+// the machine and lives for the whole process.
+//
+// ParallelFor(n, fn) runs fn(0..n-1) across the workers and
+// returns when all calls are done.  The calling thread takes
+// items too, so ParallelFor may safely be called from inside
+// another pool task — it never waits on a queued task.
+// -------------------------------------------------------
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads = 0 → one per hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a fire-and-forget task.
+    void Post(std::function<void()> task);
+
+    // Run fn(i) for every i in [0, count), spread over the pool.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    unsigned Size() const { return static_cast<unsigned>(workers_.size()); }
+
+    static ThreadPool& Shared();
+
+private:
+    std::vector<std::thread>          workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex                        mutex_;
+    std::condition_variable           cv_;
+    bool                              stopping_ = false;
+
+    void WorkerLoop();
+};
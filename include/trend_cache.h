@@ -0,0 +1,79 @@
+#pragma once
+
+// -------------------------------------------------------
+// TrendCache
+// -------------------------------------------------------
+// The numeric metadata of every commit (mass, volume, bounding
+// box, ...) held in memory as one column per metric and document,
+// so that "how has the mass of bracket.SLDPRT changed" is a scan
+// over a contiguous array of doubles rather than a LoadCommit per
+// revision.
+//
+// The cache remembers the newest commits row it has read.  Sync()
+// reads only the rows saved since — one row after a single commit,
+// including commits made by another process — and falls back to a
+// full reload when a commit was re-saved or the hash algorithm
+// changed under it.
+// -------------------------------------------------------
+
+#include "content_hash.h"
+#include "types.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Repository;
+
+const char* MetricName(Metric m);   // "mass", "bbox_x", ...
+const char* MetricUnit(Metric m);   // "kg", "mm", ... ("" for counts)
+bool        ParseMetric(const std::string& name, Metric& out);
+
+struct TrendStep {
+    int64_t     time   = 0;     // Unix seconds
+    std::string hash;
+    double      value  = 0.0;
+    double      change = 0.0;   // relative to the previous step, 0.05 = +5%
+};
+
+struct TrendReport {
+    std::vector<TrendStep> steps;         // oldest first; commits without the value are left out
+    size_t                 min = 0;       // index into steps
+    size_t                 max = 0;
+    std::vector<size_t>    regressions;   // steps whose |change| exceeds the threshold
+};
+
+class TrendCache {
+public:
+    explicit TrendCache(Repository& repo);
+
+    // Read the commits saved since the last Sync().
+    Result Sync();
+
+    // Sync(), then the history of one metric of one document from
+    // since (Unix seconds, 0 = all) on.  threshold is relative: 0.05
+    // flags every change of more than 5%.
+    Result Analyse(const std::string& doc_path, Metric metric, double threshold,
+                   int64_t since, TrendReport& out);
+
+private:
+    struct Series {
+        std::vector<int64_t>     time;
+        std::vector<std::string> hash;
+        std::vector<double>      values[kMetricCount];   // indexed by Metric
+        bool                     sorted = true;          // by (time, hash)
+    };
+
+    void Clear();
+    void Add(const CommitMetrics& m);
+    static void Sort(Series& s);
+
+    Repository& repo_;
+    int64_t     seq_  = 0;    // newest commits row read
+    HashAlgo    algo_ = HashAlgo::Sha256;
+
+    std::unordered_map<int64_t, Series> series_;   // by documents.id
+    std::unordered_set<std::string>     known_;    // hashes read so far
+};
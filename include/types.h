@@ -1,18 +1,34 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
+#include "string_arena.h"
+
 // -------------------------------------------------------
 // A single committed snapshot
 // -------------------------------------------------------
+// or a group of them ('swvcs commit --all-open'): one commit per
+// changed document, each with group_hash set, and the group commit
+// itself — doc_type "Group", no document, hashed over its members —
+// which is what HEAD and the history point at.
+// A project snapshot ('swvcs snapshot') is one commit of doc_type
+// "Tree": its hash names a tree object (see TreeEntry) and its
+// doc_path is the project folder.
 struct Commit {
-    std::string hash;           // SHA-256 of the snapshot content
+    static constexpr const char* kGroupType = "Group";
+    static constexpr const char* kTreeType  = "Tree";
+
+    std::string hash;           // content hash of the snapshot (SHA-256 or BLAKE3)
     std::string message;        // user-provided description
     std::string timestamp;      // ISO-8601 e.g. "2025-02-17T14:32:00Z"
+    int64_t     time = 0;       // timestamp as Unix seconds (set by SaveCommit)
     std::string parent_hash;    // empty string if this is the first commit
     std::string author;         // machine username for now
+    std::string group_hash;     // the group commit this is a member of ("" = none)
 
     // SW-specific metadata captured at commit time
     struct SwMeta {
@@ -28,8 +44,116 @@ struct Commit {
         double      bbox_z = 0;         // bounding box Z extent, mm
         int         config_count = 0;   // number of configurations
         int64_t     blob_size_bytes = 0; // file size of the stored snapshot
+        int64_t     stored_size_bytes = 0; // disk space the commit added (compressed, new chunks only)
     } sw_meta;
+
+    bool IsGroup() const { return sw_meta.doc_type == kGroupType; }
+    bool IsTree()  const { return sw_meta.doc_type == kTreeType; }
+};
+
+// -------------------------------------------------------
+// Commit listing (newest first, see Repository::ForEachCommit)
+// -------------------------------------------------------
+// Sort key of a commit: where the next page starts.
+struct CommitCursor {
+    int64_t     time = 0;
+    std::string hash;
+
+    bool AtStart() const { return hash.empty(); }
+};
+
+struct CommitQuery {
+    CommitCursor after;      // start after this commit (default: the newest)
+    size_t       limit = 0;  // at most this many commits, 0 = all
+    int64_t      since = 0;  // only commits at/after this Unix time, 0 = all
+                             // (see Utils::ParseTimestamp)
+    std::string  doc_path;   // only commits of this file ("" = all)
+};
+
+// One row of a commit list (Repository::ListCommitSummaries): the
+// columns a list shows, without the properties.  The strings point
+// into the CommitSummaries holding the row and live as long as it.
+struct CommitSummary {
+    int64_t          time = 0;   // Unix seconds
+    std::string_view hash;       // hex
+    std::string_view timestamp;
+    std::string_view message;
+    std::string_view author;     // interned: one copy per name
+
+    CommitCursor Cursor() const { return {time, std::string(hash)}; }
+};
+
+struct CommitSummaries {
+    std::vector<CommitSummary> rows;
+    StringArena                strings;
+
+    void Clear() { rows.clear(); strings.Clear(); }
+};
+
+// A working file with commits (see Repository::ListDocuments)
+struct Document {
+    int64_t     id      = 0;
+    std::string path;        // as first committed
+    int64_t     commits = 0;
+};
+
+// -------------------------------------------------------
+// Graph columns of a commit row (see CommitGraph)
+// -------------------------------------------------------
+struct CommitLink {
+    int64_t     seq  = 0;   // row id — grows as commits are saved
+    std::string hash;       // raw 32-byte digest
+    std::string parent;     // raw 32-byte digest, empty for a root commit
+    int64_t     time = 0;   // Unix seconds
+};
+
+// -------------------------------------------------------
+// Numeric metadata of a commit row (see TrendCache)
+// -------------------------------------------------------
+enum class Metric : uint8_t {
+    Mass,
+    Volume,
+    SurfaceArea,
+    BboxX,
+    BboxY,
+    BboxZ,
+    FeatureCount,
+};
+constexpr size_t kMetricCount = 7;
+
+struct CommitMetrics {
+    int64_t     seq    = 0;    // row id — grows as commits are saved
+    int64_t     doc_id = 0;    // documents row, 0 if none
+    int64_t     time   = 0;    // Unix seconds
+    std::string hash;
+    double      values[kMetricCount] = {};   // indexed by Metric, 0 = not captured
+};
+
+// -------------------------------------------------------
+// Stat cache row — what a working file looked like when it
+// was last hashed (see StatCache)
+// -------------------------------------------------------
+struct StatEntry {
+    std::string doc_path;       // absolute path of the working file
+    int64_t     size      = 0;
+    int64_t     mtime_ns  = 0;  // last write time, ns since the Unix epoch
+    uint64_t    device    = 0;  // volume serial / st_dev
+    uint64_t    inode     = 0;  // file index / st_ino
+    std::string hash;           // content hash at that point
+    int64_t     cached_ns = 0;  // when the row was written (same clock as mtime_ns)
+};
+
+// -------------------------------------------------------
+// One file of a project snapshot.  A tree object is the list
+// of them, sorted by path (see TreeSnapshot)
+// -------------------------------------------------------
+struct TreeEntry {
+    std::string path;           // relative to the project folder, '/'-separated
+    std::string hash;           // snapshot hash of the file
+    int64_t     size     = 0;
+    int64_t     mtime_ns = 0;   // last write time when it was snapshotted
 };
+using Tree = std::vector<TreeEntry>;
 
 // -------------------------------------------------------
 // Result of a SW connection attempt
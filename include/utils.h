@@ -1,6 +1,8 @@
 #pragma once
 
 #include "types.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,10 +14,36 @@ void PrintCommit(const Commit& c, bool show_full_hash = false);
 // Format bytes as a human-readable string e.g. "14.3 MB"
 std::string FormatBytes(uintmax_t bytes);
 
+// Lowercase hex encoding of a byte string (hashes, digests)
+std::string ToHex(const uint8_t* bytes, size_t len);
+// Same, into out[0 .. 2*len) — no allocation
+void ToHex(const uint8_t* bytes, size_t len, char* out);
+
+// Decode exactly len bytes of hex (either case); false if hex is
+// the wrong length or not hex.
+bool FromHex(const std::string& hex, uint8_t* out, size_t len);
+
+// Parse an ISO-8601 UTC time — "2025-02-17T14:32:00Z", or a
+// prefix of it down to "2025-02-17" — into Unix seconds.
+bool ParseTimestamp(const std::string& iso, int64_t& epoch);
+
+// Unix seconds -> "2025-02-17" (UTC)
+std::string FormatDate(int64_t epoch);
+
+// Unix seconds -> "2025-02-17T14:32:00Z", what ParseTimestamp reads
+std::string FormatTimestamp(int64_t epoch);
+
 // Trim whitespace from both ends of a string
 std::string Trim(const std::string& s);
 
 // Case-insensitive string compare
 bool IEquals(const std::string& a, const std::string& b);
 
+// "Part", "Assembly" or "Drawing" by a file name's extension
+// (.SLDPRT / .SLDASM / .SLDDRW, any case); "" for other files
+std::string SwDocType(const std::string& filename);
+
+// The logged-in user's name ($USERNAME / $USER), "" if unknown
+std::string UserName();
+
 } // namespace Utils
\ No newline at end of file
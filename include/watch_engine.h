@@ -0,0 +1,68 @@
+#pragma once
+
+// -------------------------------------------------------
+// WatchEngine
+// -------------------------------------------------------
+// Commits SolidWorks files as they are saved ('swvcs watch'):
+//   1. DirWatcher reports writes under the project folder; the
+//      loop sleeps in the kernel between them
+//   2. A file counts as saved once debounce_ms pass without a
+//      write and its size and mtime are still what they were
+//      at the last one — a SolidWorks save is a burst of writes
+//      (and a rename), and this waits for the end of it
+//   3. Saved files go on a queue of at most max_queue — while
+//      it is full they wait their turn; a file queued less than
+//      interval_s ago waits out the rest of the interval
+//   4. A background thread takes everything queued, hashes and
+//      stores it in parallel and saves the commits in one
+//      transaction (stat cache, delta against the file's last
+//      commit, as 'swvcs commit').  Files whose snapshot is
+//      already committed are skipped.
+// No SolidWorks needed: the commits carry no properties.
+// -------------------------------------------------------
+
+#include "dir_watcher.h"
+#include "types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class Repository;
+
+namespace fs = std::filesystem;
+
+struct WatchOptions {
+    int    debounce_ms = 3000;   // quiet time after a file's last write
+    int    interval_s  = 300;    // at most one commit per file per interval
+    size_t max_queue   = 32;     // saved files waiting to be committed
+};
+
+struct WatchStats {
+    size_t commits   = 0;   // commits saved
+    size_t unchanged = 0;   // saved files whose snapshot was already committed
+    size_t deferred  = 0;   // saved files that found the queue full and waited
+    size_t failed    = 0;   // files that could not be stored
+};
+
+class WatchEngine {
+public:
+    explicit WatchEngine(Repository& repo);
+
+    // Watch the project folder and commit saved files until Stop().
+    // Files already queued are committed before it returns.
+    Result Run(const WatchOptions& options, WatchStats& stats);
+
+    // Make Run() return.  Safe from another thread or a signal
+    // handler.
+    void Stop();
+
+private:
+    void CommitBatch(const std::vector<fs::path>& files, WatchStats& stats);
+
+    Repository&       repo_;
+    DirWatcher        watcher_;
+    std::atomic<bool> stop_{ false };
+};
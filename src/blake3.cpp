@@ -0,0 +1,274 @@
+#include "blake3.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+// -------------------------------------------------------
+// Constants
+// -------------------------------------------------------
+
+static constexpr size_t kBlockLen = 64;
+static constexpr size_t kChunkLen = 1024;
+
+// Full batches are 2^13 chunks (8 MB) — a power of two, so each
+// one is a complete subtree of the final hash tree.
+static constexpr size_t kBatchLen = 8192 * kChunkLen;
+
+// Below this a subtree is not worth handing to another thread
+static constexpr size_t kMinParallel = 64 * kChunkLen;
+
+enum : uint32_t {
+    CHUNK_START = 1 << 0,
+    CHUNK_END   = 1 << 1,
+    PARENT      = 1 << 2,
+    ROOT        = 1 << 3,
+};
+
+static const uint32_t kIV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint8_t kMsgPermutation[16] = {
+    2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8,
+};
+
+using Cv = std::array<uint32_t, 8>;
+
+// -------------------------------------------------------
+// Compression function
+// -------------------------------------------------------
+
+static inline uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static inline void G(uint32_t s[16], int a, int b, int c, int d, uint32_t mx, uint32_t my) {
+    s[a] = s[a] + s[b] + mx;  s[d] = Rotr(s[d] ^ s[a], 16);
+    s[c] = s[c] + s[d];       s[b] = Rotr(s[b] ^ s[c], 12);
+    s[a] = s[a] + s[b] + my;  s[d] = Rotr(s[d] ^ s[a], 8);
+    s[c] = s[c] + s[d];       s[b] = Rotr(s[b] ^ s[c], 7);
+}
+
+static void Compress(const uint32_t cv[8], const uint32_t block[16], uint64_t counter,
+                     uint32_t block_len, uint32_t flags, uint32_t out[16]) {
+    uint32_t s[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        kIV[0], kIV[1], kIV[2], kIV[3],
+        static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+        block_len, flags,
+    };
+    uint32_t m[16];
+    std::memcpy(m, block, sizeof(m));
+
+    for (int round = 0; round < 7; ++round) {
+        G(s, 0, 4,  8, 12, m[0],  m[1]);
+        G(s, 1, 5,  9, 13, m[2],  m[3]);
+        G(s, 2, 6, 10, 14, m[4],  m[5]);
+        G(s, 3, 7, 11, 15, m[6],  m[7]);
+        G(s, 0, 5, 10, 15, m[8],  m[9]);
+        G(s, 1, 6, 11, 12, m[10], m[11]);
+        G(s, 2, 7,  8, 13, m[12], m[13]);
+        G(s, 3, 4,  9, 14, m[14], m[15]);
+
+        if (round < 6) {
+            uint32_t p[16];
+            for (int i = 0; i < 16; ++i) p[i] = m[kMsgPermutation[i]];
+            std::memcpy(m, p, sizeof(m));
+        }
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        out[i]     = s[i] ^ s[i + 8];
+        out[i + 8] = s[i + 8] ^ cv[i];
+    }
+}
+
+static void LoadWords(const uint8_t* p, size_t len, uint32_t words[16]) {
+    uint8_t block[kBlockLen] = {};
+    std::memcpy(block, p, len);
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* b = block + 4 * i;
+        words[i] = uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+    }
+}
+
+// -------------------------------------------------------
+// Output — a node whose final compression is still pending,
+// so it can become either a chaining value or the root.
+// -------------------------------------------------------
+
+struct Output {
+    Cv       input_cv{};
+    uint32_t block[16] = {};
+    uint64_t counter   = 0;
+    uint32_t block_len = 0;
+    uint32_t flags     = 0;
+
+    Cv ChainingValue() const {
+        uint32_t out[16];
+        Compress(input_cv.data(), block, counter, block_len, flags, out);
+        Cv cv;
+        std::copy(out, out + 8, cv.begin());
+        return cv;
+    }
+
+    Blake3::Digest RootBytes() const {
+        uint32_t out[16];
+        Compress(input_cv.data(), block, 0, block_len, flags | ROOT, out);
+        Blake3::Digest d;
+        for (int i = 0; i < 8; ++i)
+            for (int b = 0; b < 4; ++b)
+                d[4 * i + b] = static_cast<uint8_t>(out[i] >> (8 * b));
+        return d;
+    }
+};
+
+static Output ParentOutput(const Cv& left, const Cv& right) {
+    Output o;
+    std::copy(kIV, kIV + 8, o.input_cv.begin());
+    std::copy(left.begin(),  left.end(),  o.block);
+    std::copy(right.begin(), right.end(), o.block + 8);
+    o.block_len = kBlockLen;
+    o.flags     = PARENT;
+    return o;
+}
+
+// One chunk (<= 1 KB) at position chunk_counter
+static Output ChunkOutput(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+    Cv       cv;
+    std::copy(kIV, kIV + 8, cv.begin());
+    uint32_t flags = CHUNK_START;
+
+    // Every block but the last is compressed into the running cv
+    while (len > kBlockLen) {
+        uint32_t words[16], out[16];
+        LoadWords(data, kBlockLen, words);
+        Compress(cv.data(), words, chunk_counter, kBlockLen, flags, out);
+        std::copy(out, out + 8, cv.begin());
+        flags = 0;
+        data += kBlockLen;
+        len  -= kBlockLen;
+    }
+
+    Output o;
+    o.input_cv  = cv;
+    LoadWords(data, len, o.block);
+    o.counter   = chunk_counter;
+    o.block_len = static_cast<uint32_t>(len);
+    o.flags     = flags | CHUNK_END;
+    return o;
+}
+
+// -------------------------------------------------------
+// Subtrees
+// -------------------------------------------------------
+// The left subtree of any node holds the largest power-of-two
+// number of chunks that leaves at least one byte for the right.
+
+static size_t LeftLen(size_t len) {
+    size_t full_chunks = (len - 1) / kChunkLen;
+    size_t pow2 = 1;
+    while (pow2 * 2 <= full_chunks) pow2 *= 2;
+    return pow2 * kChunkLen;
+}
+
+static Output SubtreeSerial(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+    if (len <= kChunkLen) return ChunkOutput(data, len, chunk_counter);
+    size_t left = LeftLen(len);
+    Cv l = SubtreeSerial(data, left, chunk_counter).ChainingValue();
+    Cv r = SubtreeSerial(data + left, len - left, chunk_counter + left / kChunkLen).ChainingValue();
+    return ParentOutput(l, r);
+}
+
+// Chaining value of a complete subtree (len = 2^n chunks): cut it
+// into equal power-of-two pieces, hash the pieces in parallel,
+// then fold the pieces' chaining values pairwise.
+static Cv CompleteSubtreeCv(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+    size_t   pieces  = 1;
+    unsigned threads = ThreadPool::Shared().Size();
+    while (pieces < 4 * threads && len / (pieces * 2) >= kMinParallel) pieces *= 2;
+
+    if (pieces == 1) return SubtreeSerial(data, len, chunk_counter).ChainingValue();
+
+    const size_t    piece_len = len / pieces;
+    std::vector<Cv> cvs(pieces);
+    ThreadPool::Shared().ParallelFor(pieces, [&](size_t i) {
+        cvs[i] = SubtreeSerial(data + i * piece_len, piece_len,
+                               chunk_counter + i * (piece_len / kChunkLen)).ChainingValue();
+    });
+
+    for (size_t n = pieces; n > 1; n /= 2)
+        for (size_t i = 0; i < n / 2; ++i)
+            cvs[i] = ParentOutput(cvs[2 * i], cvs[2 * i + 1]).ChainingValue();
+    return cvs[0];
+}
+
+// Any subtree: the left side is always complete (parallel);
+// the right side recurses.
+static Output Subtree(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+    if (len <= kMinParallel) return SubtreeSerial(data, len, chunk_counter);
+    size_t left = LeftLen(len);
+    Cv l = CompleteSubtreeCv(data, left, chunk_counter);
+    Cv r = Subtree(data + left, len - left, chunk_counter + left / kChunkLen).ChainingValue();
+    return ParentOutput(l, r);
+}
+
+// -------------------------------------------------------
+// Streaming interface
+// -------------------------------------------------------
+
+Blake3::Blake3() {
+    batch_.reserve(kBatchLen);
+}
+
+// Fold a full batch into the tree.  Batches are equal complete
+// subtrees, so merging works like the per-chunk stack of the
+// reference implementation, one level up.
+void Blake3::PushBatch() {
+    Cv cv = CompleteSubtreeCv(batch_.data(), batch_.size(),
+                              batches_ * (kBatchLen / kChunkLen));
+    batch_.clear();
+
+    uint64_t total = ++batches_;
+    while ((total & 1) == 0) {
+        cv = ParentOutput(stack_.back(), cv).ChainingValue();
+        stack_.pop_back();
+        total >>= 1;
+    }
+    stack_.push_back(cv);
+}
+
+void Blake3::Update(const void* data, size_t len) {
+    auto* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        // A full batch is only folded once more input arrives —
+        // the last batch may turn out to be the root.
+        if (batch_.size() == kBatchLen) PushBatch();
+
+        size_t take = std::min(len, kBatchLen - batch_.size());
+        batch_.insert(batch_.end(), p, p + take);
+        p   += take;
+        len -= take;
+    }
+}
+
+Blake3::Digest Blake3::Final() {
+    Output out = Subtree(batch_.data(), batch_.size(),
+                         batches_ * (kBatchLen / kChunkLen));
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it)
+        out = ParentOutput(*it, out.ChainingValue());
+    return out.RootBytes();
+}
+
+std::string Blake3::HexDigest() {
+    Digest d = Final();
+    return Utils::ToHex(d.data(), d.size());
+}
+
+std::string Blake3::Of(const void* data, size_t len) {
+    auto* p = static_cast<const uint8_t*>(data);
+    Output out = Subtree(p, len, 0);
+    Digest d = out.RootBytes();
+    return Utils::ToHex(d.data(), d.size());
+}
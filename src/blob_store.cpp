@@ -0,0 +1,1161 @@
+#include "blob_store.h"
+#include "repository.h"
+#include "chunker.h"
+#include "compression.h"
+#include "file_copy.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// -------------------------------------------------------
+// Manifest format (plain text, one chunk per line):
+//
+//   swvcs-manifest 1
+//   size <total bytes>
+//   <chunk-hash> <chunk bytes>
+//   ...
+// -------------------------------------------------------
+
+namespace {
+
+struct ManifestEntry {
+    std::string hash;
+    uint32_t    size = 0;
+};
+
+struct Manifest {
+    int64_t                    size = 0;
+    std::vector<ManifestEntry> chunks;
+};
+
+bool ParseManifest(const std::vector<char>& bytes, Manifest& out) {
+    std::istringstream f(std::string(bytes.begin(), bytes.end()));
+
+    std::string magic;
+    int         format = 0;
+    std::string size_key;
+    f >> magic >> format >> size_key >> out.size;
+    if (!f || magic != "swvcs-manifest" || format != 1 || size_key != "size")
+        return false;
+
+    ManifestEntry e;
+    while (f >> e.hash >> e.size)
+        out.chunks.push_back(e);
+
+    // Sanity check: chunk sizes must add up to the recorded total
+    int64_t total = 0;
+    for (const auto& c : out.chunks) total += c.size;
+    return total == out.size;
+}
+
+std::string FormatManifest(const Manifest& m) {
+    std::ostringstream f;
+    f << "swvcs-manifest 1\n"
+      << "size " << m.size << "\n";
+    for (const auto& c : m.chunks)
+        f << c.hash << " " << c.size << "\n";
+    return f.str();
+}
+
+// -------------------------------------------------------
+// Tree format (plain text, one file per line, sorted by path;
+// the path is the rest of the line, spaces and all):
+//
+//   swvcs-tree 1
+//   <snapshot-hash> <size> <mtime-ns> <relative/path>
+//   ...
+// -------------------------------------------------------
+
+bool ParseTree(const std::vector<char>& bytes, Tree& out) {
+    std::istringstream f(std::string(bytes.begin(), bytes.end()));
+
+    std::string line;
+    if (!std::getline(f, line) || line != "swvcs-tree 1") return false;
+    while (std::getline(f, line)) {
+        std::istringstream fields(line);
+        TreeEntry e;
+        if (!(fields >> e.hash >> e.size >> e.mtime_ns) || fields.get() != ' ') return false;
+        std::getline(fields, e.path);
+        if (e.path.empty()) return false;
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+std::string FormatTree(const Tree& tree) {
+    std::ostringstream f;
+    f << "swvcs-tree 1\n";
+    for (const auto& e : tree)
+        f << e.hash << " " << e.size << " " << e.mtime_ns << " " << e.path << "\n";
+    return f.str();
+}
+
+// -------------------------------------------------------
+// Delta format (delta mode, see Store):
+//
+//   swvcs-delta 1
+//   base <snapshot hash>
+//   depth <deltas from here back to a full snapshot>
+//   size <total bytes>
+//   <zstd frame: the snapshot, patched from base>
+// -------------------------------------------------------
+
+struct DeltaHeader {
+    std::string base;
+    int         depth = 0;
+    int64_t     size  = 0;
+};
+
+bool ParseDelta(const std::vector<char>& bytes, DeltaHeader& out, std::vector<char>* payload) {
+    // Header is the first four lines
+    size_t end = 0;
+    for (int line = 0; line < 4; ++line) {
+        auto nl = std::find(bytes.begin() + end, bytes.end(), '\n');
+        if (nl == bytes.end()) return false;
+        end = static_cast<size_t>(nl - bytes.begin()) + 1;
+    }
+    std::istringstream f(std::string(bytes.begin(), bytes.begin() + end));
+
+    std::string magic, base_key, depth_key, size_key;
+    int         format = 0;
+    f >> magic >> format >> base_key >> out.base >> depth_key >> out.depth
+      >> size_key >> out.size;
+    if (!f || magic != "swvcs-delta" || format != 1 || base_key != "base"
+        || depth_key != "depth" || size_key != "size")
+        return false;
+
+    if (payload) payload->assign(bytes.begin() + end, bytes.end());
+    return true;
+}
+
+std::string FormatDeltaHeader(const DeltaHeader& h) {
+    std::ostringstream f;
+    f << "swvcs-delta 1\n"
+      << "base "  << h.base  << "\n"
+      << "depth " << h.depth << "\n"
+      << "size "  << h.size  << "\n";
+    return f.str();
+}
+
+// Unique sibling of dst for writing before the final rename.
+// Concurrent writers (CLI + GUI) never share a temp file.
+fs::path TempPathFor(const fs::path& dst) {
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".tmp%016llx",
+                  static_cast<unsigned long long>(rng()));
+    fs::path tmp = dst;
+    tmp += suffix;
+    return tmp;
+}
+
+// Write an object under its final content-addressed name:
+// temp file first, then rename into place, so readers never see
+// a half-written object.  If the object already exists (another
+// commit got there first) the temp file is dropped instead.
+Result PutObject(const fs::path& dst, const void* data, size_t len, bool& written) {
+    written = false;
+    if (fs::exists(dst)) return Result::success();
+
+    std::error_code ec;
+    fs::create_directories(dst.parent_path(), ec);
+
+    fs::path tmp = TempPathFor(dst);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(len));
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return Result::failure("Failed to write " + dst.string());
+        }
+    }
+
+    if (fs::exists(dst)) {
+        fs::remove(tmp, ec);
+        return Result::success();
+    }
+    fs::rename(tmp, dst, ec);
+    if (ec) {
+        std::string msg = ec.message();
+        fs::remove(tmp, ec);
+        if (fs::exists(dst)) return Result::success();   // lost a race — same bytes
+        return Result::failure("Failed to store " + dst.string() + ": " + msg);
+    }
+    written = true;
+    return Result::success();
+}
+
+// Move a finished temp file to its content-addressed name, or
+// drop it if the object is already there (same bytes).
+Result CommitTemp(const fs::path& tmp, const fs::path& dst, bool& written) {
+    written = false;
+    std::error_code ec;
+    if (!fs::exists(dst)) fs::rename(tmp, dst, ec);
+    else                  ec = std::make_error_code(std::errc::file_exists);
+    if (!ec) {
+        written = true;
+        return Result::success();
+    }
+    std::string msg = ec.message();
+    fs::remove(tmp, ec);
+    if (fs::exists(dst)) return Result::success();
+    return Result::failure("Failed to store " + dst.string() + ": " + msg);
+}
+
+// Give an existing object a second name without rewriting it:
+// objects are never modified in place, so a reflink or a hard
+// link (no extra space) is as good as a copy.
+Result LinkObject(const fs::path& existing, const fs::path& dst) {
+    if (fs::exists(dst)) return Result::success();
+
+    std::error_code ec;
+    fs::create_directories(dst.parent_path(), ec);
+
+    fs::path         tmp = TempPathFor(dst);
+    FileCopy::Method used;
+    Result r = FileCopy::Copy(existing, tmp, /*allow_hardlink=*/true, used);
+    if (!r.ok) return r;
+    bool written = false;
+    return CommitTemp(tmp, dst, written);
+}
+
+bool IsTempName(const fs::path& p) {
+    return p.filename().string().find(".tmp") != std::string::npos;
+}
+
+} // namespace
+
+BlobStore::BlobStore(Repository& repo)
+    : repo_(repo)
+    , algo_(repo.GetHashAlgo())
+    , compression_(repo.GetCompressionOptions())
+    , delta_chain_(repo.GetDeltaChain())
+    , delta_max_(repo.GetDeltaMaxBytes())
+    , full_copies_(repo.GetFullCopies())
+    , packs_(repo.PacksDir()) {}
+
+// -------------------------------------------------------
+// Object access — loose file first, then the packs
+// -------------------------------------------------------
+
+fs::path BlobStore::LoosePath(ObjectKind kind, const std::string& hash) const {
+    switch (kind) {
+        case ObjectKind::Chunk:     return repo_.ChunkPath(hash);
+        case ObjectKind::Manifest:  return repo_.ManifestPath(hash);
+        case ObjectKind::Delta:     return repo_.DeltaPath(hash);
+        case ObjectKind::Blob:      return repo_.BlobPath(hash);
+        case ObjectKind::Thumbnail: return repo_.ThumbnailPath(hash);
+        case ObjectKind::Tree:      return repo_.TreePath(hash);
+    }
+    return {};
+}
+
+bool BlobStore::HasObject(ObjectKind kind, const std::string& hash) const {
+    return fs::exists(LoosePath(kind, hash)) || packs_.Has(kind, hash);
+}
+
+bool BlobStore::ReadObject(ObjectKind kind, const std::string& hash, std::vector<char>& out) const {
+    std::ifstream f(LoosePath(kind, hash), std::ios::binary | std::ios::ate);
+    if (!f) return packs_.Read(kind, hash, out);
+
+    auto size = static_cast<std::streamsize>(f.tellg());
+    f.seekg(0);
+    out.resize(static_cast<size_t>(size));
+    f.read(out.data(), size);
+    return f.gcount() == size;
+}
+
+bool BlobStore::StreamObject(ObjectKind kind, const std::string& hash,
+                             const PackSet::Sink& sink) const {
+    std::ifstream f(LoosePath(kind, hash), std::ios::binary);
+    if (!f) return packs_.Stream(kind, hash, sink);
+
+    std::vector<char> buf(1 << 20);
+    while (f) {
+        f.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if (f.gcount() > 0) sink(buf.data(), static_cast<size_t>(f.gcount()));
+    }
+    return !f.bad();
+}
+
+// Loose objects of one kind, as (hash, path)
+std::vector<std::pair<std::string, fs::path>> BlobStore::ListLoose(ObjectKind kind) const {
+    std::vector<std::pair<std::string, fs::path>> out;
+    std::error_code ec;
+
+    auto add = [&](const fs::directory_entry& e, const char* ext) {
+        const fs::path& p = e.path();
+        if (!e.is_regular_file() || IsTempName(p)) return;
+        if (ext && p.extension() != ext) return;
+        out.emplace_back(ext ? p.stem().string() : p.filename().string(), p);
+    };
+
+    if (kind == ObjectKind::Chunk) {
+        for (const auto& e : fs::recursive_directory_iterator(repo_.ChunksDir(), ec))
+            add(e, nullptr);
+        return out;
+    }
+
+    fs::path dir = kind == ObjectKind::Thumbnail ? repo_.ThumbsDir() : repo_.BlobsDir();
+    const char* ext = kind == ObjectKind::Manifest  ? ".manifest"
+                    : kind == ObjectKind::Delta     ? ".delta"
+                    : kind == ObjectKind::Blob      ? ".bin"
+                    : kind == ObjectKind::Tree      ? ".tree"
+                    :                                 ".bmp";
+    for (const auto& e : fs::directory_iterator(dir, ec))
+        add(e, ext);
+    return out;
+}
+
+// Every object of one kind, loose or packed
+std::vector<std::string> BlobStore::ListObjects(ObjectKind kind) const {
+    std::vector<std::string> out = packs_.List(kind);
+    for (auto& [hash, path] : ListLoose(kind))
+        out.push_back(hash);
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+// Make object 'from' also available as 'to' (a loose file):
+// hard link a loose original, copy a packed one out.
+Result BlobStore::RelinkObject(ObjectKind kind, const std::string& from, const std::string& to) const {
+    fs::path src = LoosePath(kind, from);
+    if (fs::exists(src)) return LinkObject(src, LoosePath(kind, to));
+
+    std::vector<char> bytes;
+    if (!packs_.Read(kind, from, bytes))
+        return Result::failure("Object " + from.substr(0, 8) + " missing");
+    bool written = false;
+    return PutObject(LoosePath(kind, to), bytes.data(), bytes.size(), written);
+}
+
+bool BlobStore::ReadThumbnail(const std::string& hash, std::vector<char>& out) const {
+    return ReadObject(ObjectKind::Thumbnail, hash, out);
+}
+
+// -------------------------------------------------------
+// Trees
+// -------------------------------------------------------
+
+Result BlobStore::StoreTree(const Tree& tree, std::string& hash, int64_t& written_bytes) {
+    std::string text = FormatTree(tree);
+    hash          = ContentHasher::Of(algo_, text.data(), text.size());
+    written_bytes = 0;
+    if (packs_.Has(ObjectKind::Tree, hash)) return Result::success();
+
+    bool   written = false;
+    Result r       = PutObject(repo_.TreePath(hash), text.data(), text.size(), written);
+    if (r.ok && written) written_bytes = static_cast<int64_t>(text.size());
+    return r;
+}
+
+Result BlobStore::LoadTree(const std::string& hash, Tree& out) const {
+    out.clear();
+    std::vector<char> bytes;
+    if (!ReadObject(ObjectKind::Tree, hash, bytes))
+        return Result::failure("Tree " + hash.substr(0, 8) + " missing");
+    if (!ParseTree(bytes, out))
+        return Result::failure("Corrupt tree " + hash.substr(0, 8));
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Has / SnapshotSize
+// -------------------------------------------------------
+
+bool BlobStore::Has(const std::string& hash) const {
+    return HasObject(ObjectKind::Manifest, hash) || HasObject(ObjectKind::Delta, hash)
+        || HasObject(ObjectKind::Blob, hash);
+}
+
+int64_t BlobStore::SnapshotSize(const std::string& hash) const {
+    std::vector<char> bytes;
+    Manifest m;
+    if (ReadObject(ObjectKind::Manifest, hash, bytes) && ParseManifest(bytes, m))
+        return m.size;
+
+    DeltaHeader d;
+    if (ReadObject(ObjectKind::Delta, hash, bytes) && ParseDelta(bytes, d, nullptr))
+        return d.size;
+
+    std::error_code ec;
+    auto size = fs::file_size(repo_.BlobPath(hash), ec);
+    return ec ? packs_.Size(ObjectKind::Blob, hash) : static_cast<int64_t>(size);
+}
+
+// -------------------------------------------------------
+// Store
+// -------------------------------------------------------
+
+Result BlobStore::Store(const fs::path& src, std::string& hash, StoreStats& stats,
+                        const std::string& base_hash) {
+    stats = {};
+    hash.clear();
+
+    std::ifstream in(src, std::ios::binary);
+    if (!in) return Result::failure("Cannot open for reading: " + src.string());
+
+    if (delta_chain_ > 0 && !base_hash.empty() && Has(base_hash)) {
+        in.close();
+        return StoreDelta(src, base_hash, hash, stats);
+    }
+    if (full_copies_) {
+        in.close();
+        return StoreFull(src, hash, stats);
+    }
+
+    Result r = StoreChunked([&](char* buf, size_t cap) {
+        in.read(buf, static_cast<std::streamsize>(cap));
+        return static_cast<size_t>(in.gcount());
+    }, hash, stats);
+    if (r.ok && in.bad()) return Result::failure("Read error: " + src.string());
+    return r;
+}
+
+// -------------------------------------------------------
+// StoreChunked  (single pass: hash + chunk + write)
+// -------------------------------------------------------
+// Each buffer read feeds the whole-file hasher and the chunker
+// at the same time, so the document is read exactly once
+// however large it is.
+
+Result BlobStore::StoreChunked(const ReadFn& read, std::string& hash, StoreStats& stats) {
+    ContentHasher        file_hasher(algo_);
+    Manifest             manifest;
+    Chunker              chunker;
+    std::vector<uint8_t> chunk;
+    chunk.reserve(Chunker::kMaxSize);
+
+    // Finished chunks are hashed in batches so several of them are
+    // hashed at once (multi-buffer SHA-256, or BLAKE3 across cores)
+    constexpr size_t kBatch = 8;
+    std::vector<std::vector<uint8_t>> batch(kBatch);
+    size_t batched = 0;
+
+    // Hash the batched chunks, compress the ones that aren't stored
+    // yet (in parallel — zstd is the slowest step), then write them
+    std::vector<char> encoded[kBatch];
+    auto flush_batch = [&]() -> Result {
+        const uint8_t* ptrs[kBatch];
+        size_t         lens[kBatch];
+        std::string    hashes[kBatch];
+        bool           fresh[kBatch];
+        bool           encode_ok[kBatch];
+        for (size_t i = 0; i < batched; ++i) {
+            ptrs[i] = batch[i].data();
+            lens[i] = batch[i].size();
+        }
+        ContentHasher::HashMany(algo_, ptrs, lens, batched, hashes);
+
+        ThreadPool::Shared().ParallelFor(batched, [&](size_t i) {
+            fresh[i]     = !HasObject(ObjectKind::Chunk, hashes[i]);
+            encode_ok[i] = !fresh[i] ||
+                Compression::Encode(ptrs[i], lens[i], compression_, encoded[i]);
+        });
+
+        for (size_t i = 0; i < batched; ++i) {
+            const std::string& chunk_hash = hashes[i];
+
+            if (fresh[i]) {
+                if (!encode_ok[i])
+                    return Result::failure("Failed to compress chunk " + chunk_hash.substr(0, 8));
+
+                bool   written = false;
+                Result r = PutObject(repo_.ChunkPath(chunk_hash),
+                                     encoded[i].data(), encoded[i].size(), written);
+                if (!r.ok) return r;
+                if (written) {
+                    stats.written_bytes += static_cast<int64_t>(encoded[i].size());
+                    ++stats.new_chunks;
+                }
+            }
+
+            manifest.chunks.push_back({chunk_hash, static_cast<uint32_t>(lens[i])});
+            manifest.size += static_cast<int64_t>(lens[i]);
+        }
+        batched = 0;
+        return Result::success();
+    };
+
+    auto end_chunk = [&]() -> Result {
+        batch[batched].swap(chunk);
+        chunk.clear();
+        if (++batched < kBatch) return Result::success();
+        return flush_batch();
+    };
+
+    const size_t BUF = 1 << 20;
+    std::vector<char> buf(BUF);
+    while (size_t n = read(buf.data(), BUF)) {
+        auto* p = reinterpret_cast<const uint8_t*>(buf.data());
+
+        file_hasher.Update(p, n);
+
+        size_t off = 0;
+        while (off < n) {
+            bool   cut  = false;
+            size_t used = chunker.Scan(p + off, n - off, cut);
+            chunk.insert(chunk.end(), p + off, p + off + used);
+            off += used;
+            if (cut) {
+                Result r = end_chunk();
+                if (!r.ok) return r;
+            }
+        }
+    }
+    if (!chunk.empty()) {
+        Result r = end_chunk();
+        if (!r.ok) return r;
+    }
+    if (batched > 0) {
+        Result r = flush_batch();
+        if (!r.ok) return r;
+    }
+
+    hash = file_hasher.HexDigest();
+    if (hash.empty()) return Result::failure("Failed to hash snapshot");
+
+    stats.logical_bytes = manifest.size;
+    stats.chunks        = manifest.chunks.size();
+
+    if (packs_.Has(ObjectKind::Manifest, hash)) {
+        stats.already_stored = true;
+        return Result::success();
+    }
+    std::string text    = FormatManifest(manifest);
+    bool        written = false;
+    Result r = PutObject(repo_.ManifestPath(hash), text.data(), text.size(), written);
+    if (!r.ok) return r;
+    stats.already_stored = !written;
+    if (written) stats.written_bytes += static_cast<int64_t>(text.size());
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// StoreFull  (full-copy mode)
+// -------------------------------------------------------
+// Copies src into blobs/ whole and uncompressed, so the copy can
+// be a reflink: on a CoW filesystem committing a 500 MB assembly
+// writes no data at all.  The hash is taken from the copy rather
+// than from src, so a file saved again mid-commit can't end up
+// stored under the wrong name.
+
+Result BlobStore::StoreFull(const fs::path& src, std::string& hash, StoreStats& stats) {
+    std::error_code ec;
+    fs::create_directories(repo_.BlobsDir(), ec);
+
+    fs::path         tmp = TempPathFor(repo_.BlobsDir() / "incoming");
+    FileCopy::Method used;
+    Result r = FileCopy::Copy(src, tmp, /*allow_hardlink=*/false, used);
+    if (!r.ok) return r;
+
+    ContentHasher hasher(algo_);
+    {
+        std::ifstream     in(tmp, std::ios::binary);
+        std::vector<char> buf(1 << 20);
+        while (in) {
+            in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            if (in.gcount() <= 0) continue;
+            hasher.Update(buf.data(), static_cast<size_t>(in.gcount()));
+            stats.logical_bytes += in.gcount();
+        }
+        if (in.bad()) {
+            in.close();
+            fs::remove(tmp, ec);
+            return Result::failure("Read error: " + tmp.string());
+        }
+    }
+    hash = hasher.HexDigest();
+    if (hash.empty()) {
+        fs::remove(tmp, ec);
+        return Result::failure("Failed to hash snapshot");
+    }
+
+    if (Has(hash)) {
+        fs::remove(tmp, ec);
+        stats.already_stored = true;
+        return Result::success();
+    }
+
+    bool written = false;
+    r = CommitTemp(tmp, repo_.BlobPath(hash), written);
+    if (!r.ok) return r;
+    stats.already_stored = !written;
+    if (written) {
+        // A reflinked copy shares its extents with the working file,
+        // so this is what the blob would cost once the two diverge
+        stats.written_bytes = stats.logical_bytes;
+        stats.copy_method   = FileCopy::MethodName(used);
+    }
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// StoreDelta  (delta mode)
+// -------------------------------------------------------
+// Stores the snapshot as a zstd patch against base_hash (the
+// parent commit's snapshot).  Every delta_chain deltas a full
+// chunked snapshot (keyframe) is written instead, so restoring
+// never replays more than delta_chain patches.  A delta that
+// saves less than half the file isn't worth the slower restore
+// and is also stored as a keyframe, as is any file above
+// delta_max_mb.
+//
+// Nothing is read into memory: the file is mapped and hashed in
+// place, and the base is written out to a temp file and mapped
+// too, so zstd reads both where they are and the patch goes
+// straight to its temp file.
+
+Result BlobStore::StoreDelta(const fs::path& src, const std::string& base_hash,
+                             std::string& hash, StoreStats& stats) {
+    std::error_code ec;
+    auto size = fs::file_size(src, ec);
+    if (ec) return Result::failure("Cannot open for reading: " + src.string());
+    MappedFile target;
+    if (size > 0 && !target.Open(src)) return Result::failure("Cannot read " + src.string());
+
+    hash = ContentHasher::Of(algo_, target.Data(), target.Size());
+    stats.logical_bytes = static_cast<int64_t>(target.Size());
+    if (Has(hash)) {
+        stats.already_stored = true;
+        return Result::success();
+    }
+
+    int depth = DeltaDepth(base_hash);
+    if (size > 0 && depth >= 0 && depth < delta_chain_
+        && (delta_max_ == 0 || stats.logical_bytes <= delta_max_)) {
+        fs::create_directories(repo_.BlobsDir(), ec);
+        fs::path base_file = TempPathFor(repo_.BlobsDir() / "base");
+        Result r = ExtractSnapshot(base_hash, base_file);
+        if (!r.ok) {
+            fs::remove(base_file, ec);
+            return r;
+        }
+
+        DeltaHeader header{base_hash, depth + 1, stats.logical_bytes};
+        fs::path    dst   = repo_.DeltaPath(hash);
+        fs::path    tmp   = TempPathFor(dst);
+        bool        small = false;
+        {
+            MappedFile    base;
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out << FormatDeltaHeader(header);
+            bool mapped = base.Open(base_file) || fs::file_size(base_file, ec) == 0;
+            small = mapped && out
+                 && Compression::EncodeDelta(base.Data(), base.Size(), target.Data(), target.Size(),
+                                             compression_, target.Size() / 2,
+                                             [&](const char* data, size_t len) {
+                                                 out.write(data, static_cast<std::streamsize>(len));
+                                                 return static_cast<bool>(out);
+                                             });
+        }
+        fs::remove(base_file, ec);
+
+        if (small) {
+            int64_t object_size = static_cast<int64_t>(fs::file_size(tmp, ec));
+            bool    written     = false;
+            r = CommitTemp(tmp, dst, written);
+            if (!r.ok) return r;
+            stats.already_stored = !written;
+            stats.written_bytes  = written ? object_size : 0;
+            stats.delta_depth    = header.depth;
+            return Result::success();
+        }
+        fs::remove(tmp, ec);
+    }
+
+    // Keyframe
+    if (full_copies_) {
+        bool written = false;
+        Result r = PutObject(repo_.BlobPath(hash), target.Data(), target.Size(), written);
+        if (!r.ok) return r;
+        stats.already_stored = !written;
+        stats.written_bytes  = written ? stats.logical_bytes : 0;
+        if (written) stats.copy_method = FileCopy::MethodName(FileCopy::Method::Buffered);
+        return Result::success();
+    }
+
+    size_t pos = 0;
+    std::string keyframe_hash;
+    Result r = StoreChunked([&](char* buf, size_t cap) {
+        size_t n = std::min(cap, target.Size() - pos);
+        std::copy_n(target.Data() + pos, n, buf);
+        pos += n;
+        return n;
+    }, keyframe_hash, stats);
+    hash = keyframe_hash;
+    return r;
+}
+
+// Deltas between hash and the nearest full snapshot (0 for a
+// full snapshot), or -1 if hash isn't stored.
+int BlobStore::DeltaDepth(const std::string& hash) const {
+    std::vector<char> bytes;
+    DeltaHeader       d;
+    if (ReadObject(ObjectKind::Delta, hash, bytes) && ParseDelta(bytes, d, nullptr))
+        return d.depth;
+    return Has(hash) ? 0 : -1;
+}
+
+// -------------------------------------------------------
+// ExtractSnapshot  (snapshot into a file — delta bases, restore)
+// -------------------------------------------------------
+// A delta chain is replayed forwards from its keyframe through
+// temp files next to dst: each step maps the snapshot before it
+// as the base, so only the one being decoded is in memory.
+
+Result BlobStore::ExtractSnapshot(const std::string& hash, const fs::path& dst) const {
+    // Walk back to the keyframe, remembering the deltas on the way
+    std::vector<std::string> chain;
+    std::string              at = hash;
+    std::vector<char>        bytes;
+    DeltaHeader              d;
+    int                      expected = -1;
+    while (ReadObject(ObjectKind::Delta, at, bytes) && ParseDelta(bytes, d, nullptr)) {
+        // Depth drops by one per step, so a damaged header can't loop
+        if (d.depth <= 0 || (expected >= 0 && d.depth != expected))
+            return Result::failure("Corrupt delta chain at " + at.substr(0, 8));
+        chain.push_back(at);
+        expected = d.depth - 1;
+        at       = d.base;
+    }
+
+    std::error_code ec;
+    fs::path        file = chain.empty() ? dst : TempPathFor(dst);
+    {
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        if (!out) return Result::failure("Cannot write: " + file.string());
+
+        Manifest m;
+        if (ReadObject(ObjectKind::Manifest, at, bytes) && ParseManifest(bytes, m)) {
+            std::vector<char> buf;
+            buf.reserve(Chunker::kMaxSize);
+            for (const auto& c : m.chunks) {
+                if (!ReadObject(ObjectKind::Chunk, c.hash, bytes)
+                    || !Compression::Decode(bytes.data(), bytes.size(), buf) || buf.size() != c.size) {
+                    out.close();
+                    fs::remove(file, ec);
+                    return Result::failure("Chunk " + c.hash.substr(0, 8) + " is damaged");
+                }
+                out.write(buf.data(), c.size);
+            }
+        } else if (!StreamObject(ObjectKind::Blob, at, [&](const char* data, size_t len) {
+                       out.write(data, static_cast<std::streamsize>(len));
+                   })) {
+            out.close();
+            fs::remove(file, ec);
+            return Result::failure("Blob missing for snapshot " + at.substr(0, 8)
+                                   + " — was the repo moved?");
+        }
+        if (!out) {
+            out.close();
+            fs::remove(file, ec);
+            return Result::failure("Failed to write " + file.string());
+        }
+    }
+
+    std::vector<char> patch;
+    std::vector<char> next;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        fs::path next_file = std::next(it) == chain.rend() ? dst : TempPathFor(dst);
+        bool     ok;
+        {
+            MappedFile base;   // an empty snapshot can't be mapped — and needn't be
+            ok = (base.Open(file) || fs::file_size(file, ec) == 0)
+              && ReadObject(ObjectKind::Delta, *it, bytes) && ParseDelta(bytes, d, &patch)
+              && Compression::DecodeDelta(base.Data(), base.Size(), patch.data(), patch.size(), next)
+              && static_cast<int64_t>(next.size()) == d.size;
+        }
+        fs::remove(file, ec);
+        if (!ok) return Result::failure("Delta " + it->substr(0, 8) + " is damaged");
+
+        std::ofstream out(next_file, std::ios::binary | std::ios::trunc);
+        out.write(next.data(), static_cast<std::streamsize>(next.size()));
+        if (!out) {
+            out.close();
+            fs::remove(next_file, ec);
+            return Result::failure("Failed to write " + next_file.string());
+        }
+        file = next_file;
+    }
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Restore
+// -------------------------------------------------------
+
+Result BlobStore::Restore(const std::string& hash, const fs::path& dst, std::string* method) {
+    std::error_code   ec;
+    std::vector<char> bytes;
+    Manifest          manifest;
+    bool chunked = ReadObject(ObjectKind::Manifest, hash, bytes) && ParseManifest(bytes, manifest);
+
+    if (chunked) {
+        // Check every chunk is present before touching the working file
+        for (const auto& c : manifest.chunks) {
+            if (!HasObject(ObjectKind::Chunk, c.hash))
+                return Result::failure("Chunk " + c.hash.substr(0, 8) + " missing for commit "
+                                       + hash.substr(0, 8) + " — repository is damaged");
+        }
+    } else if (!Has(hash)) {
+        return Result::failure("Blob missing for commit " + hash.substr(0, 8)
+                               + " — was the repo moved?");
+    }
+
+    // Reassemble into a temp file next to dst, then swap it in
+    fs::path tmp = TempPathFor(dst);
+
+    // A loose full copy goes through FileCopy, so a reflink
+    // restores even a huge file instantly
+    fs::path blob = repo_.BlobPath(hash);
+    if (!chunked && fs::exists(blob) && !HasObject(ObjectKind::Delta, hash)) {
+        FileCopy::Method used;
+        Result r = FileCopy::Copy(blob, tmp, /*allow_hardlink=*/false, used);
+        if (!r.ok) return r;
+        if (method) *method = FileCopy::MethodName(used);
+    } else {
+        // Chunks, a delta chain or a packed full copy
+        Result r = ExtractSnapshot(hash, tmp);
+        if (!r.ok) return r;
+        if (method) *method = chunked                                ? "chunks"
+                            : HasObject(ObjectKind::Delta, hash) ? "delta chain"
+                                                                 : "pack";
+    }
+
+    fs::rename(tmp, dst, ec);
+    if (ec) {
+        std::string msg = ec.message();
+        fs::remove(tmp, ec);
+        return Result::failure("Failed to restore file: " + msg);
+    }
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Rehash / DropOld  (hash algorithm migration)
+// -------------------------------------------------------
+
+Result BlobStore::Rehash(HashAlgo to, RehashPlan& plan) {
+    plan = {};
+
+    // 1. Chunks — independent of each other, so rehash them in parallel
+    std::vector<std::string> chunks = ListObjects(ObjectKind::Chunk);
+    std::vector<std::string> chunk_names(chunks.size());
+    std::vector<std::string> errors(chunks.size());
+    ThreadPool::Shared().ParallelFor(chunks.size(), [&](size_t i) {
+        std::vector<char> stored;
+        std::vector<char> bytes;
+        if (!ReadObject(ObjectKind::Chunk, chunks[i], stored)
+            || !Compression::Decode(stored.data(), stored.size(), bytes)) {
+            errors[i] = "Cannot read chunk " + chunks[i];
+            return;
+        }
+        chunk_names[i] = ContentHasher::Of(to, bytes.data(), bytes.size());
+        Result r = RelinkObject(ObjectKind::Chunk, chunks[i], chunk_names[i]);
+        if (!r.ok) errors[i] = r.err;
+    });
+    for (const auto& e : errors)
+        if (!e.empty()) return Result::failure(e);
+
+    std::unordered_map<std::string, std::string> chunk_map;
+    for (size_t i = 0; i < chunks.size(); ++i)
+        chunk_map[chunks[i]] = chunk_names[i];
+    plan.chunks = chunks.size();
+
+    // 2. Snapshots — manifests are rehashed by streaming their chunks
+    //    in order, deltas by replaying their chain, legacy full
+    //    copies by reading the file
+    std::vector<std::pair<ObjectKind, std::string>> snapshots;
+    for (ObjectKind kind : {ObjectKind::Manifest, ObjectKind::Delta, ObjectKind::Blob})
+        for (auto& hash : ListObjects(kind))
+            snapshots.emplace_back(kind, hash);
+
+    {
+        std::error_code ec;
+        fs::create_directories(repo_.BlobsDir(), ec);   // deltas are replayed through temp files here
+    }
+
+    std::vector<std::string> new_hashes(snapshots.size());
+    errors.assign(snapshots.size(), "");
+    ThreadPool::Shared().ParallelFor(snapshots.size(), [&](size_t i) {
+        const auto& [kind, old_hash] = snapshots[i];
+
+        if (kind == ObjectKind::Blob) {
+            ContentHasher hasher(to);
+            if (!StreamObject(kind, old_hash, [&](const char* data, size_t len) {
+                    hasher.Update(data, len);
+                })) {
+                errors[i] = "Cannot read blob " + old_hash;
+                return;
+            }
+            new_hashes[i] = hasher.HexDigest();
+            Result r = RelinkObject(kind, old_hash, new_hashes[i]);
+            if (!r.ok) errors[i] = r.err;
+            return;
+        }
+
+        // Deltas are rewritten below, once every base has its new name
+        if (kind == ObjectKind::Delta) {
+            std::error_code ec;
+            fs::path        tmp = TempPathFor(repo_.BlobsDir() / old_hash);
+            Result          r   = ExtractSnapshot(old_hash, tmp);
+            MappedFile      data;
+            if (r.ok && (data.Open(tmp) || fs::file_size(tmp, ec) == 0))
+                new_hashes[i] = ContentHasher::Of(to, data.Data(), data.Size());
+            else if (r.ok)
+                r = Result::failure("Cannot read " + tmp.string());
+            data.Close();
+            fs::remove(tmp, ec);
+            if (!r.ok) errors[i] = r.err;
+            return;
+        }
+
+        std::vector<char> bytes;
+        Manifest          m;
+        if (!ReadObject(kind, old_hash, bytes) || !ParseManifest(bytes, m)) {
+            errors[i] = "Corrupt manifest " + old_hash;
+            return;
+        }
+
+        ContentHasher     hasher(to);
+        std::vector<char> buf;
+        for (auto& c : m.chunks) {
+            bool read    = ReadObject(ObjectKind::Chunk, c.hash, bytes)
+                        && Compression::Decode(bytes.data(), bytes.size(), buf);
+            auto renamed = chunk_map.find(c.hash);
+            if (!read || buf.size() != c.size || renamed == chunk_map.end()) {
+                errors[i] = "Chunk " + c.hash.substr(0, 8) + " missing for " + old_hash.substr(0, 8);
+                return;
+            }
+            hasher.Update(buf.data(), buf.size());
+            c.hash = renamed->second;
+        }
+        new_hashes[i] = hasher.HexDigest();
+
+        std::string text    = FormatManifest(m);
+        bool        written = false;
+        Result r = PutObject(repo_.ManifestPath(new_hashes[i]), text.data(), text.size(), written);
+        if (!r.ok) errors[i] = r.err;
+    });
+    for (const auto& e : errors)
+        if (!e.empty()) return Result::failure(e);
+
+    std::unordered_map<std::string, std::string> snapshot_map;
+    std::unordered_map<std::string, std::string> tree_map;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        snapshot_map[snapshots[i].second] = new_hashes[i];
+        plan.snapshots.emplace_back(snapshots[i].second, new_hashes[i]);
+    }
+
+    // A delta's patch bytes don't depend on names — only its header
+    // changes, to point at the base's new name
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        if (snapshots[i].first != ObjectKind::Delta) continue;
+
+        std::vector<char> bytes;
+        std::vector<char> patch;
+        DeltaHeader       d;
+        if (!ReadObject(ObjectKind::Delta, snapshots[i].second, bytes) || !ParseDelta(bytes, d, &patch))
+            return Result::failure("Corrupt delta " + snapshots[i].second);
+        auto base = snapshot_map.find(d.base);
+        if (base == snapshot_map.end())
+            return Result::failure("Delta base " + d.base.substr(0, 8) + " missing");
+        d.base = base->second;
+
+        std::string object  = FormatDeltaHeader(d);
+        bool        written = false;
+        object.append(patch.data(), patch.size());
+        Result r = PutObject(repo_.DeltaPath(new_hashes[i]), object.data(), object.size(), written);
+        if (!r.ok) return r;
+    }
+
+    // 3. Trees name snapshots, so each is rewritten with the new
+    //    names — which gives it a new name of its own, for the
+    //    commit that points at it
+    for (auto& old_hash : ListObjects(ObjectKind::Tree)) {
+        Tree   tree;
+        Result r = LoadTree(old_hash, tree);
+        if (!r.ok) return r;
+        for (auto& e : tree) {
+            auto renamed = snapshot_map.find(e.hash);
+            if (renamed == snapshot_map.end())
+                return Result::failure("Snapshot " + e.hash.substr(0, 8) + " of tree "
+                                       + old_hash.substr(0, 8) + " missing");
+            e.hash = renamed->second;
+        }
+        std::string text     = FormatTree(tree);
+        std::string new_hash = ContentHasher::Of(to, text.data(), text.size());
+        bool        written  = false;
+        r = PutObject(repo_.TreePath(new_hash), text.data(), text.size(), written);
+        if (!r.ok) return r;
+        plan.snapshots.emplace_back(old_hash, new_hash);
+        tree_map[old_hash] = new_hash;
+        ++plan.trees;
+    }
+
+    // 4. A group commit is named by a hash over its members'
+    //    snapshots and its parent (see Repository::GroupIdText), so
+    //    it is renamed from their new names.  Its parent may be a
+    //    group too: timestamps are whole seconds, so a group and its
+    //    parent can tie, and a group waits for the next pass until
+    //    its parent has its new name.
+    std::vector<Commit> groups;
+    std::unordered_map<std::string, std::string> group_map;
+    Result r = repo_.ForEachCommit(CommitQuery{}, [&](const Commit& c) {
+        if (c.IsGroup()) groups.push_back(c);
+        return true;
+    });
+    if (!r.ok) return r;
+    std::reverse(groups.begin(), groups.end());   // oldest first
+
+    auto renamed = [&](const std::string& hash) -> const std::string* {
+        for (auto* map : {&snapshot_map, &tree_map, &group_map}) {
+            auto it = map->find(hash);
+            if (it != map->end()) return &it->second;
+        }
+        return nullptr;
+    };
+    for (size_t left = groups.size(); left > 0;) {
+        size_t before = left;
+        for (auto& group : groups) {
+            if (group_map.count(group.hash)) continue;
+            if (!group.parent_hash.empty()) {
+                const std::string* parent = renamed(group.parent_hash);
+                if (!parent) continue;   // a group not renamed yet, or missing (below)
+                group.parent_hash = *parent;
+            }
+            std::vector<Commit> members = repo_.ListGroupMembers(group.hash);
+            for (auto& m : members) {
+                auto it = snapshot_map.find(m.hash);
+                if (it == snapshot_map.end())
+                    return Result::failure("Snapshot " + m.hash.substr(0, 8) + " of group "
+                                           + group.hash.substr(0, 8) + " missing");
+                m.hash = it->second;
+            }
+            std::string id = Repository::GroupIdText(group, members);
+            group_map[group.hash] = ContentHasher::Of(to, id.data(), id.size());
+            plan.snapshots.emplace_back(group.hash, group_map[group.hash]);
+            ++plan.groups;
+            --left;
+        }
+        if (left == before)
+            return Result::failure("Parent of group commit missing: " + std::to_string(left)
+                                   + " group(s) cannot be renamed");
+    }
+
+    // 5. Thumbnails follow their snapshot (or group); a packed one
+    //    is copied out, as the packs go with DropOld()
+    for (const auto& [from, dest] : plan.snapshots) {
+        if (!HasObject(ObjectKind::Thumbnail, from)) continue;
+        r = RelinkObject(ObjectKind::Thumbnail, from, dest);
+        if (!r.ok) return r;
+    }
+
+    // Everything under an old name goes once the DB has switched:
+    // the loose files, and every pack (all of it now exists loose)
+    for (ObjectKind kind : {ObjectKind::Chunk, ObjectKind::Manifest, ObjectKind::Delta,
+                            ObjectKind::Blob, ObjectKind::Thumbnail, ObjectKind::Tree}) {
+        for (auto& [hash, path] : ListLoose(kind)) {
+            bool old = kind == ObjectKind::Chunk     ? chunk_map.count(hash) > 0
+                     : kind == ObjectKind::Tree      ? tree_map.count(hash) > 0
+                     : kind == ObjectKind::Thumbnail ? renamed(hash) != nullptr
+                                                     : snapshot_map.count(hash) > 0;
+            if (old) plan.old_objects.push_back(path);
+        }
+    }
+    for (auto& f : packs_.Files())
+        plan.old_objects.push_back(f);
+    return Result::success();
+}
+
+void BlobStore::DropOld(const RehashPlan& plan) {
+    packs_.Close();
+    std::error_code ec;
+    for (const auto& p : plan.old_objects)
+        fs::remove(p, ec);
+}
+
+// -------------------------------------------------------
+// Repack  (loose objects → pack files)
+// -------------------------------------------------------
+
+Result BlobStore::Repack(RepackStats& stats) {
+    stats = {};
+
+    std::vector<PackInput> inputs;
+    std::vector<fs::path>  loose;
+    std::unordered_map<std::string, fs::path> loose_chunks;
+
+    auto add = [&](ObjectKind kind, const std::string& hash, const fs::path& path) {
+        loose.push_back(path);
+        if (packs_.Has(kind, hash)) return;   // already packed — just drop the loose copy
+        std::error_code ec;
+        stats.bytes += static_cast<int64_t>(fs::file_size(path, ec));
+        ++stats.objects;
+        inputs.push_back({kind, hash, path});
+    };
+
+    // Snapshots first, then their chunks in snapshot order, so
+    // restoring a snapshot reads its pack mostly front to back
+    for (ObjectKind kind : {ObjectKind::Manifest, ObjectKind::Delta, ObjectKind::Blob})
+        for (auto& [hash, path] : ListLoose(kind))
+            add(kind, hash, path);
+
+    for (auto& [hash, path] : ListLoose(ObjectKind::Chunk))
+        loose_chunks.emplace(hash, path);
+
+    std::vector<char> bytes;
+    for (auto& hash : ListObjects(ObjectKind::Manifest)) {
+        Manifest m;
+        if (!ReadObject(ObjectKind::Manifest, hash, bytes) || !ParseManifest(bytes, m)) continue;
+        for (const auto& c : m.chunks) {
+            auto it = loose_chunks.find(c.hash);
+            if (it == loose_chunks.end()) continue;
+            add(ObjectKind::Chunk, it->first, it->second);
+            loose_chunks.erase(it);
+        }
+    }
+    for (auto& [hash, path] : loose_chunks)
+        add(ObjectKind::Chunk, hash, path);
+
+    for (auto& [hash, path] : ListLoose(ObjectKind::Thumbnail))
+        add(ObjectKind::Thumbnail, hash, path);
+    for (auto& [hash, path] : ListLoose(ObjectKind::Tree))
+        add(ObjectKind::Tree, hash, path);
+
+    if (loose.empty()) return Result::success();
+
+    Result r = PackSet::Write(repo_.PacksDir(), inputs, stats.packs);
+    if (!r.ok) return r;
+
+    // Only delete loose copies the new packs really contain
+    packs_ = PackSet(repo_.PacksDir());
+    for (const auto& in : inputs) {
+        if (!packs_.Has(in.kind, in.hash))
+            return Result::failure("Repacked object " + in.hash.substr(0, 8) + " not found in pack");
+    }
+
+    std::error_code ec;
+    for (const auto& p : loose)
+        fs::remove(p, ec);
+    for (const auto& e : fs::directory_iterator(repo_.ChunksDir(), ec)) {
+        std::error_code ignore;
+        if (e.is_directory() && fs::is_empty(e.path(), ignore))
+            fs::remove(e.path(), ignore);
+    }
+    return Result::success();
+}
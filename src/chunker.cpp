@@ -0,0 +1,58 @@
+#include "chunker.h"
+
+#include <array>
+
+// -------------------------------------------------------
+// Gear table
+// -------------------------------------------------------
+// 256 pseudo-random 64-bit values, generated at compile time
+// with splitmix64 from a fixed seed.  The table must never
+// change: chunk boundaries (and therefore dedup against
+// existing repos) depend on it.
+
+static constexpr std::array<uint64_t, 256> MakeGearTable() {
+    std::array<uint64_t, 256> t{};
+    uint64_t x = 0x73777663735f6364ULL;   // "swvcs_cd"
+    for (auto& v : t) {
+        x += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        v = z ^ (z >> 31);
+    }
+    return t;
+}
+
+static constexpr std::array<uint64_t, 256> kGear = MakeGearTable();
+
+// Normalised chunking: below the average size a cut needs more
+// zero bits (harder), above it fewer (easier), which pulls chunk
+// sizes towards kAvgSize.  The gear hash shifts left, so the top
+// bits carry the most recent ~64 bytes of context.
+static constexpr uint64_t TopBits(int n) { return ~0ULL << (64 - n); }
+
+static constexpr uint64_t kMaskHard = TopBits(18);   // avg 2^16 + 2
+static constexpr uint64_t kMaskEasy = TopBits(14);   // avg 2^16 - 2
+
+// -------------------------------------------------------
+// Scan
+// -------------------------------------------------------
+
+size_t Chunker::Scan(const uint8_t* data, size_t len, bool& at_boundary) {
+    at_boundary = false;
+
+    for (size_t i = 0; i < len; ++i) {
+        hash_ = (hash_ << 1) + kGear[data[i]];
+        ++size_;
+
+        if (size_ < kMinSize) continue;
+
+        uint64_t mask = (size_ < kAvgSize) ? kMaskHard : kMaskEasy;
+        if ((hash_ & mask) == 0 || size_ >= kMaxSize) {
+            at_boundary = true;
+            Reset();
+            return i + 1;
+        }
+    }
+    return len;
+}
@@ -1,14 +1,16 @@
 #include "commit_engine.h"
 #include "repository.h"
 #include "sw_connection.h"
+#include "blob_store.h"
+#include "commit_pipeline.h"
+#include "content_hash.h"
+#include "stat_cache.h"
+#include "thread_pool.h"
+#include "utils.h"
 
 #include <Windows.h>
-#include <wincrypt.h>   // CryptAcquireContext, SHA-256
-#pragma comment(lib, "advapi32.lib")
 
-#include <fstream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <ctime>
@@ -42,133 +44,167 @@ Result CommitEngine::Commit(const std::string& message, bool capture_thumbnail)
     if (!fs::exists(src_path))
         return Result::failure("File not found on disk: " + doc_info.path);
 
-    // 3. Compute hash of the file
-    std::string hash = HashFile(src_path);
-    if (hash.empty())
-        return Result::failure("Failed to hash file: " + doc_info.path);
-
-    // 4. Copy blob into repo
-    fs::path blob_dest = repo_.BlobPath(hash);
-    if (fs::exists(blob_dest)) {
-        std::cout << "[commit] Identical snapshot already stored (hash: " << hash.substr(0,8) << "...)\n";
-        // Still create a new commit record pointing to this blob
-    } else {
-        r = CopyBlob(src_path, blob_dest);
-        if (!r.ok) return r;
-        std::cout << "[commit] Stored blob " << blob_dest.filename().string() << "\n";
-    }
-
-    // 5. Thumbnail (best-effort — don't fail the commit if this fails)
-    if (capture_thumbnail) {
-        fs::path thumb_dest = repo_.ThumbnailPath(hash);
-        Result tr = sw_.SaveThumbnail(thumb_dest.string());
-        if (!tr.ok) {
-            std::cerr << "[commit] Thumbnail skipped: " << tr.err << "\n";
-        }
-    }
-
-    // 6. Gather SW metadata
+    // 3. Hash and store the file on a worker while this thread reads
+    //    the properties and thumbnail over COM, then save the commit
+    //    and move HEAD (CommitPipeline)
     ::Commit c;
-    c.hash        = hash;
     c.message     = message;
     c.timestamp   = NowISO8601();
     c.parent_hash = repo_.GetHead();
     c.author      = GetAuthor();
-
     c.sw_meta.doc_path = doc_info.path;
     c.sw_meta.doc_type = doc_info.type;
 
-    double mass = 0, volume = 0, surface_area = 0;
-    sw_.GetMassProperties(mass, volume, surface_area);
-    c.sw_meta.mass         = mass;
-    c.sw_meta.volume       = volume;
-    c.sw_meta.surface_area = surface_area;
-
-    int feat_count = 0;
-    sw_.GetFeatureCount(feat_count);
-    c.sw_meta.feature_count = feat_count;
-
-    sw_.GetMaterial(c.sw_meta.material);
-    sw_.GetBoundingBox(c.sw_meta.bbox_x, c.sw_meta.bbox_y, c.sw_meta.bbox_z);
-    sw_.GetConfigCount(c.sw_meta.config_count);
-
-    // Blob file size (filesystem — no COM needed)
-    std::error_code size_ec;
-    c.sw_meta.blob_size_bytes =
-        static_cast<int64_t>(fs::file_size(blob_dest, size_ec));
-    if (size_ec) c.sw_meta.blob_size_bytes = 0;
-
-    // 7. Persist commit record and update HEAD
-    r = repo_.SaveCommit(c);
+    StoreStats stats;
+    r = CommitPipeline(repo_).Run(src_path, DocumentSourceFor(sw_, capture_thumbnail), c, stats);
     if (!r.ok) return r;
 
-    r = repo_.SetHead(hash);
-    if (!r.ok) return r;
-
-    std::cout << "[commit] Created commit " << hash.substr(0,8) << " \""  << message << "\"\n";
+    std::cout << "[commit] Created commit " << c.hash.substr(0,8) << " \""  << message << "\"\n";
     return Result::success();
 }
 
 // -------------------------------------------------------
-// HashFile  (SHA-256 via Windows CryptoAPI)
+// CommitAllOpen
 // -------------------------------------------------------
+// COM is single-threaded here, so saving and reading properties
+// go one document at a time; the file work — hashing, chunking,
+// compressing, the part that grows with the files — then runs
+// for all of them at once on the thread pool.
+
+Result CommitEngine::CommitAllOpen(const std::string& message) {
+    std::vector<ActiveDocInfo> docs;
+    Result r = sw_.ListOpenDocs(docs);
+    if (!r.ok) return r;
 
-std::string CommitEngine::HashFile(const fs::path& path) {
-    HCRYPTPROV prov   = 0;
-    HCRYPTHASH hash_h = 0;
-    std::string result;
-
-    if (!CryptAcquireContext(&prov, nullptr, nullptr,
-                             PROV_RSA_AES, CRYPT_VERIFYCONTEXT))
-        return "";
-
-    if (!CryptCreateHash(prov, CALG_SHA_256, 0, 0, &hash_h)) {
-        CryptReleaseContext(prov, 0);
-        return "";
-    }
-
-    std::ifstream f(path, std::ios::binary);
-    if (!f) {
-        CryptDestroyHash(hash_h);
-        CryptReleaseContext(prov, 0);
-        return "";
+    struct Member {
+        ::Commit    c;
+        FileStat    seen;
+        std::string base;       // the document's last commit ("" = none)
+        StoreStats  stats;
+        Result      stored;
+        bool        cached = false;
+    };
+    std::vector<Member> members;
+
+    // 1. Save each document and read its properties
+    for (const auto& doc : docs) {
+        if (doc.path.empty()) {
+            std::cerr << "[commit] Skipped " << doc.title << ": not saved to a file yet\n";
+            continue;
+        }
+        r = sw_.SelectDoc(doc.path);
+        if (!r.ok) {
+            std::cerr << "[commit] Skipped " << doc.path << ": " << r.err << "\n";
+            continue;
+        }
+        if (doc.is_dirty) {
+            r = sw_.SaveActiveDoc();
+            if (!r.ok)
+                std::cerr << "[commit] Warning: save of " << doc.path << " failed (" << r.err
+                          << "), continuing with file as-is.\n";
+        }
+        Member m;
+        m.c.sw_meta.doc_path = doc.path;
+        m.c.sw_meta.doc_type = doc.type;
+        ReadProperties(sw_, m.c.sw_meta);
+        members.push_back(std::move(m));
     }
-
-    const size_t CHUNK = 65536;
-    std::vector<char> buf(CHUNK);
-    while (f) {
-        f.read(buf.data(), CHUNK);
-        std::streamsize n = f.gcount();
-        if (n > 0) {
-            CryptHashData(hash_h,
-                          reinterpret_cast<BYTE*>(buf.data()),
-                          static_cast<DWORD>(n), 0);
+    ActiveDocInfo active;
+    sw_.GetActiveDocInfo(active);   // back to the active document (thumbnail below)
+    if (members.empty())
+        return Result::failure("No saved documents are open in SolidWorks.");
+
+    // 2. The stat cache, and each document's last commit as its
+    //    delta base — database reads, so before going parallel
+    BlobStore store(repo_);
+    StatCache stat_cache(repo_);
+    for (auto& m : members) {
+        const std::string& path = m.c.sw_meta.doc_path;
+        std::string hash = stat_cache.Lookup(path, &m.seen);
+        if (!hash.empty() && store.Has(hash)) {
+            m.cached               = true;
+            m.c.hash               = hash;
+            m.stats.already_stored = true;
+            m.stats.logical_bytes  = m.seen.size;
         }
+        CommitQuery last;
+        last.doc_path = path;
+        last.limit    = 1;
+        auto prev = repo_.ListCommits(last);
+        if (!prev.empty()) m.base = prev.front().hash;
     }
 
-    DWORD hash_len = 32;
-    BYTE  hash_bytes[32];
-    if (CryptGetHashParam(hash_h, HP_HASHVAL, hash_bytes, &hash_len, 0)) {
-        std::ostringstream oss;
-        for (int i = 0; i < 32; ++i)
-            oss << std::hex << std::setw(2) << std::setfill('0')
-                << static_cast<int>(hash_bytes[i]);
-        result = oss.str();
+    // 3. Hash and store every file that may have changed, at once
+    ThreadPool::Shared().ParallelFor(members.size(), [&](size_t i) {
+        Member& m = members[i];
+        if (!m.cached)
+            m.stored = store.Store(m.c.sw_meta.doc_path, m.c.hash, m.stats, m.base);
+    });
+
+    // 4. Keep the documents that differ from their last commit
+    std::vector<Member*> changed;
+    for (auto& m : members) {
+        if (!m.stored.ok) return Result::failure(m.c.sw_meta.doc_path + ": " + m.stored.err);
+        if (!m.cached) stat_cache.Record(m.c.sw_meta.doc_path, m.seen, m.c.hash);
+        if (m.c.hash != m.base) changed.push_back(&m);
+    }
+    if (changed.empty())
+        return Result::failure("Nothing to commit: none of the " + std::to_string(members.size())
+                               + " open documents changed since its last commit.");
+    std::sort(changed.begin(), changed.end(), [](const Member* a, const Member* b) {
+        return a->c.sw_meta.doc_path < b->c.sw_meta.doc_path;
+    });
+
+    // 5. The group commit, named by a hash over what it is made of
+    ::Commit group;
+    group.message     = message;
+    group.timestamp   = NowISO8601();
+    group.parent_hash = repo_.GetHead();
+    group.author      = GetAuthor();
+    group.sw_meta.doc_type = ::Commit::kGroupType;
+
+    std::vector<::Commit> commits;
+    for (Member* m : changed) {
+        ::Commit& c = m->c;
+        c.message     = group.message;
+        c.timestamp   = group.timestamp;
+        c.parent_hash = group.parent_hash;
+        c.author      = group.author;
+        c.sw_meta.blob_size_bytes   = m->stats.logical_bytes;
+        c.sw_meta.stored_size_bytes = m->stats.written_bytes;
+        group.sw_meta.blob_size_bytes   += m->stats.logical_bytes;
+        group.sw_meta.stored_size_bytes += m->stats.written_bytes;
+        std::cout << "[commit]   " << c.hash.substr(0,8) << "  " << c.sw_meta.doc_path
+                  << (m->stats.already_stored ? "  (already stored)" : "") << "\n";
+        commits.push_back(std::move(c));
+    }
+    std::string id = Repository::GroupIdText(group, commits);
+    group.hash = ContentHasher::Of(repo_.GetHashAlgo(), id.data(), id.size());
+    for (auto& c : commits) c.group_hash = group.hash;
+    commits.push_back(group);
+
+    // 6. Thumbnail of the active document, for the group (and for
+    //    the active document's own commit if it is one of them)
+    Result tr = sw_.SaveThumbnail(repo_.ThumbnailPath(group.hash).string());
+    if (tr.ok) {
+        for (size_t i = 0; i + 1 < commits.size(); ++i) {
+            if (!Utils::IEquals(commits[i].sw_meta.doc_path, active.path)) continue;
+            std::error_code ec;
+            fs::copy_file(repo_.ThumbnailPath(group.hash), repo_.ThumbnailPath(commits[i].hash),
+                          fs::copy_options::overwrite_existing, ec);
+        }
+    } else {
+        std::cerr << "[commit] Thumbnail skipped: " << tr.err << "\n";
     }
 
-    CryptDestroyHash(hash_h);
-    CryptReleaseContext(prov, 0);
-    return result;
-}
-
-// -------------------------------------------------------
-// CopyBlob
-// -------------------------------------------------------
+    // 7. Members, group and HEAD in one transaction
+    r = repo_.SaveCommits(commits, group.hash);
+    if (!r.ok) return r;
 
-Result CommitEngine::CopyBlob(const fs::path& src, const fs::path& dst) {
-    std::error_code ec;
-    fs::copy_file(src, dst, fs::copy_options::overwrite_existing, ec);
-    if (ec) return Result::failure("Failed to copy blob: " + ec.message());
+    std::cout << "[commit] Created group commit " << group.hash.substr(0,8) << " \"" << message
+              << "\": " << changed.size() << " of " << members.size() << " open documents ("
+              << Utils::FormatBytes(static_cast<uintmax_t>(group.sw_meta.stored_size_bytes))
+              << " written)\n";
     return Result::success();
 }
 
@@ -0,0 +1,387 @@
+#include "commit_graph.h"
+#include "repository.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+constexpr char     kMagic[8] = { 'S', 'W', 'V', 'C', 'S', 'C', 'G', 'R' };
+constexpr uint32_t kVersion  = 1;
+
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kFanoutSize = 256 * 4;
+constexpr size_t kKeysAt     = kHeaderSize + kFanoutSize;
+constexpr size_t kKeySize    = 32;
+constexpr size_t kNodeSize   = 24;
+
+constexpr uint32_t kInProgress = 0xffffffff;   // generation while being computed
+
+uint32_t GetLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+uint64_t GetLE64(const uint8_t* p) {
+    return uint64_t(GetLE32(p)) | uint64_t(GetLE32(p + 4)) << 32;
+}
+
+void PutLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+void PutLE64(std::string& out, uint64_t v) {
+    PutLE32(out, static_cast<uint32_t>(v));
+    PutLE32(out, static_cast<uint32_t>(v >> 32));
+}
+
+// Height (generation - 1) that the skip pointer of a commit at
+// height h points to: far enough back to give O(log n) walks,
+// chosen so that walks from nearby heights share targets
+int64_t InvertLowestOne(int64_t n) { return n & (n - 1); }
+
+int64_t SkipHeight(int64_t h) {
+    if (h < 2) return 0;
+    return (h & 1) ? InvertLowestOne(InvertLowestOne(h - 1)) + 1 : InvertLowestOne(h);
+}
+
+} // namespace
+
+CommitGraph::CommitGraph(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Load / Write
+// -------------------------------------------------------
+
+void CommitGraph::Reset() {
+    file_.Close();
+    file_count_ = 0;
+    seq_        = 0;
+    pending_keys_.clear();
+    pending_.clear();
+    pending_ids_.clear();
+}
+
+bool CommitGraph::MapFile() {
+    if (!file_.Open(repo_.CommitGraphPath())) return false;
+
+    const uint8_t* d = file_.Data();
+    size_t         n = file_.Size();
+    if (n < kKeysAt || std::memcmp(d, kMagic, sizeof(kMagic)) != 0
+        || GetLE32(d + 8) != kVersion
+        || GetLE32(d + 16) != static_cast<uint32_t>(repo_.GetHashAlgo())) {
+        file_.Close();
+        return false;
+    }
+    uint32_t count = GetLE32(d + 12);
+    if (n != kKeysAt + size_t{count} * (kKeySize + kNodeSize)
+        || GetLE32(d + kHeaderSize + 255 * 4) != count) {
+        file_.Close();
+        return false;
+    }
+    file_count_ = count;
+    seq_        = static_cast<int64_t>(GetLE64(d + 24));
+    return true;
+}
+
+Result CommitGraph::Load() {
+    Reset();
+    MapFile();   // no file (or an unusable one) = everything is pending
+
+    std::vector<CommitLink> newer;
+    Result r = repo_.ForEachCommitLink(seq_, [&](const CommitLink& l) { newer.push_back(l); });
+    if (!r.ok) return r;
+
+    // A re-saved commit (INSERT OR REPLACE: the same snapshot
+    // committed again, say after a revert) comes back with a new
+    // row id, and may have a new parent and time.  Its node — and
+    // the generations and skips built on it — has the old ones, so
+    // start over from the whole table, as TrendCache does.
+    if (std::any_of(newer.begin(), newer.end(), [&](const CommitLink& l) { return Moved(l); })) {
+        Reset();
+        std::error_code ec;
+        if (!repo_.IsReadOnly()) fs::remove(repo_.CommitGraphPath(), ec);
+        newer.clear();
+        r = repo_.ForEachCommitLink(0, [&](const CommitLink& l) { newer.push_back(l); });
+        if (!r.ok) return r;
+    }
+    AddLinks(newer);
+
+    if (pending_.size() >= kMaxPending && !repo_.IsReadOnly()) {
+        // The graph in memory is complete either way; a failed
+        // rewrite only means the next Load() reads more rows
+        Result w = Write();
+        if (!w.ok) std::cerr << "[graph] Could not rewrite commit-graph: " << w.err << "\n";
+    }
+    return Result::success();
+}
+
+Result CommitGraph::Write() {
+    // Built from the commits table alone, so a stale file is never
+    // copied forward.  Unmapped first: Windows can't replace a
+    // mapped file.
+    Reset();
+    std::vector<CommitLink> links;
+    Result r = repo_.ForEachCommitLink(0, [&](const CommitLink& l) { links.push_back(l); });
+    if (!r.ok) return r;
+    AddLinks(links);   // every commit is pending now, ids in save order
+
+    const Id count = static_cast<Id>(pending_.size());
+    std::vector<Id> order(count);
+    std::iota(order.begin(), order.end(), Id{0});
+    std::sort(order.begin(), order.end(),
+              [&](Id a, Id b) { return pending_keys_[a] < pending_keys_[b]; });
+    std::vector<Id> position(count);
+    for (Id i = 0; i < count; ++i) position[order[i]] = i;
+    auto remap = [&](Id id) { return id == kNone ? kNone : position[id]; };
+
+    std::string out(kMagic, sizeof(kMagic));
+    out.reserve(kKeysAt + size_t{count} * (kKeySize + kNodeSize));
+    PutLE32(out, kVersion);
+    PutLE32(out, count);
+    PutLE32(out, static_cast<uint32_t>(repo_.GetHashAlgo()));
+    PutLE32(out, 0);
+    PutLE64(out, static_cast<uint64_t>(seq_));
+
+    uint32_t running = 0;
+    for (int b = 0; b < 256; ++b) {
+        while (running < count && pending_keys_[order[running]][0] == b) ++running;
+        PutLE32(out, running);
+    }
+    for (Id id : order)
+        out.append(reinterpret_cast<const char*>(pending_keys_[id].data()), kKeySize);
+    for (Id id : order) {
+        const Node& n = pending_[id];
+        PutLE32(out, remap(n.parent));
+        PutLE32(out, n.generation);
+        PutLE32(out, remap(n.skip));
+        PutLE32(out, 0);
+        PutLE64(out, static_cast<uint64_t>(n.time));
+    }
+
+    fs::path        path = repo_.CommitGraphPath();
+    fs::path        tmp  = path;
+    std::error_code ec;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!f) {
+            fs::remove(tmp, ec);
+            return Result::failure("Failed to write " + tmp.string());
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        std::string msg = ec.message();
+        fs::remove(tmp, ec);
+        return Result::failure("Failed to store " + path.string() + ": " + msg);
+    }
+    return Load();
+}
+
+// -------------------------------------------------------
+// AddLinks — append commits not in the graph yet
+// -------------------------------------------------------
+
+bool CommitGraph::Moved(const CommitLink& l) const {
+    if (l.hash.size() != kKeySize) return false;
+    Id id = FindKey(reinterpret_cast<const uint8_t*>(l.hash.data()));
+    if (id == kNone) return false;
+    // By hash: the new parent may not be in the graph yet
+    Node        n = GetNode(id);
+    std::string was;
+    if (n.parent != kNone) was.assign(reinterpret_cast<const char*>(KeyOf(n.parent)), kKeySize);
+    const std::string& now = l.parent == l.hash ? std::string() : l.parent;
+    return was != now || n.time != l.time;
+}
+
+void CommitGraph::AddLinks(const std::vector<CommitLink>& links) {
+    const Id base = static_cast<Id>(Size());
+    std::vector<const std::string*> parents;   // of each added commit
+    for (const auto& l : links) {
+        seq_ = std::max(seq_, l.seq);
+        if (l.hash.size() != kKeySize) continue;
+        const auto* raw = reinterpret_cast<const uint8_t*>(l.hash.data());
+        if (FindKey(raw) != kNone) continue;   // re-saved unchanged (else Load() rebuilds)
+
+        Key key;
+        std::memcpy(key.data(), raw, kKeySize);
+        pending_ids_.emplace(l.hash, static_cast<Id>(Size()));
+        pending_keys_.push_back(key);
+        Node n;
+        n.time = l.time;
+        pending_.push_back(n);
+        parents.push_back(&l.parent);
+    }
+    const Id end = static_cast<Id>(Size());
+    if (end == base) return;
+
+    // Parents (a parent that was never saved counts as no parent)
+    for (Id id = base; id < end; ++id) {
+        const std::string& parent = *parents[id - base];
+        Id p = parent.size() == kKeySize
+             ? FindKey(reinterpret_cast<const uint8_t*>(parent.data())) : kNone;
+        pending_[id - file_count_].parent = p == id ? kNone : p;
+    }
+
+    // Generations: walk up to the first commit that has one, then
+    // number the chain back down.  Iterative — histories are deep.
+    // Newest first, so that a cycle — a commit re-saved on top of
+    // its own descendant (A, B, A) — is entered at the re-saved
+    // commit and cut at the stale link back to it.
+    std::vector<Id> chain;
+    for (Id id = end; id-- > base;) {
+        Id walk = id;
+        while (walk != kNone && walk >= base && pending_[walk - file_count_].generation == 0) {
+            pending_[walk - file_count_].generation = kInProgress;
+            chain.push_back(walk);
+            walk = pending_[walk - file_count_].parent;
+        }
+        if (walk != kNone && walk >= base && pending_[walk - file_count_].generation == kInProgress) {
+            // A parent cycle (a re-saved commit, or a corrupt
+            // database): cut it so every walk still ends
+            pending_[chain.back() - file_count_].parent = kNone;
+            walk = kNone;
+        }
+        uint32_t generation = walk == kNone ? 0 : Generation(walk);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+            pending_[*it - file_count_].generation = ++generation;
+        chain.clear();
+    }
+
+    // Skip pointers, oldest first: each one is found by walking
+    // ancestors whose skip pointers are already set
+    std::vector<Id> by_generation(end - base);
+    std::iota(by_generation.begin(), by_generation.end(), base);
+    std::sort(by_generation.begin(), by_generation.end(), [&](Id a, Id b) {
+        return pending_[a - file_count_].generation < pending_[b - file_count_].generation;
+    });
+    for (Id id : by_generation) {
+        Node& n = pending_[id - file_count_];
+        if (n.parent != kNone)
+            n.skip = AncestorAt(n.parent, static_cast<uint32_t>(SkipHeight(n.generation - 1)) + 1);
+    }
+}
+
+// -------------------------------------------------------
+// Lookup
+// -------------------------------------------------------
+
+CommitGraph::Node CommitGraph::GetNode(Id id) const {
+    if (id >= file_count_) return pending_[id - file_count_];
+
+    const uint8_t* p = file_.Data() + kKeysAt + size_t{file_count_} * kKeySize
+                     + size_t{id} * kNodeSize;
+    Node n;
+    n.parent     = GetLE32(p);
+    n.generation = GetLE32(p + 4);
+    n.skip       = GetLE32(p + 8);
+    n.time       = static_cast<int64_t>(GetLE64(p + 16));
+    return n;
+}
+
+const uint8_t* CommitGraph::KeyOf(Id id) const {
+    if (id >= file_count_) return pending_keys_[id - file_count_].data();
+    return file_.Data() + kKeysAt + size_t{id} * kKeySize;
+}
+
+CommitGraph::Id CommitGraph::FindKey(const uint8_t* key) const {
+    if (file_count_ > 0) {
+        // Fanout narrows to the first hash byte, then binary search
+        const uint8_t* fanout = file_.Data() + kHeaderSize;
+        uint32_t lo = key[0] == 0 ? 0 : GetLE32(fanout + (key[0] - 1) * 4);
+        uint32_t hi = GetLE32(fanout + key[0] * 4);
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int      cmp = std::memcmp(KeyOf(mid), key, kKeySize);
+            if (cmp == 0) return mid;
+            if (cmp < 0) lo = mid + 1;
+            else         hi = mid;
+        }
+    }
+    auto it = pending_ids_.find(std::string(reinterpret_cast<const char*>(key), kKeySize));
+    return it == pending_ids_.end() ? kNone : it->second;
+}
+
+CommitGraph::Id CommitGraph::Find(const std::string& hash) const {
+    Key key;
+    if (!Utils::FromHex(hash, key.data(), key.size())) return kNone;
+    return FindKey(key.data());
+}
+
+std::string CommitGraph::Hash(Id id) const {
+    return id < Size() ? Utils::ToHex(KeyOf(id), kKeySize) : std::string();
+}
+
+CommitGraph::Id CommitGraph::Parent(Id id) const {
+    return id < Size() ? GetNode(id).parent : kNone;
+}
+
+uint32_t CommitGraph::Generation(Id id) const {
+    return id < Size() ? GetNode(id).generation : 0;
+}
+
+int64_t CommitGraph::Time(Id id) const {
+    return id < Size() ? GetNode(id).time : 0;
+}
+
+// -------------------------------------------------------
+// Ancestry
+// -------------------------------------------------------
+
+CommitGraph::Id CommitGraph::AncestorAt(Id id, uint32_t generation) const {
+    if (id >= Size() || generation == 0) return kNone;
+
+    Node    n      = GetNode(id);
+    int64_t target = int64_t{generation} - 1;   // as a height
+    int64_t height = int64_t{n.generation} - 1;
+    if (target > height) return kNone;
+
+    while (height > target) {
+        // Take the skip unless it overshoots, or the parent's skip
+        // would land closer to the target
+        int64_t skip      = SkipHeight(height);
+        int64_t skip_prev = SkipHeight(height - 1);
+        if (n.skip != kNone
+            && (skip == target
+                || (skip > target && !(skip_prev < skip - 2 && skip_prev >= target)))) {
+            id     = n.skip;
+            height = skip;
+        } else {
+            id = n.parent;
+            --height;
+        }
+        n = GetNode(id);
+    }
+    return id;
+}
+
+bool CommitGraph::IsAncestor(Id ancestor, Id descendant) const {
+    if (ancestor >= Size() || descendant >= Size()) return false;
+    return AncestorAt(descendant, Generation(ancestor)) == ancestor;
+}
+
+CommitGraph::Id CommitGraph::MergeBase(Id a, Id b) const {
+    if (a >= Size() || b >= Size()) return kNone;
+
+    // Bring both to the same generation; from there, "same commit
+    // at generation g" holds up to the merge base and never above
+    // it, so binary search for the highest g where it does
+    uint32_t g = std::min(Generation(a), Generation(b));
+    a = AncestorAt(a, g);
+    b = AncestorAt(b, g);
+    if (a == b) return a;
+    if (AncestorAt(a, 1) != AncestorAt(b, 1)) return kNone;   // different roots
+
+    uint32_t lo = 1, hi = g;   // same at lo, different at hi
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (AncestorAt(a, mid) == AncestorAt(b, mid)) lo = mid;
+        else                                          hi = mid;
+    }
+    return AncestorAt(a, lo);
+}
@@ -0,0 +1,96 @@
+#include "commit_pipeline.h"
+#include "repository.h"
+#include "stat_cache.h"
+#include "utils.h"
+
+#include <iostream>
+#include <thread>
+
+CommitPipeline::CommitPipeline(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Run
+// -------------------------------------------------------
+
+Result CommitPipeline::Run(const fs::path& file, const DocumentSource& doc, ::Commit& c,
+                           StoreStats& stats) {
+    stats = {};
+
+    // File side, on a worker.  If the stat cache shows the file is
+    // untouched since it was last hashed and that snapshot is
+    // stored, it isn't read at all.
+    std::string hash;
+    bool        unchanged = false;
+    Result      stored;
+    std::thread io([&] {
+        BlobStore store(repo_);
+        StatCache stat_cache(repo_);
+        FileStat  seen;
+        hash      = stat_cache.Lookup(file, &seen);
+        unchanged = !hash.empty() && store.Has(hash);
+        if (unchanged) {
+            stats.already_stored = true;
+            stats.logical_bytes  = seen.size;
+            return;
+        }
+        stored = store.Store(file, hash, stats, c.parent_hash);
+        if (stored.ok) stat_cache.Record(file, seen, hash);
+    });
+
+    // Document side, here: COM calls must come from the thread
+    // that connected.  The thumbnail can't be named after the hash
+    // yet.
+    fs::path thumb;
+    Result   thumb_saved = Result::failure("not captured");
+    if (doc.read_properties) doc.read_properties(c.sw_meta);
+    if (doc.save_thumbnail) {
+        thumb = repo_.ThumbsDir() / ("commit-" + std::to_string(StatCache::NowNs()) + ".tmp.bmp");
+        thumb_saved = doc.save_thumbnail(thumb.string());
+    }
+    io.join();
+
+    std::error_code ec;
+    if (!stored.ok) {
+        fs::remove(thumb, ec);
+        return stored;
+    }
+
+    if (unchanged) {
+        std::cout << "[commit] File unchanged since "
+                  << (hash == c.parent_hash ? "HEAD" : "it was last hashed")
+                  << ", not rehashed (hash: " << hash.substr(0,8) << "...)\n";
+    } else if (stats.already_stored) {
+        // Still a new commit record, pointing at the stored snapshot
+        std::cout << "[commit] Identical snapshot already stored (hash: " << hash.substr(0,8) << "...)\n";
+    } else if (stats.delta_depth > 0) {
+        std::cout << "[commit] Stored snapshot as delta ("
+                  << Utils::FormatBytes(static_cast<uintmax_t>(stats.written_bytes))
+                  << ", chain depth " << stats.delta_depth << ")\n";
+    } else if (!stats.copy_method.empty()) {
+        std::cout << "[commit] Stored full copy ("
+                  << Utils::FormatBytes(static_cast<uintmax_t>(stats.logical_bytes))
+                  << ", via " << stats.copy_method << ")\n";
+    } else {
+        std::cout << "[commit] Stored snapshot: " << stats.chunks << " chunks, "
+                  << stats.new_chunks << " new ("
+                  << Utils::FormatBytes(static_cast<uintmax_t>(stats.written_bytes))
+                  << " written)\n";
+    }
+
+    // Thumbnail: best-effort, a failure doesn't fail the commit
+    if (doc.save_thumbnail) {
+        if (thumb_saved.ok) fs::rename(thumb, repo_.ThumbnailPath(hash), ec);
+        if (!thumb_saved.ok || ec) {
+            std::cerr << "[commit] Thumbnail skipped: " << (ec ? ec.message() : thumb_saved.err) << "\n";
+            fs::remove(thumb, ec);
+        }
+    }
+
+    c.hash = hash;
+    c.sw_meta.blob_size_bytes   = stats.logical_bytes;
+    c.sw_meta.stored_size_bytes = stats.written_bytes;
+
+    Result r = repo_.SaveCommit(c);
+    if (!r.ok) return r;
+    return repo_.SetHead(hash);
+}
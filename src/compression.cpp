@@ -0,0 +1,150 @@
+#include "compression.h"
+
+#define ZSTD_STATIC_LINKING_ONLY   // ZSTD_c_stableInBuffer; zstd is linked statically
+#include <zstd.h>
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// zstd frame magic number, little-endian on disk
+constexpr unsigned char kZstdMagic[4] = { 0x28, 0xB5, 0x2F, 0xFD };
+
+// Long-distance window for ordinary objects: 128 MB
+constexpr int kLongWindowLog = 27;
+
+// Window limits for deltas: 1 KB .. 1 GB (zstd's 32-bit maximum,
+// so a delta written on one machine decodes on any other)
+constexpr int kMinWindowLog = 10;
+constexpr int kMaxWindowLog = 30;
+
+bool IsZstdFrame(const void* data, size_t len) {
+    return len >= sizeof(kZstdMagic) && std::memcmp(data, kZstdMagic, sizeof(kZstdMagic)) == 0;
+}
+
+// One compression / decompression context per thread, reused
+// across objects (creating a context costs more than a small chunk)
+struct CCtxDeleter { void operator()(ZSTD_CCtx* c) const { ZSTD_freeCCtx(c); } };
+struct DCtxDeleter { void operator()(ZSTD_DCtx* d) const { ZSTD_freeDCtx(d); } };
+
+ZSTD_CCtx* ThreadCCtx() {
+    thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx(ZSTD_createCCtx());
+    return cctx.get();
+}
+
+ZSTD_DCtx* ThreadDCtx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx([] {
+        ZSTD_DCtx* d = ZSTD_createDCtx();
+        ZSTD_DCtx_setParameter(d, ZSTD_d_windowLogMax, kMaxWindowLog);
+        return d;
+    }());
+    return dctx.get();
+}
+
+// Smallest window that lets a delta reference all of base
+int DeltaWindowLog(size_t base_len, size_t target_len) {
+    size_t span = base_len + target_len;
+    int    log  = kMinWindowLog;
+    while (log < kMaxWindowLog && (size_t{1} << log) < span) ++log;
+    return log;
+}
+
+} // namespace
+
+namespace Compression {
+
+bool Encode(const void* data, size_t len, const CompressionOptions& opts,
+            std::vector<char>& out) {
+    int level = opts.level;
+    if (level <= 0) {
+        if (!IsZstdFrame(data, len)) {
+            auto* p = static_cast<const char*>(data);
+            out.assign(p, p + len);
+            return true;
+        }
+        level = 1;
+    }
+
+    ZSTD_CCtx* cctx = ThreadCCtx();
+    if (!cctx) return false;
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+    if (opts.long_distance) {
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, kLongWindowLog);
+    }
+
+    out.resize(ZSTD_compressBound(len));
+    size_t n = ZSTD_compress2(cctx, out.data(), out.size(), data, len);
+    if (ZSTD_isError(n)) return false;
+    out.resize(n);
+    return true;
+}
+
+bool Decode(const void* data, size_t len, std::vector<char>& out) {
+    if (!IsZstdFrame(data, len)) {
+        auto* p = static_cast<const char*>(data);
+        out.assign(p, p + len);
+        return true;
+    }
+
+    unsigned long long size = ZSTD_getFrameContentSize(data, len);
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN)
+        return false;
+
+    ZSTD_DCtx* dctx = ThreadDCtx();
+    if (!dctx) return false;
+    out.resize(static_cast<size_t>(size));
+    size_t n = ZSTD_decompressDCtx(dctx, out.data(), out.size(), data, len);
+    return !ZSTD_isError(n) && n == out.size();
+}
+
+bool EncodeDelta(const void* base, size_t base_len,
+                 const void* target, size_t target_len,
+                 const CompressionOptions& opts, size_t limit, const Sink& sink) {
+    ZSTD_CCtx* cctx = ThreadCCtx();
+    if (!cctx) return false;
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, opts.level > 0 ? opts.level : 1);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, DeltaWindowLog(base_len, target_len));
+    // target stays put for the whole frame, so zstd reads it there
+    // instead of copying it into a window-sized buffer of its own
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_stableInBuffer, 1);
+    // Recorded in the frame header: DecodeDelta sizes its output by it
+    if (ZSTD_isError(ZSTD_CCtx_setPledgedSrcSize(cctx, target_len))) return false;
+    if (ZSTD_isError(ZSTD_CCtx_refPrefix(cctx, base, base_len))) return false;
+
+    std::vector<char> block(ZSTD_CStreamOutSize());
+    ZSTD_inBuffer     in{ target, target_len, 0 };
+    size_t            total = 0;
+    for (;;) {
+        ZSTD_outBuffer out{ block.data(), block.size(), 0 };
+        size_t left = ZSTD_compressStream2(cctx, &out, &in, ZSTD_e_end);
+        if (ZSTD_isError(left)) return false;
+        total += out.pos;
+        if (total >= limit || !sink(block.data(), out.pos)) return false;
+        if (left == 0) return true;
+    }
+}
+
+bool DecodeDelta(const void* base, size_t base_len,
+                 const void* delta, size_t delta_len, std::vector<char>& out) {
+    unsigned long long size = ZSTD_getFrameContentSize(delta, delta_len);
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN)
+        return false;
+
+    ZSTD_DCtx* dctx = ThreadDCtx();
+    if (!dctx) return false;
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+    if (ZSTD_isError(ZSTD_DCtx_refPrefix(dctx, base, base_len))) return false;
+
+    out.resize(static_cast<size_t>(size));
+    size_t n = ZSTD_decompressDCtx(dctx, out.data(), out.size(), delta, delta_len);
+    return !ZSTD_isError(n) && n == out.size();
+}
+
+} // namespace Compression
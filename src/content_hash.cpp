@@ -0,0 +1,61 @@
+#include "content_hash.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <vector>
+
+const char* HashAlgoName(HashAlgo algo) {
+    switch (algo) {
+        case HashAlgo::Sha256: return "sha256";
+        case HashAlgo::Blake3: return "blake3";
+    }
+    return "?";
+}
+
+bool ParseHashAlgo(const std::string& name, HashAlgo& out) {
+    if (Utils::IEquals(name, "sha256") || Utils::IEquals(name, "sha-256")) {
+        out = HashAlgo::Sha256;
+        return true;
+    }
+    if (Utils::IEquals(name, "blake3")) {
+        out = HashAlgo::Blake3;
+        return true;
+    }
+    return false;
+}
+
+static std::variant<Sha256, Blake3> MakeImpl(HashAlgo algo) {
+    if (algo == HashAlgo::Blake3) return Blake3();
+    return Sha256();
+}
+
+ContentHasher::ContentHasher(HashAlgo algo)
+    : impl_(MakeImpl(algo)) {}
+
+void ContentHasher::Update(const void* data, size_t len) {
+    std::visit([&](auto& h) { h.Update(data, len); }, impl_);
+}
+
+std::string ContentHasher::HexDigest() {
+    return std::visit([](auto& h) { return h.HexDigest(); }, impl_);
+}
+
+std::string ContentHasher::Of(HashAlgo algo, const void* data, size_t len) {
+    if (algo == HashAlgo::Blake3) return Blake3::Of(data, len);
+    return Sha256::Of(data, len);
+}
+
+void ContentHasher::HashMany(HashAlgo algo, const uint8_t* const* data,
+                             const size_t* lens, size_t count, std::string* out) {
+    if (algo == HashAlgo::Blake3) {
+        ThreadPool::Shared().ParallelFor(count, [&](size_t i) {
+            out[i] = Blake3::Of(data[i], lens[i]);
+        });
+        return;
+    }
+
+    std::vector<Sha256::Digest> digests(count);
+    Sha256::HashMany(data, lens, count, digests.data());
+    for (size_t i = 0; i < count; ++i)
+        out[i] = Utils::ToHex(digests[i].data(), digests[i].size());
+}
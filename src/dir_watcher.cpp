@@ -0,0 +1,280 @@
+#include "dir_watcher.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+DirWatcher::~DirWatcher() {
+    Close();
+}
+
+#ifdef _WIN32
+
+// -------------------------------------------------------
+// Windows — ReadDirectoryChangesW
+// -------------------------------------------------------
+
+namespace {
+
+// A directory moved in whole is reported as one name; its
+// files are not
+void ListFiles(const fs::path& dir, std::vector<fs::path>& out) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->path().filename() == ".swvcs") {
+            it.disable_recursion_pending();
+            continue;
+        }
+        std::error_code type_ec;
+        if (it->is_regular_file(type_ec)) out.push_back(it->path());
+    }
+}
+
+} // namespace
+
+Result DirWatcher::Open(const fs::path& root) {
+    Close();
+    HANDLE dir = CreateFileW(root.wstring().c_str(), FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (dir == INVALID_HANDLE_VALUE)
+        return Result::failure("Cannot watch " + root.string() + " (error "
+                               + std::to_string(GetLastError()) + ")");
+    root_       = root;
+    dir_        = dir;
+    io_event_   = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    wake_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    overlapped_ = new OVERLAPPED{};
+    buffer_.assign(16 * 1024, 0);   // 64 KB: the most a network share accepts
+    if (!io_event_ || !wake_event_) {
+        Close();
+        return Result::failure("CreateEvent failed");
+    }
+    Result r = Arm();
+    if (!r.ok) Close();
+    return r;
+}
+
+Result DirWatcher::Arm() {
+    auto* ov = static_cast<OVERLAPPED*>(overlapped_);
+    *ov        = {};
+    ov->hEvent = io_event_;
+    ResetEvent(io_event_);
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME
+                       | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    if (!ReadDirectoryChangesW(dir_, buffer_.data(),
+                               static_cast<DWORD>(buffer_.size() * sizeof(buffer_[0])),
+                               TRUE, filter, nullptr, ov, nullptr))
+        return Result::failure("ReadDirectoryChangesW failed (error "
+                               + std::to_string(GetLastError()) + ")");
+    return Result::success();
+}
+
+Result DirWatcher::Wait(int timeout_ms, WatchBatch& out) {
+    out = {};
+    if (!dir_) return Result::failure("Not watching a folder");
+
+    HANDLE handles[2] = { io_event_, wake_event_ };
+    DWORD  w = WaitForMultipleObjects(2, handles, FALSE,
+                                      timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms));
+    if (w == WAIT_TIMEOUT) return Result::success();
+    if (w == WAIT_OBJECT_0 + 1) {
+        out.interrupted = true;
+        return Result::success();
+    }
+    if (w != WAIT_OBJECT_0) return Result::failure("WaitForMultipleObjects failed");
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(dir_, static_cast<OVERLAPPED*>(overlapped_), &bytes, FALSE)) {
+        if (GetLastError() != ERROR_NOTIFY_ENUM_DIR)
+            return Result::failure("ReadDirectoryChangesW failed (error "
+                                   + std::to_string(GetLastError()) + ")");
+        bytes = 0;
+    }
+
+    // Nothing returned means the buffer overflowed and the changes
+    // were dropped
+    if (bytes == 0) {
+        out.overflow = true;
+    } else {
+        const auto* base = reinterpret_cast<const uint8_t*>(buffer_.data());
+        for (DWORD offset = 0;;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(base + offset);
+            fs::path path = root_ / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            std::error_code ec;
+            if ((info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                && fs::is_directory(path, ec))
+                ListFiles(path, out.paths);
+            else
+                out.paths.push_back(std::move(path));
+            if (info->NextEntryOffset == 0) break;
+            offset += info->NextEntryOffset;
+        }
+    }
+    return Arm();   // the records are copied out, so the buffer is free again
+}
+
+void DirWatcher::Interrupt() {
+    if (wake_event_) SetEvent(wake_event_);
+}
+
+void DirWatcher::Close() {
+    if (dir_) {
+        auto* ov    = static_cast<OVERLAPPED*>(overlapped_);
+        DWORD bytes = 0;
+        if (CancelIoEx(dir_, ov)) GetOverlappedResult(dir_, ov, &bytes, TRUE);
+        CloseHandle(dir_);
+    }
+    if (io_event_) CloseHandle(io_event_);
+    if (wake_event_) CloseHandle(wake_event_);
+    delete static_cast<OVERLAPPED*>(overlapped_);
+    dir_        = nullptr;
+    io_event_   = nullptr;
+    wake_event_ = nullptr;
+    overlapped_ = nullptr;
+    buffer_.clear();
+}
+
+#elif defined(__linux__)
+
+// -------------------------------------------------------
+// Linux — inotify
+// -------------------------------------------------------
+
+Result DirWatcher::Open(const fs::path& root) {
+    Close();
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) return Result::failure(std::string("inotify: ") + std::strerror(errno));
+    if (::pipe2(wake_, O_NONBLOCK | O_CLOEXEC) != 0) {
+        Close();
+        return Result::failure(std::string("pipe: ") + std::strerror(errno));
+    }
+    root_ = root;
+    Result r = AddTree(root, nullptr);
+    if (!r.ok) Close();
+    return r;
+}
+
+// Watch dir and every directory below it.  The watch goes on
+// before the listing, so a file created meanwhile is either
+// listed or reported — found receives the files listed.
+Result DirWatcher::AddTree(const fs::path& dir, std::vector<fs::path>* found) {
+    constexpr uint32_t kMask = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM
+                             | IN_MOVED_TO | IN_DELETE | IN_ONLYDIR | IN_DONT_FOLLOW;
+    int wd = ::inotify_add_watch(fd_, dir.c_str(), kMask);
+    if (wd < 0) {
+        if (errno == ENOENT || errno == ENOTDIR) return Result::success();   // already gone
+        if (errno == ENOSPC)
+            return Result::failure("Too many folders to watch: raise fs.inotify.max_user_watches");
+        return Result::failure("Cannot watch " + dir.string() + ": " + std::strerror(errno));
+    }
+    dirs_[wd] = dir;   // a directory moved within the tree keeps its wd, under the new name
+
+    std::error_code ec;
+    fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        std::error_code type_ec;
+        if (it->is_directory(type_ec)) {
+            if (it->path().filename() != ".swvcs" && !it->is_symlink(type_ec)) {
+                Result r = AddTree(it->path(), found);
+                if (!r.ok) return r;
+            }
+        } else if (found && it->is_regular_file(type_ec)) {
+            found->push_back(it->path());
+        }
+    }
+    return Result::success();
+}
+
+Result DirWatcher::Wait(int timeout_ms, WatchBatch& out) {
+    out = {};
+    if (fd_ < 0) return Result::failure("Not watching a folder");
+
+    // poll() is never restarted after a signal, so Ctrl+C always
+    // gets through even without the self-pipe
+    pollfd fds[2] = { { fd_, POLLIN, 0 }, { wake_[0], POLLIN, 0 } };
+    if (::poll(fds, 2, timeout_ms) < 0) {
+        if (errno == EINTR) return Result::success();
+        return Result::failure(std::string("poll: ") + std::strerror(errno));
+    }
+    if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (::read(wake_[0], drain, sizeof(drain)) > 0) {}
+        out.interrupted = true;
+    }
+    if (!(fds[0].revents & POLLIN)) return Result::success();
+
+    alignas(inotify_event) char buf[64 * 1024];
+    for (;;) {
+        ssize_t len = ::read(fd_, buf, sizeof(buf));
+        if (len <= 0) break;   // EAGAIN: drained
+        for (const char* p = buf; p < buf + len;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                out.overflow = true;
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {   // the directory is gone
+                dirs_.erase(ev->wd);
+                continue;
+            }
+            auto dir = dirs_.find(ev->wd);
+            if (dir == dirs_.end() || ev->len == 0) continue;
+
+            fs::path path = dir->second / ev->name;
+            if (!(ev->mask & IN_ISDIR)) {
+                out.paths.push_back(std::move(path));
+            } else if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && path.filename() != ".swvcs") {
+                Result r = AddTree(path, &out.paths);
+                if (!r.ok) return r;
+            }
+        }
+    }
+    return Result::success();
+}
+
+void DirWatcher::Interrupt() {
+    if (wake_[1] < 0) return;
+    char    c = 1;
+    ssize_t n = ::write(wake_[1], &c, 1);   // full pipe: a wake-up is already pending
+    (void)n;
+}
+
+void DirWatcher::Close() {
+    if (fd_ >= 0) ::close(fd_);
+    if (wake_[0] >= 0) ::close(wake_[0]);
+    if (wake_[1] >= 0) ::close(wake_[1]);
+    fd_      = -1;
+    wake_[0] = wake_[1] = -1;
+    dirs_.clear();
+}
+
+#else
+
+// -------------------------------------------------------
+// Elsewhere — not supported
+// -------------------------------------------------------
+
+Result DirWatcher::Open(const fs::path& root) {
+    root_ = root;
+    return Result::failure("Watching folders is not supported on this platform");
+}
+
+Result DirWatcher::Wait(int, WatchBatch& out) {
+    out = {};
+    return Result::failure("Not watching a folder");
+}
+
+void DirWatcher::Interrupt() {}
+void DirWatcher::Close() {}
+
+#endif
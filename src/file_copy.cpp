@@ -0,0 +1,151 @@
+#include "file_copy.h"
+
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#endif
+
+namespace FileCopy {
+
+const char* MethodName(Method m) {
+    switch (m) {
+        case Method::Reflink:    return "reflink";
+        case Method::CopyRange:  return "copy_file_range";
+        case Method::SystemCopy: return "system copy";
+        case Method::Hardlink:   return "hard link";
+        case Method::Buffered:   return "buffered copy";
+    }
+    return "?";
+}
+
+namespace {
+
+// -------------------------------------------------------
+// KernelCopy  (tiers 1-2)
+// -------------------------------------------------------
+// Returns false without leaving dst behind if the filesystem
+// can't do it, so the caller falls through to the next tier.
+
+#ifdef _WIN32
+
+bool KernelCopy(const fs::path& src, const fs::path& dst, Method& used) {
+    BOOL cancel = FALSE;
+    if (CopyFileExW(src.wstring().c_str(), dst.wstring().c_str(), nullptr, nullptr,
+                    &cancel, COPY_FILE_FAIL_IF_EXISTS)) {
+        used = Method::SystemCopy;
+        return true;
+    }
+    DeleteFileW(dst.wstring().c_str());
+    return false;
+}
+
+#else
+
+bool KernelCopy(const fs::path& src, const fs::path& dst, Method& used) {
+#ifdef __linux__
+    int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+
+    struct stat st;
+    if (::fstat(in, &st) != 0) {
+        ::close(in);
+        return false;
+    }
+    int out = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    bool ok = false;
+#ifdef FICLONE
+    if (::ioctl(out, FICLONE, in) == 0) {
+        used = Method::Reflink;
+        ok   = true;
+    }
+#endif
+
+    if (!ok) {
+        // Loops because one call may copy less than asked; any
+        // failure (EXDEV, ENOSYS, EOPNOTSUPP, a file that shrank)
+        // just means "not this way"
+        off_t left = st.st_size;
+        ok = true;
+        while (left > 0) {
+            ssize_t n = ::copy_file_range(in, nullptr, out, nullptr,
+                                          static_cast<size_t>(left), 0);
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            left -= n;
+        }
+        if (ok) used = Method::CopyRange;
+    }
+
+    ::close(in);
+    if (::close(out) != 0) ok = false;
+    if (!ok) ::unlink(dst.c_str());
+    return ok;
+#else
+    (void)src;
+    (void)dst;
+    (void)used;
+    return false;
+#endif
+}
+
+#endif
+
+Result BufferedCopy(const fs::path& src, const fs::path& dst) {
+    std::ifstream in(src, std::ios::binary);
+    if (!in) return Result::failure("Cannot open for reading: " + src.string());
+
+    std::error_code ec;
+    {
+        std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+        if (!out) return Result::failure("Cannot write: " + dst.string());
+
+        std::vector<char> buf(1 << 20);
+        while (in) {
+            in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            if (in.gcount() > 0) out.write(buf.data(), in.gcount());
+        }
+        if (!in.bad() && out) return Result::success();
+    }
+    fs::remove(dst, ec);
+    return Result::failure("Failed to copy " + src.string() + " to " + dst.string());
+}
+
+} // namespace
+
+Result Copy(const fs::path& src, const fs::path& dst, bool allow_hardlink, Method& used) {
+    std::error_code ec;
+    if (fs::exists(dst, ec)) return Result::failure("Copy target already exists: " + dst.string());
+
+    if (KernelCopy(src, dst, used)) return Result::success();
+
+    if (allow_hardlink) {
+        fs::create_hard_link(src, dst, ec);
+        if (!ec) {
+            used = Method::Hardlink;
+            return Result::success();
+        }
+    }
+
+    used = Method::Buffered;
+    return BufferedCopy(src, dst);
+}
+
+} // namespace FileCopy
@@ -1,21 +1,25 @@
 #include "main_window.h"
 #include "commit_dialog.h"
 
+#include "blob_store.h"
 #include "commit_engine.h"
 #include "revert_engine.h"
 
 #include <QApplication>
+#include <QComboBox>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QIcon>
 #include <QLabel>
+#include <QLineEdit>
 #include <QListWidget>
 #include <QMessageBox>
 #include <QPixmap>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QSplitter>
 #include <QStatusBar>
 #include <QTimer>
@@ -130,16 +134,53 @@ void MainWindow::setupUi()
     auto* splitter = new QSplitter(Qt::Horizontal, this);
     splitter->setHandleWidth(4);
 
-    // -- Left: commit list --
+    // -- Left: search box and document filter above the commit list --
+    auto* leftPanel  = new QWidget(this);
+    auto* leftLayout = new QVBoxLayout(leftPanel);
+    leftLayout->setContentsMargins(0, 0, 0, 0);
+    leftLayout->setSpacing(4);
+
+    // Filters as you type, once typing pauses
+    searchBox_ = new QLineEdit(this);
+    searchBox_->setPlaceholderText("Search messages, materials, file names");
+    searchBox_->setClearButtonEnabled(true);
+    searchTimer_ = new QTimer(this);
+    searchTimer_->setSingleShot(true);
+    searchTimer_->setInterval(150);
+    connect(searchBox_, &QLineEdit::textChanged, searchTimer_, qOverload<>(&QTimer::start));
+    connect(searchTimer_, &QTimer::timeout, this, [this]() {
+        std::string text = searchBox_->text().trimmed().toStdString();
+        if (text == listSearch_) return;
+        listSearch_ = text;
+        refreshCommitList();
+    });
+    leftLayout->addWidget(searchBox_);
+
+    docFilter_ = new QComboBox(this);
+    docFilter_->setToolTip("Show the history of one document");
+    docFilter_->addItem("All documents", QString());
+    connect(docFilter_, &QComboBox::currentIndexChanged, this, [this](int index) {
+        listDoc_ = docFilter_->itemData(index).toString().toStdString();
+        refreshCommitList();
+    });
+    leftLayout->addWidget(docFilter_);
+
     commitList_ = new QListWidget(this);
     commitList_->setIconSize(QSize(64, 64));
     commitList_->setSpacing(2);
     commitList_->setAlternatingRowColors(true);
     commitList_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    // Older commits are fetched a page at a time as the list scrolls
+    connect(commitList_->verticalScrollBar(), &QScrollBar::valueChanged, this,
+            [this](int value) {
+                if (value >= commitList_->verticalScrollBar()->maximum())
+                    appendCommitPage();
+            });
     connect(commitList_, &QListWidget::currentItemChanged,
             this,        &MainWindow::onCommitSelected);
 
-    splitter->addWidget(commitList_);
+    leftLayout->addWidget(commitList_, 1);
+    splitter->addWidget(leftPanel);
 
     // -- Right: detail panel inside scroll area --
     auto* scrollArea   = new QScrollArea(this);
@@ -317,20 +358,87 @@ void MainWindow::loadRepo(const QString& dirPath, bool isNew)
 void MainWindow::refreshCommitList()
 {
     commitList_->clear();
+    listCursor_  = {};
+    listHasMore_ = false;
+    refreshDocumentFilter();
     if (!repo_) return;
 
-    auto        commits = repo_->ListCommits();
-    std::string head    = repo_->GetHead();
+    listHead_    = repo_->GetHead();
+    listHasMore_ = true;
+    appendCommitPage();
+
+    if (!listHead_.empty())
+        sbHeadLabel_->setText("HEAD: " +
+            QString::fromStdString(listHead_.substr(0, 8)));
+}
+
+// Rebuild the document choices, keeping the current one
+void MainWindow::refreshDocumentFilter()
+{
+    QSignalBlocker block(docFilter_);
+    docFilter_->clear();
+    docFilter_->addItem("All documents", QString());
+    if (!repo_) {
+        listDoc_.clear();
+        return;
+    }
+
+    int selected = 0;
+    for (const auto& d : repo_->ListDocuments()) {
+        QString path = QString::fromStdString(d.path);
+        QString name = QString::fromStdWString(fs::path(d.path).filename().wstring());
+        docFilter_->addItem(QString("%1  (%2)").arg(name).arg(d.commits), path);
+        docFilter_->setItemData(docFilter_->count() - 1, path, Qt::ToolTipRole);
+        if (d.path == listDoc_) selected = docFilter_->count() - 1;
+    }
+    if (selected == 0) listDoc_.clear();   // filtered file is gone (other repo)
+    docFilter_->setCurrentIndex(selected);
+}
+
+// Next kListPage commits after listCursor_ — the list never holds
+// more of the history than has been scrolled into view.  While
+// searching: the best kSearchLimit matches, in one go.
+void MainWindow::appendCommitPage()
+{
+    if (!repo_ || !listHasMore_) return;
+
+    CommitQuery query;
+    query.after    = listCursor_;
+    query.limit    = kListPage;
+    query.doc_path = listDoc_;
+
+    // The list needs four columns of each commit: summaries, read
+    // into one arena, unless searching (ranked Commits, few of them)
+    CommitSummaries page;
+    if (listSearch_.empty()) {
+        Result r     = repo_->ListCommitSummaries(query, page);
+        listHasMore_ = r.ok && page.rows.size() == kListPage;
+        if (!r.ok) statusBar()->showMessage(QString::fromStdString(r.err), 5000);
+    } else {
+        query.limit  = kSearchLimit;
+        listHasMore_ = false;
+        for (const auto& c : repo_->SearchCommits(listSearch_, query))
+            page.rows.push_back({c.time, page.strings.Add(c.hash), page.strings.Add(c.timestamp),
+                                 page.strings.Add(c.message), page.strings.Intern(c.author)});
+    }
+    BlobStore store(*repo_);   // thumbnails may be loose or packed
+    std::vector<char> thumb;
+
+    if (!page.rows.empty())
+        listCursor_ = page.rows.back().Cursor();
 
-    for (const auto& c : commits) {
-        bool isHead = (c.hash == head);
+    auto qstr = [](std::string_view s) {
+        return QString::fromUtf8(s.data(), static_cast<qsizetype>(s.size()));
+    };
+    for (const auto& c : page.rows) {
+        bool isHead = (c.hash == listHead_);
 
-        QString shortHash = QString::fromStdString(c.hash.substr(0, 8));
-        QString msg       = QString::fromStdString(c.message);
-        QString author    = QString::fromStdString(c.author);
+        QString shortHash = qstr(c.hash.substr(0, 8));
+        QString msg       = qstr(c.message);
+        QString author    = qstr(c.author);
 
         // "2025-02-17T14:32:00Z" → "2025-02-17  14:32"
-        QString ts = QString::fromStdString(c.timestamp);
+        QString ts = qstr(c.timestamp);
         if (ts.length() >= 16)
             ts = ts.left(10) + "  " + ts.mid(11, 5);
 
@@ -340,14 +448,14 @@ void MainWindow::refreshCommitList()
                         "    " + author;
 
         auto* item = new QListWidgetItem(label, commitList_);
-        item->setData(Qt::UserRole, QString::fromStdString(c.hash));
+        item->setData(Qt::UserRole, qstr(c.hash));
         item->setSizeHint(QSize(0, 84));
 
         // Thumbnail icon (64x64)
-        auto thumbPath = repo_->ThumbnailPath(c.hash);
-        if (fs::exists(thumbPath)) {
-            QPixmap pix(QString::fromStdWString(thumbPath.wstring()));
-            if (!pix.isNull()) {
+        if (store.ReadThumbnail(std::string(c.hash), thumb)) {
+            QPixmap pix;
+            if (pix.loadFromData(reinterpret_cast<const uchar*>(thumb.data()),
+                                 static_cast<uint>(thumb.size()))) {
                 item->setIcon(QIcon(
                     pix.scaled(64, 64, Qt::KeepAspectRatio,
                                Qt::SmoothTransformation)));
@@ -360,10 +468,6 @@ void MainWindow::refreshCommitList()
             item->setFont(f);
         }
     }
-
-    if (!head.empty())
-        sbHeadLabel_->setText("HEAD: " +
-            QString::fromStdString(head.substr(0, 8)));
 }
 
 // -------------------------------------------------------
@@ -393,10 +497,12 @@ void MainWindow::onCommitSelected(QListWidgetItem* current,
 void MainWindow::showCommitDetail(const Commit& c)
 {
     // Thumbnail
-    auto thumbPath = repo_->ThumbnailPath(c.hash);
-    if (fs::exists(thumbPath)) {
-        QPixmap pix(QString::fromStdWString(thumbPath.wstring()));
-        if (!pix.isNull()) {
+    BlobStore         store(*repo_);
+    std::vector<char> thumb;
+    if (store.ReadThumbnail(c.hash, thumb)) {
+        QPixmap pix;
+        if (pix.loadFromData(reinterpret_cast<const uchar*>(thumb.data()),
+                             static_cast<uint>(thumb.size()))) {
             thumbLabel_->setPixmap(
                 pix.scaled(256, 256, Qt::KeepAspectRatio,
                            Qt::SmoothTransformation));
@@ -413,7 +519,17 @@ void MainWindow::showCommitDetail(const Commit& c)
     hashLabel_  ->setText(QString::fromStdString(c.hash));
     authorLabel_->setText(QString::fromStdString(c.author));
     dateLabel_  ->setText(QString::fromStdString(c.timestamp));
-    fileLabel_  ->setText(QString::fromStdString(c.sw_meta.doc_path));
+    if (c.IsGroup()) {
+        // A group commit: name its files
+        QStringList files;
+        for (const auto& m : repo_->ListGroupMembers(c.hash))
+            files << QString::fromStdString(fs::path(m.sw_meta.doc_path).filename().string());
+        fileLabel_->setText(QString("%1 files: %2").arg(files.size()).arg(files.join(", ")));
+    } else if (c.IsTree()) {
+        fileLabel_->setText("Project snapshot of " + QString::fromStdString(c.sw_meta.doc_path));
+    } else {
+        fileLabel_->setText(QString::fromStdString(c.sw_meta.doc_path));
+    }
     typeLabel_  ->setText(QString::fromStdString(c.sw_meta.doc_type));
 
     materialLabel_->setText(c.sw_meta.material.empty()
@@ -425,11 +541,17 @@ void MainWindow::showCommitDetail(const Commit& c)
         : "--");
 
     if (c.sw_meta.blob_size_bytes > 0) {
-        double kb = c.sw_meta.blob_size_bytes / 1024.0;
-        double mb = kb / 1024.0;
-        blobSizeLabel_->setText(mb >= 1.0
-            ? QString::number(mb, 'f', 1) + " MB"
-            : QString::number(kb, 'f', 1) + " KB");
+        auto size_text = [](int64_t bytes) {
+            double kb = bytes / 1024.0;
+            double mb = kb / 1024.0;
+            return mb >= 1.0
+                ? QString::number(mb, 'f', 1) + " MB"
+                : QString::number(kb, 'f', 1) + " KB";
+        };
+        // Logical size, plus what the commit actually added on disk
+        // (compressed; 0 when every chunk was already stored)
+        blobSizeLabel_->setText(size_text(c.sw_meta.blob_size_bytes)
+            + " (" + size_text(c.sw_meta.stored_size_bytes) + " stored)");
     } else {
         blobSizeLabel_->setText("--");
     }
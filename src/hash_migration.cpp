@@ -0,0 +1,41 @@
+#include "hash_migration.h"
+#include "blob_store.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <iostream>
+
+HashMigration::HashMigration(Repository& repo)
+    : repo_(repo) {}
+
+Result HashMigration::Run(HashAlgo to) {
+    if (repo_.GetHashAlgo() == to)
+        return Result::failure(std::string("Repository already uses ") + HashAlgoName(to));
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[migrate] Rehashing objects with " << HashAlgoName(to)
+              << " on " << ThreadPool::Shared().Size() << " threads...\n";
+
+    // 1. Link every object under its new name
+    BlobStore  store(repo_);
+    RehashPlan plan;
+    Result r = store.Rehash(to, plan);
+    if (!r.ok) return r;
+
+    std::cout << "[migrate] " << plan.chunks << " chunks, "
+              << plan.snapshots.size() - plan.trees - plan.groups << " snapshots, "
+              << plan.trees << " trees, " << plan.groups << " group commits rehashed\n";
+
+    // 2. Switch the DB over in one transaction
+    r = repo_.RewriteHashes(plan.snapshots, to);
+    if (!r.ok) return r;
+
+    // 3. Old object names go away
+    store.DropOld(plan);
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[migrate] Repository now uses " << HashAlgoName(to)
+              << " (" << ms << " ms)\n";
+    return Result::success();
+}
@@ -0,0 +1,137 @@
+#include "import_engine.h"
+#include "repository.h"
+#include "blob_store.h"
+#include "stat_cache.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+
+namespace {
+
+struct Source {
+    fs::path    path;
+    std::string label;      // path relative to the directory it was found in
+    int64_t     mtime_ns = 0;
+};
+
+Result Collect(const std::vector<fs::path>& dirs, std::vector<Source>& out) {
+    for (const auto& dir : dirs) {
+        std::error_code ec;
+        if (!fs::is_directory(dir, ec))
+            return Result::failure("Not a directory: " + dir.string());
+
+        fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            const fs::path& p = it->path();
+            if (p.filename() == ".swvcs") {          // never import a repository's own store
+                it.disable_recursion_pending();
+                continue;
+            }
+            // ~$bracket.SLDPRT is the lock file SolidWorks keeps next to an open document
+            if (!it->is_regular_file(ec) || Utils::SwDocType(p.filename().string()).empty()
+                || p.filename().string().rfind("~$", 0) == 0)
+                continue;
+
+            FileStat st = StatCache::Stat(p);
+            if (!st.valid) return Result::failure("Cannot stat: " + p.string());
+            out.push_back({ p, p.lexically_relative(dir).string(), st.mtime_ns });
+        }
+        if (ec) return Result::failure("Cannot list " + dir.string() + ": " + ec.message());
+    }
+
+    std::sort(out.begin(), out.end(), [](const Source& a, const Source& b) {
+        return a.mtime_ns != b.mtime_ns ? a.mtime_ns < b.mtime_ns : a.path < b.path;
+    });
+    return Result::success();
+}
+
+} // namespace
+
+ImportEngine::ImportEngine(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Run
+// -------------------------------------------------------
+
+Result ImportEngine::Run(const std::vector<fs::path>& dirs, const ImportOptions& options,
+                         ImportStats& stats) {
+    stats = {};
+    std::vector<Source> sources;
+    Result r = Collect(dirs, sources);
+    if (!r.ok) return r;
+    stats.files = sources.size();
+    if (sources.empty()) return Result::success();
+
+    std::cout << "[import] " << sources.size() << " SolidWorks files, storing "
+              << std::max<size_t>(options.batch, 1) << " at a time on "
+              << ThreadPool::Shared().Size() << " threads...\n";
+
+    BlobStore   store(repo_);
+    std::string parent = repo_.GetHead();
+    std::string author = Utils::UserName();
+    std::unordered_set<std::string> committed;   // hashes saved by this import
+
+    const size_t batch = std::max<size_t>(options.batch, 1);
+    for (size_t first = 0; first < sources.size(); first += batch) {
+        const size_t n = std::min(batch, sources.size() - first);
+
+        // Hash and store in parallel — no delta base, so the files
+        // don't depend on each other and any order will do
+        std::vector<std::string> hashes(n);
+        std::vector<StoreStats>  stored(n);
+        std::vector<Result>      results(n);
+        ThreadPool::Shared().ParallelFor(n, [&](size_t i) {
+            results[i] = store.Store(sources[first + i].path, hashes[i], stored[i]);
+        });
+
+        std::vector<Commit> commits;
+        commits.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Source& src = sources[first + i];
+            if (!results[i].ok) return results[i];
+            stats.logical_bytes += stored[i].logical_bytes;
+            stats.written_bytes += stored[i].written_bytes;
+
+            // The same bytes twice (bracket_FINAL copied to
+            // bracket_FINAL2) would replace the earlier commit
+            if (committed.count(hashes[i]) || hashes[i] == parent) {
+                ++stats.duplicates;
+                continue;
+            }
+            Commit existing;
+            if (repo_.LoadCommit(hashes[i], existing).ok) {
+                ++stats.duplicates;
+                continue;
+            }
+
+            Commit c;
+            c.hash        = hashes[i];
+            c.message     = "Imported " + src.label;
+            c.timestamp   = Utils::FormatTimestamp(src.mtime_ns / 1'000'000'000);
+            c.parent_hash = parent;
+            c.author      = author;
+            c.sw_meta.doc_path = options.document.empty()
+                ? (repo_.ProjectDir() / src.path.filename()).string()
+                : options.document;
+            c.sw_meta.doc_type          = Utils::SwDocType(src.path.filename().string());
+            c.sw_meta.blob_size_bytes   = stored[i].logical_bytes;
+            c.sw_meta.stored_size_bytes = stored[i].written_bytes;
+            if (options.read_properties) options.read_properties(src.path, c);
+
+            committed.insert(c.hash);
+            parent = c.hash;
+            commits.push_back(std::move(c));
+        }
+
+        r = repo_.SaveCommits(commits, commits.empty() ? "" : parent);
+        if (!r.ok) return r;
+        stats.commits += commits.size();
+
+        std::cout << "[import] " << first + n << "/" << sources.size() << " files, "
+                  << stats.commits << " commits\n";
+    }
+    return Result::success();
+}
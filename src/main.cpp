@@ -2,12 +2,28 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <chrono>
+#include <csignal>
 
 #include "sw_connection.h"
 #include "repository.h"
 #include "commit_engine.h"
 #include "revert_engine.h"
+#include "hash_migration.h"
+#include "import_engine.h"
+#include "blob_store.h"
+#include "commit_graph.h"
+#include "stat_cache.h"
+#include "status_engine.h"
+#include "trend_cache.h"
+#include "tree_snapshot.h"
 #include "utils.h"
+#include "watch_engine.h"
 
 namespace fs = std::filesystem;
 
@@ -22,21 +38,80 @@ Usage:
   swvcs <command> [options]
 
 Commands:
-  init    [dir]          Initialise a repository in [dir] (default: current dir)
-  status                 Show HEAD commit and active document info
-  commit  <message>      Snapshot the active SolidWorks document
-  log     [--full]       List all commits (newest first)
-  revert  <hash>         Restore working file to a previous commit
+  init    [dir] [--hash <algo>]
+                         Initialise a repository in [dir] (default: current dir)
+                         algo: sha256 (default) or blake3
+  status                 Show HEAD, files changed since the last project snapshot
+                         and active document info
+  show    [<hash>]       Show every detail of one commit (default: HEAD)
+  commit  [--all-open] <message>
+                         Snapshot the active SolidWorks document;
+                         --all-open: every open document that changed,
+                         as one group commit
+  log     [--full] [--limit <n>] [--since <date>] [--first-parent] [<file>]
+                         List commits, newest first (date: YYYY-MM-DD or
+                         a full ISO-8601 time); --first-parent follows
+                         HEAD's parents only; <file> limits it to one
+                         document's history
+  search  <terms...> [--full] [--limit <n>]
+                         Find commits by words in their message, material
+                         or file name, best match first (default limit 20)
+  trend   <file> [--field <name>] [--threshold <pct>] [--since <date>] [--all]
+                         Summarise how a property of one document changed
+                         and list the commits that moved it by more than
+                         <pct> percent (default: mass, 5)
+                         name: mass, volume, surface_area, bbox_x, bbox_y,
+                               bbox_z, feature_count
+  merge-base <a> <b>     Print the newest commit both a and b descend from
+  merge-base --is-ancestor <a> <b>
+                         Exit 0 if a is an ancestor of b, 1 if not
+  snapshot <message>     Commit every SolidWorks file in the project folder
+                         as one project snapshot (only changed files are read)
+  watch   [--quiet <s>] [--interval <s>] [--queue <n>]
+                         Commit SolidWorks files in the project folder as
+                         they are saved, until Ctrl+C: a file is committed
+                         once it has gone <s> seconds without a write
+                         (default 3), at most once per interval (default
+                         300 s), with up to <n> files waiting (default 32)
+  revert  <hash>         Restore working file to a previous commit (a
+                         group commit or project snapshot restores each
+                         of its files)
+  import  <dir...> [--as <file>] [--batch <n>] [--properties]
+                         Commit every .SLDPRT/.SLDASM/.SLDDRW under the
+                         folders, oldest first, as versions of the file
+                         of the same name in this project (--as: all as
+                         versions of <file>); --properties opens each in
+                         SolidWorks to record mass, material, ...
+  migrate --hash <algo>  Rehash all snapshots and commits with another algorithm
+  repack                 Move loose objects and thumbnails into pack files
+  config  <key> [value]  Show or change a repository setting
+                         (compression_level 0-19, compression_long 0/1,
+                          delta_chain 0 = off / max deltas between full copies,
+                          delta_max_mb larger files are stored full (0 = no limit),
+                          storage chunked / full = reflinkable uncompressed copies)
 
 Examples:
   swvcs init C:\Projects\BracketDesign
   swvcs commit "Added fillet to top edge"
-  swvcs log
+  swvcs log --limit 10
+  swvcs log --since 2025-02-01
+  swvcs log --first-parent
+  swvcs log bracket.SLDPRT
+  swvcs search fillet "rev C"
+  swvcs trend bracket.SLDPRT --field mass --threshold 2
+  swvcs show a1b2c3d4
+  swvcs merge-base --is-ancestor a1b2c3d4 HEAD
   swvcs revert a1b2c3d4
+  swvcs watch --interval 600
+  swvcs import C:\Old\bracket_v1 C:\Old\bracket_v2 C:\Old\bracket_FINAL2
+  swvcs migrate --hash blake3
+  swvcs config compression_level 9
 
 Notes:
-  - SolidWorks must be running for commit and revert.
-  - A hash prefix of 7+ characters is sufficient for revert.
+  - SolidWorks must be running for commit, revert and import --properties.
+  - Any unique hash prefix of 4+ characters is sufficient for revert and show.
+  - log, status, show, search, trend and merge-base only read the repository
+    and connect to SolidWorks only when they need it (status).
 )";
 }
 
@@ -44,29 +119,82 @@ Notes:
 // Commands
 // -------------------------------------------------------
 
-static int CmdInit(const std::vector<std::string>& args) {
+// Parse "--hash <algo>" out of args; returns false on a bad value.
+static bool TakeHashOption(std::vector<std::string>& args, bool& given, HashAlgo& algo) {
+    given = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] != "--hash") continue;
+        if (i + 1 >= args.size() || !ParseHashAlgo(args[i + 1], algo)) {
+            std::cerr << "--hash expects 'sha256' or 'blake3'\n";
+            return false;
+        }
+        given = true;
+        args.erase(args.begin() + i, args.begin() + i + 2);
+        break;
+    }
+    return true;
+}
+
+static int CmdInit(std::vector<std::string> args) {
+    bool     hash_given = false;
+    HashAlgo algo       = HashAlgo::Sha256;
+    if (!TakeHashOption(args, hash_given, algo)) return 1;
+
     fs::path dir = args.empty() ? fs::current_path() : fs::path(args[0]);
     Repository repo(dir);
     if (!repo.IsValid()) {
         std::cerr << "Failed to initialise repository at: " << dir.string() << "\n";
         return 1;
     }
-    std::cout << "Initialised swvcs repository at: " << repo.Root().string() << "\n";
+    if (hash_given && repo.GetHashAlgo() != algo) {
+        Result r = repo.SetHashAlgo(algo);
+        if (!r.ok) {
+            std::cerr << r.err << "\n";
+            return 1;
+        }
+    }
+    std::cout << "Initialised swvcs repository at: " << repo.Root().string()
+              << " (" << HashAlgoName(repo.GetHashAlgo()) << ")\n";
     return 0;
 }
 
 static int CmdStatus(const std::vector<std::string>& args, Repository& repo, SwConnection& sw) {
     std::string head = repo.GetHead();
+    Commit      c;
     if (head.empty()) {
         std::cout << "No commits yet.\n";
     } else {
-        Commit c;
         if (repo.LoadCommit(head, c).ok) {
             std::cout << "HEAD: " << head.substr(0,8) << " \"" << c.message << "\"\n"
                       << "Date: " << c.timestamp << "\n\n";
         }
     }
 
+    // The project folder against its newest snapshot: a stat() per
+    // file, and a read only where the stat cache can't vouch for one
+    auto            t0 = std::chrono::steady_clock::now();
+    WorkspaceStatus ws;
+    Result          r = StatusEngine(repo).Run(ws);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (!r.ok) {
+        std::cerr << "Project folder: " << r.err << "\n\n";
+    } else if (!ws.have_snapshot) {
+        std::cout << "Project folder: " << ws.files << " SolidWorks files, no project snapshot yet\n"
+                  << "  ('swvcs snapshot <message>' takes one)\n\n";
+    } else {
+        std::cout << "Project folder (against snapshot " << ws.snapshot.hash.substr(0,8)
+                  << ", " << ws.snapshot.timestamp << "):\n";
+        for (const auto& ch : ws.changes) {
+            const char* kind = ch.kind == FileChange::Kind::Modified ? "modified: "
+                             : ch.kind == FileChange::Kind::New      ? "new:      "
+                                                                     : "deleted:  ";
+            std::cout << "  " << kind << ch.path << "\n";
+        }
+        if (ws.changes.empty()) std::cout << "  no changes\n";
+        std::cout << "  " << ws.files << " files, " << ws.hashed << " read in " << ms << " ms\n\n";
+    }
+
     if (!sw.IsConnected()) {
         std::cout << "SolidWorks: not connected\n";
         return 0;
@@ -82,13 +210,102 @@ static int CmdStatus(const std::vector<std::string>& args, Repository& repo, SwC
               << "  Path:  " << info.path  << "\n"
               << "  Type:  " << info.type  << "\n"
               << "  Dirty: " << (info.is_dirty ? "yes (unsaved changes)" : "no") << "\n";
+
+    // Compare the saved file with HEAD — the stat cache answers
+    // without reading it unless it changed since it was last hashed
+    if (!head.empty() && Utils::IEquals(c.sw_meta.doc_path, info.path)) {
+        StatCache   cache(repo);
+        std::string hash;
+        bool        cached = false;
+        if (cache.Hash(info.path, hash, cached).ok)
+            std::cout << "  Saved file: " << (hash == head ? "same as HEAD" : "modified since HEAD")
+                      << "\n";
+    }
+    return 0;
+}
+
+static int CmdShow(const std::vector<std::string>& args, Repository& repo) {
+    if (args.size() > 1) {
+        std::cerr << "Usage: swvcs show [<hash>]\n";
+        return 1;
+    }
+    std::string ref = args.empty() || args[0] == "HEAD" ? repo.GetHead() : args[0];
+    if (ref.empty()) {
+        std::cout << "No commits yet.\n";
+        return 0;
+    }
+    Commit c;
+    Result r = repo.LoadCommit(ref, c);
+    if (!r.ok) {
+        std::cerr << r.err << "\n";
+        return 1;
+    }
+
+    const Commit::SwMeta& m = c.sw_meta;
+    std::cout << "commit    " << c.hash << (c.hash == repo.GetHead() ? "  (HEAD)" : "") << "\n"
+              << "Parent:   " << (c.parent_hash.empty() ? "(none)" : c.parent_hash) << "\n"
+              << "Author:   " << c.author    << "\n"
+              << "Date:     " << c.timestamp << "\n";
+    if (c.IsGroup()) {
+        auto members = repo.ListGroupMembers(c.hash);
+        std::cout << "Files:    " << members.size() << " in this group commit\n";
+        for (const auto& member : members)
+            std::cout << "  " << member.hash.substr(0,8) << "  " << member.sw_meta.doc_path
+                      << " (" << member.sw_meta.doc_type << ")\n";
+        std::cout << "Size:     " << Utils::FormatBytes(static_cast<uintmax_t>(m.blob_size_bytes))
+                  << " (" << Utils::FormatBytes(static_cast<uintmax_t>(m.stored_size_bytes))
+                  << " new in store)\n"
+                  << "\n    " << c.message << "\n";
+        return 0;
+    }
+    if (c.IsTree()) {
+        BlobStore store(repo);
+        Tree      tree;
+        r = store.LoadTree(c.hash, tree);
+        if (!r.ok) {
+            std::cerr << r.err << "\n";
+            return 1;
+        }
+        std::cout << "Project:  " << m.doc_path << " (" << tree.size() << " files)\n";
+        for (const auto& e : tree)
+            std::cout << "  " << e.hash.substr(0,8) << "  " << std::setw(10)
+                      << Utils::FormatBytes(static_cast<uintmax_t>(e.size)) << "  " << e.path << "\n";
+        std::cout << "Size:     " << Utils::FormatBytes(static_cast<uintmax_t>(m.blob_size_bytes))
+                  << " (" << Utils::FormatBytes(static_cast<uintmax_t>(m.stored_size_bytes))
+                  << " new in store)\n"
+                  << "\n    " << c.message << "\n";
+        return 0;
+    }
+    std::cout << "File:     " << m.doc_path  << " (" << m.doc_type << ")\n";
+    if (!c.group_hash.empty())
+        std::cout << "Group:    " << c.group_hash << "\n";
+    if (!m.material.empty())
+        std::cout << "Material: " << m.material << "\n";
+    std::cout << std::fixed << std::setprecision(4);
+    if (m.mass > 0 || m.volume > 0)
+        std::cout << "Mass:     " << m.mass << " kg\n"
+                  << "Volume:   " << m.volume << " m^3\n";
+    if (m.surface_area > 0)
+        std::cout << "Surface:  " << m.surface_area << " m^2\n";
+    if (m.bbox_x > 0 || m.bbox_y > 0 || m.bbox_z > 0)
+        std::cout << std::setprecision(2)
+                  << "Bbox:     " << m.bbox_x << " x " << m.bbox_y << " x " << m.bbox_z << " mm\n";
+    if (m.feature_count > 0)
+        std::cout << "Features: " << m.feature_count << "\n";
+    if (m.config_count > 0)
+        std::cout << "Configs:  " << m.config_count << "\n";
+    std::cout << "Size:     " << Utils::FormatBytes(static_cast<uintmax_t>(m.blob_size_bytes))
+              << " (" << Utils::FormatBytes(static_cast<uintmax_t>(m.stored_size_bytes))
+              << " new in store)\n"
+              << "\n    " << c.message << "\n";
     return 0;
 }
 
 static int CmdCommit(const std::vector<std::string>& args,
                      Repository& repo, SwConnection& sw) {
-    if (args.empty()) {
-        std::cerr << "Usage: swvcs commit <message>\n";
+    bool all_open = !args.empty() && args[0] == "--all-open";
+    if (args.size() <= (all_open ? 1u : 0u)) {
+        std::cerr << "Usage: swvcs commit [--all-open] <message>\n";
         return 1;
     }
 
@@ -99,13 +316,13 @@ static int CmdCommit(const std::vector<std::string>& args,
 
     // Join all remaining args as the message (handles spaces without quotes)
     std::string message;
-    for (size_t i = 0; i < args.size(); ++i) {
-        if (i > 0) message += " ";
+    for (size_t i = all_open ? 1 : 0; i < args.size(); ++i) {
+        if (!message.empty()) message += " ";
         message += args[i];
     }
 
     CommitEngine engine(repo, sw);
-    Result r = engine.Commit(message);
+    Result r = all_open ? engine.CommitAllOpen(message) : engine.Commit(message);
     if (!r.ok) {
         std::cerr << "Commit failed: " << r.err << "\n";
         return 1;
@@ -114,19 +331,80 @@ static int CmdCommit(const std::vector<std::string>& args,
 }
 
 static int CmdLog(const std::vector<std::string>& args, Repository& repo) {
-    bool full = !args.empty() && args[0] == "--full";
-    auto commits = repo.ListCommits();
-
-    if (commits.empty()) {
-        std::cout << "No commits yet.\n";
-        return 0;
+    bool        full         = false;
+    bool        first_parent = false;
+    std::string since;
+    CommitQuery query;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--full") {
+            full = true;
+        } else if (args[i] == "--first-parent") {
+            first_parent = true;
+        } else if (args[i] == "--limit" && i + 1 < args.size()) {
+            int n = std::atoi(args[++i].c_str());
+            if (n <= 0) {
+                std::cerr << "--limit expects a positive number\n";
+                return 1;
+            }
+            query.limit = static_cast<size_t>(n);
+        } else if (args[i] == "--since" && i + 1 < args.size()) {
+            since = args[++i];
+            if (!Utils::ParseTimestamp(since, query.since)) {
+                std::cerr << "--since expects a date like 2025-02-01 or 2025-02-01T09:30:00Z\n";
+                return 1;
+            }
+        } else if (args[i].rfind("--", 0) != 0 && query.doc_path.empty()) {
+            // Commits store absolute paths, as SolidWorks reports them
+            std::error_code ec;
+            fs::path abs = fs::absolute(args[i], ec);
+            query.doc_path = (ec ? fs::path(args[i]) : abs).string();
+        } else {
+            std::cerr << "Usage: swvcs log [--full] [--limit <n>] [--since <date>] "
+                         "[--first-parent] [<file>]\n";
+            return 1;
+        }
     }
 
-    std::string head = repo.GetHead();
-    for (const auto& c : commits) {
+    // Streamed: each commit is printed as soon as it is read
+    std::string head  = repo.GetHead();
+    size_t      shown = 0;
+    auto print = [&](const Commit& c) {
         if (c.hash == head) std::cout << "* ";
         else                std::cout << "  ";
         Utils::PrintCommit(c, full);
+        ++shown;
+    };
+
+    Result r = Result::success();
+    if (first_parent) {
+        // HEAD, its parent, its parent's parent ... — commits left
+        // behind by a revert aren't on this line
+        CommitGraph graph(repo);
+        std::string doc_key = query.doc_path.empty() ? "" : Repository::DocumentKey(query.doc_path);
+        r = graph.Load();
+        for (auto id = graph.Find(head); r.ok && id != CommitGraph::kNone; id = graph.Parent(id)) {
+            if (query.limit > 0 && shown == query.limit) break;
+            if (graph.Time(id) < query.since) break;
+            Commit c;
+            r = repo.LoadCommit(graph.Hash(id), c);
+            if (r.ok && (doc_key.empty() || Repository::DocumentKey(c.sw_meta.doc_path) == doc_key))
+                print(c);
+        }
+    } else {
+        r = repo.ForEachCommit(query, [&](const Commit& c) {
+            print(c);
+            return true;
+        });
+    }
+    if (!r.ok) {
+        std::cerr << "Log failed: " << r.err << "\n";
+        return 1;
+    }
+
+    if (shown == 0) {
+        std::string of = query.doc_path.empty() ? "" : " of " + query.doc_path;
+        std::cout << (since.empty() ? "No commits" + of + " yet.\n"
+                                    : "No commits" + of + " since " + since + ".\n");
     }
     return 0;
 }
@@ -157,6 +435,420 @@ static int CmdRevert(const std::vector<std::string>& args,
     return 0;
 }
 
+static int CmdImport(const std::vector<std::string>& args, Repository& repo) {
+    std::vector<fs::path> dirs;
+    ImportOptions         options;
+    bool                  properties = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--properties") {
+            properties = true;
+        } else if (args[i] == "--as" && i + 1 < args.size()) {
+            std::error_code ec;
+            fs::path abs = fs::absolute(args[++i], ec);
+            options.document = (ec ? fs::path(args[i]) : abs).string();
+        } else if (args[i] == "--batch" && i + 1 < args.size()) {
+            int n = std::atoi(args[++i].c_str());
+            if (n <= 0) {
+                std::cerr << "--batch expects a positive number\n";
+                return 1;
+            }
+            options.batch = static_cast<size_t>(n);
+        } else if (args[i].rfind("--", 0) != 0) {
+            dirs.emplace_back(args[i]);
+        } else {
+            dirs.clear();
+            break;
+        }
+    }
+    if (dirs.empty()) {
+        std::cerr << "Usage: swvcs import <dir...> [--as <file>] [--batch <n>] [--properties]\n";
+        return 1;
+    }
+
+    // Opening each old version in SolidWorks is the slow part of an
+    // import, so it is only done on request
+    SwConnection sw;
+    if (properties) {
+        if (sw.Connect() != SwConnectStatus::OK) {
+            std::cerr << "SolidWorks must be running for --properties.\n";
+            return 1;
+        }
+        options.read_properties = [&](const fs::path& file, Commit& c) {
+            ActiveDocInfo info;
+            Result r = sw.OpenDoc(file.string());
+            if (!r.ok || !sw.GetActiveDocInfo(info).ok) {
+                std::cerr << "[import] No properties for " << file.string() << "\n";
+                return;
+            }
+            auto& m = c.sw_meta;
+            sw.GetMassProperties(m.mass, m.volume, m.surface_area);
+            sw.GetFeatureCount(m.feature_count);
+            sw.GetMaterial(m.material);
+            sw.GetBoundingBox(m.bbox_x, m.bbox_y, m.bbox_z);
+            sw.GetConfigCount(m.config_count);
+            sw.SaveThumbnail(repo.ThumbnailPath(c.hash).string());
+            sw.CloseActiveDoc(/*force_close=*/true);
+        };
+    }
+
+    ImportEngine engine(repo);
+    ImportStats  stats;
+    Result       r = engine.Run(dirs, options, stats);
+    std::cout << "Imported " << stats.commits << " of " << stats.files << " files ("
+              << stats.duplicates << " duplicates skipped), "
+              << Utils::FormatBytes(static_cast<uintmax_t>(stats.logical_bytes)) << " read, "
+              << Utils::FormatBytes(static_cast<uintmax_t>(stats.written_bytes)) << " stored\n";
+    if (!r.ok) {
+        std::cerr << "Import failed: " << r.err << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int CmdSnapshot(const std::vector<std::string>& args, Repository& repo) {
+    if (args.empty()) {
+        std::cerr << "Usage: swvcs snapshot <message>\n";
+        return 1;
+    }
+    std::string message;
+    for (const auto& a : args) {
+        if (!message.empty()) message += " ";
+        message += a;
+    }
+
+    auto         t0 = std::chrono::steady_clock::now();
+    TreeSnapshot snapshot(repo);
+    TreeStats    stats;
+    Result       r = snapshot.Commit(message, stats);
+    if (!r.ok) {
+        std::cerr << "Snapshot failed: " << r.err << "\n";
+        return 1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Snapshot " << repo.GetHead().substr(0,8) << " \"" << message << "\": "
+              << stats.files << " files, " << stats.hashed << " read ("
+              << Utils::FormatBytes(static_cast<uintmax_t>(stats.written_bytes)) << " stored) in "
+              << ms << " ms\n";
+    return 0;
+}
+
+// The running watch, for Ctrl+C
+static WatchEngine* g_watch = nullptr;
+
+static void StopWatch(int) {
+    if (g_watch) g_watch->Stop();
+}
+
+static int CmdWatch(const std::vector<std::string>& args, Repository& repo) {
+    WatchOptions options;
+    for (size_t i = 0; i < args.size(); ++i) {
+        int n = i + 1 < args.size() ? std::atoi(args[i + 1].c_str()) : -1;
+        if (args[i] == "--quiet" && n >= 0) {
+            options.debounce_ms = n * 1000;
+        } else if (args[i] == "--interval" && n >= 0) {
+            options.interval_s = n;
+        } else if (args[i] == "--queue" && n > 0) {
+            options.max_queue = static_cast<size_t>(n);
+        } else {
+            std::cerr << "Usage: swvcs watch [--quiet <seconds>] [--interval <seconds>] [--queue <n>]\n";
+            return 1;
+        }
+        ++i;
+    }
+
+    WatchEngine engine(repo);
+    WatchStats  stats;
+    g_watch = &engine;
+    std::signal(SIGINT, StopWatch);
+    std::signal(SIGTERM, StopWatch);
+    Result r = engine.Run(options, stats);
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    g_watch = nullptr;
+
+    std::cout << "Watch stopped: " << stats.commits << " commits, " << stats.unchanged
+              << " saves without changes";
+    if (stats.failed) std::cout << ", " << stats.failed << " failed";
+    std::cout << "\n";
+    if (!r.ok) {
+        std::cerr << "Watch failed: " << r.err << "\n";
+        return 1;
+    }
+    return stats.failed ? 1 : 0;
+}
+
+static int CmdMigrate(std::vector<std::string> args, Repository& repo) {
+    bool     hash_given = false;
+    HashAlgo algo       = HashAlgo::Sha256;
+    if (!TakeHashOption(args, hash_given, algo)) return 1;
+    if (!hash_given) {
+        std::cerr << "Usage: swvcs migrate --hash <sha256|blake3>\n";
+        return 1;
+    }
+
+    HashMigration migration(repo);
+    Result r = migration.Run(algo);
+    if (!r.ok) {
+        std::cerr << "Migration failed: " << r.err << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int CmdConfig(const std::vector<std::string>& args, Repository& repo) {
+    // Keys swvcs manages itself (HEAD, version, hash_algo) aren't editable here
+    static const std::vector<std::string> kSettings = {
+        "compression_level", "compression_long", "delta_chain", "delta_max_mb", "storage"
+    };
+
+    if (args.empty()) {
+        for (const auto& key : kSettings)
+            std::cout << key << " = " << repo.GetConfig(key) << "\n";
+        return 0;
+    }
+    if (std::find(kSettings.begin(), kSettings.end(), args[0]) == kSettings.end()) {
+        std::cerr << "Unknown setting: " << args[0] << "\n";
+        return 1;
+    }
+    if (args.size() == 1) {
+        std::cout << repo.GetConfig(args[0]) << "\n";
+        return 0;
+    }
+    if (args[0] == "storage" && args[1] != "chunked" && args[1] != "full") {
+        std::cerr << "storage expects 'chunked' or 'full'\n";
+        return 1;
+    }
+
+    Result r = repo.SetConfig(args[0], args[1]);
+    if (!r.ok) {
+        std::cerr << "Config failed: " << r.err << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int CmdSearch(const std::vector<std::string>& args, Repository& repo) {
+    bool        full = false;
+    std::string text;
+    CommitQuery query;
+    query.limit = 20;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--full") {
+            full = true;
+        } else if (args[i] == "--limit" && i + 1 < args.size()) {
+            int n = std::atoi(args[++i].c_str());
+            if (n <= 0) {
+                std::cerr << "--limit expects a positive number\n";
+                return 1;
+            }
+            query.limit = static_cast<size_t>(n);
+        } else {
+            // An argument the shell kept together is one phrase
+            bool phrase = args[i].find(' ') != std::string::npos;
+            if (!text.empty()) text += ' ';
+            text += phrase ? '"' + args[i] + '"' : args[i];
+        }
+    }
+    if (text.empty()) {
+        std::cerr << "Usage: swvcs search <terms...> [--full] [--limit <n>]\n";
+        return 1;
+    }
+
+    std::string head    = repo.GetHead();
+    auto        commits = repo.SearchCommits(text, query);
+    for (const auto& c : commits) {
+        std::cout << (c.hash == head ? "* " : "  ");
+        Utils::PrintCommit(c, full);
+    }
+    if (commits.empty())
+        std::cout << "No commits match: " << text << "\n";
+    return 0;
+}
+
+static int CmdTrend(const std::vector<std::string>& args, Repository& repo) {
+    Metric      metric    = Metric::Mass;
+    double      threshold = 5.0;   // percent
+    bool        all       = false;
+    int64_t     since     = 0;
+    std::string since_arg, file;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--all") {
+            all = true;
+        } else if (args[i] == "--field" && i + 1 < args.size()) {
+            if (!ParseMetric(args[++i], metric)) {
+                std::cerr << "Unknown field: " << args[i] << " (mass, volume, surface_area, "
+                             "bbox_x, bbox_y, bbox_z, feature_count)\n";
+                return 1;
+            }
+        } else if (args[i] == "--threshold" && i + 1 < args.size()) {
+            char* end = nullptr;
+            threshold = std::strtod(args[++i].c_str(), &end);
+            if (end == args[i].c_str() || *end != '\0' || threshold < 0) {
+                std::cerr << "--threshold expects a percentage, e.g. 5 or 0.5\n";
+                return 1;
+            }
+        } else if (args[i] == "--since" && i + 1 < args.size()) {
+            since_arg = args[++i];
+            if (!Utils::ParseTimestamp(since_arg, since)) {
+                std::cerr << "--since expects a date like 2025-02-01 or 2025-02-01T09:30:00Z\n";
+                return 1;
+            }
+        } else if (args[i].rfind("--", 0) != 0 && file.empty()) {
+            std::error_code ec;
+            fs::path abs = fs::absolute(args[i], ec);
+            file = (ec ? fs::path(args[i]) : abs).string();
+        } else {
+            file.clear();
+            break;
+        }
+    }
+    if (file.empty()) {
+        std::cerr << "Usage: swvcs trend <file> [--field <name>] [--threshold <pct>] "
+                     "[--since <date>] [--all]\n";
+        return 1;
+    }
+
+    TrendCache  trends(repo);
+    TrendReport report;
+    Result r = trends.Analyse(file, metric, threshold / 100.0, since, report);
+    if (!r.ok) {
+        std::cerr << "Trend failed: " << r.err << "\n";
+        return 1;
+    }
+    const char* name = MetricName(metric);
+    if (report.steps.empty()) {
+        std::cout << "No commits of " << file << " with a " << name << " value"
+                  << (since_arg.empty() ? "" : " since " + since_arg) << ".\n";
+        return 0;
+    }
+
+    std::string unit = MetricUnit(metric);
+    if (!unit.empty()) unit = " " + unit;
+    auto value = [&](double v) {
+        char buf[32];
+        std::snprintf(buf, sizeof buf, metric == Metric::FeatureCount ? "%.0f" : "%.4f", v);
+        return std::string(buf);
+    };
+    // Relative change, or the absolute one from a zero value (where
+    // a percentage would print inf% or nan%)
+    auto percent = [&](double from, double to) {
+        if (from == 0.0) {
+            std::string v = value(to - from);
+            return (to >= from ? "+" : "") + v + unit;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%+.1f%%", (to / from - 1.0) * 100.0);
+        return std::string(buf);
+    };
+    auto line = [&](const char* label, const TrendStep& s) {
+        std::printf("  %-6s %s  %.8s  %s%s\n", label, Utils::FormatDate(s.time).c_str(),
+                    s.hash.c_str(), value(s.value).c_str(), unit.c_str());
+    };
+
+    const auto& steps = report.steps;
+    std::cout << name << " of " << file << ", " << steps.size() << " commit"
+              << (steps.size() == 1 ? "" : "s")
+              << (since_arg.empty() ? "" : " since " + since_arg) << "\n\n";
+    line("first", steps.front());
+    line("last",  steps.back());
+    line("min",   steps[report.min]);
+    line("max",   steps[report.max]);
+    std::cout << "  overall " << percent(steps.front().value, steps.back().value) << "\n";
+
+    if (all) {
+        std::cout << "\nAll commits:\n";
+        for (size_t i = 0; i < steps.size(); ++i) {
+            const TrendStep& s = steps[i];
+            std::printf("  %s  %.8s  %s%s  %s\n", Utils::FormatDate(s.time).c_str(),
+                        s.hash.c_str(), value(s.value).c_str(), unit.c_str(),
+                        percent(i == 0 ? s.value : steps[i - 1].value, s.value).c_str());
+        }
+    }
+
+    std::cout << "\nChanges over " << threshold << "%:";
+    if (report.regressions.empty()) std::cout << " none";
+    std::cout << "\n";
+    for (size_t i : report.regressions) {
+        const TrendStep& s = steps[i];
+        Commit c;
+        repo.LoadCommit(s.hash, c);   // message only; blank if it can't be read
+        std::printf("  %s  %.8s  %s -> %s%s  %s  %s\n", Utils::FormatDate(s.time).c_str(),
+                    s.hash.c_str(), value(steps[i - 1].value).c_str(), value(s.value).c_str(),
+                    unit.c_str(), percent(steps[i - 1].value, s.value).c_str(), c.message.c_str());
+    }
+    return 0;
+}
+
+// "HEAD" or a hash prefix -> commit-graph id
+static bool ResolveCommit(const std::string& arg, Repository& repo, const CommitGraph& graph,
+                          CommitGraph::Id& id) {
+    std::string hash = arg == "HEAD" ? repo.GetHead() : "";
+    if (hash.empty()) {
+        Commit c;
+        Result r = repo.LoadCommit(arg, c);
+        if (!r.ok) {
+            std::cerr << r.err << "\n";
+            return false;
+        }
+        hash = c.hash;
+    }
+    id = graph.Find(hash);
+    if (id == CommitGraph::kNone) {
+        std::cerr << "No commit found matching: " << arg << "\n";
+        return false;
+    }
+    return true;
+}
+
+static int CmdMergeBase(std::vector<std::string> args, Repository& repo) {
+    bool is_ancestor = !args.empty() && args[0] == "--is-ancestor";
+    if (is_ancestor) args.erase(args.begin());
+    if (args.size() != 2) {
+        std::cerr << "Usage: swvcs merge-base [--is-ancestor] <a> <b>\n";
+        return 1;
+    }
+
+    CommitGraph graph(repo);
+    Result r = graph.Load();
+    if (!r.ok) {
+        std::cerr << "Cannot read commit graph: " << r.err << "\n";
+        return 1;
+    }
+    CommitGraph::Id a, b;
+    if (!ResolveCommit(args[0], repo, graph, a) || !ResolveCommit(args[1], repo, graph, b))
+        return 1;
+
+    if (is_ancestor)
+        return graph.IsAncestor(a, b) ? 0 : 1;
+
+    CommitGraph::Id base = graph.MergeBase(a, b);
+    if (base == CommitGraph::kNone) {
+        std::cerr << "No common ancestor.\n";
+        return 1;
+    }
+    std::cout << graph.Hash(base) << "\n";
+    return 0;
+}
+
+static int CmdRepack(Repository& repo) {
+    BlobStore   store(repo);
+    RepackStats stats;
+    Result r = store.Repack(stats);
+    if (!r.ok) {
+        std::cerr << "Repack failed: " << r.err << "\n";
+        return 1;
+    }
+    if (stats.objects == 0) {
+        std::cout << "[repack] Nothing to pack.\n";
+        return 0;
+    }
+    std::cout << "[repack] Packed " << stats.objects << " objects ("
+              << Utils::FormatBytes(static_cast<uintmax_t>(stats.bytes)) << ") into "
+              << stats.packs << " pack file" << (stats.packs == 1 ? "" : "s") << "\n";
+    return 0;
+}
+
 // -------------------------------------------------------
 // main
 // -------------------------------------------------------
@@ -181,33 +873,53 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // Commands that only read history open the database read-only:
+    // nothing is created or upgraded and no write lock is taken
+    const bool query = cmd == "log" || cmd == "status" || cmd == "show" || cmd == "search"
+                    || cmd == "trend" || cmd == "merge-base";
+    const bool write = cmd == "commit" || cmd == "revert" || cmd == "import" || cmd == "migrate"
+                    || cmd == "repack" || cmd == "config" || cmd == "snapshot" || cmd == "watch";
+    if (!query && !write) {
+        std::cerr << "Unknown command: " << cmd << "\n";
+        PrintHelp();
+        return 1;
+    }
+
     // All other commands need a repo in the current directory
-    Repository repo(fs::current_path());
-    if (!repo.IsValid()) {
-        std::cerr << "No swvcs repository found in: " << fs::current_path().string()
+    fs::path dir = fs::current_path();
+    if (!Repository::Exists(dir)) {
+        std::cerr << "No swvcs repository found in: " << dir.string()
                   << "\nRun 'swvcs init' first.\n";
         return 1;
     }
-
-    // Try to connect to SolidWorks (non-fatal — log/status can work offline)
-    SwConnection sw;
-    SwConnectStatus sw_status = sw.Connect();
-    if (sw_status != SwConnectStatus::OK) {
-        if (cmd == "commit" || cmd == "revert") {
-            std::cerr << "SolidWorks must be running for '" << cmd << "'.\n";
-            return 1;
-        }
-        std::cout << "[swvcs] Note: SolidWorks not running — some features unavailable.\n\n";
+    auto repo = std::make_unique<Repository>(dir, query ? OpenMode::ReadOnly : OpenMode::ReadWrite);
+    if (repo->NeedsUpgrade())   // older schema: this one open upgrades it
+        repo = std::make_unique<Repository>(dir);
+    if (!repo->IsValid()) {
+        std::cerr << "Cannot open the swvcs repository in: " << dir.string() << "\n";
+        return 1;
     }
 
-    // Dispatch command
-    if      (cmd == "status") return CmdStatus(args, repo, sw);
-    else if (cmd == "commit") return CmdCommit(args, repo, sw);
-    else if (cmd == "log")    return CmdLog(args, repo);
-    else if (cmd == "revert") return CmdRevert(args, repo, sw);
-    else {
-        std::cerr << "Unknown command: " << cmd << "\n";
-        PrintHelp();
+    if (cmd == "log")        return CmdLog(args, *repo);
+    if (cmd == "show")       return CmdShow(args, *repo);
+    if (cmd == "search")     return CmdSearch(args, *repo);
+    if (cmd == "trend")      return CmdTrend(args, *repo);
+    if (cmd == "merge-base") return CmdMergeBase(args, *repo);
+    if (cmd == "import")     return CmdImport(args, *repo);
+    if (cmd == "snapshot")   return CmdSnapshot(args, *repo);
+    if (cmd == "watch")      return CmdWatch(args, *repo);
+    if (cmd == "migrate")    return CmdMigrate(args, *repo);
+    if (cmd == "repack")     return CmdRepack(*repo);
+    if (cmd == "config")     return CmdConfig(args, *repo);
+
+    // status, commit and revert talk to SolidWorks — the COM
+    // connection is made here, for them only
+    SwConnection sw;
+    if (sw.Connect() != SwConnectStatus::OK && cmd != "status") {
+        std::cerr << "SolidWorks must be running for '" << cmd << "'.\n";
         return 1;
     }
+    if (cmd == "status") return CmdStatus(args, *repo, sw);
+    if (cmd == "commit") return CmdCommit(args, *repo, sw);
+    return CmdRevert(args, *repo, sw);
 }
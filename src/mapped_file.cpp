@@ -0,0 +1,100 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const fs::path& path) {
+    Close();
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);   // the mapping keeps the file open
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    data_    = static_cast<const uint8_t*>(view);
+    size_    = static_cast<size_t>(size.QuadPart);
+    mapping_ = mapping;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+    data_    = nullptr;
+    size_    = 0;
+    mapping_ = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const fs::path& path) {
+    Close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps the file open
+    if (view == MAP_FAILED) return false;
+
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
@@ -0,0 +1,360 @@
+#include "pack_set.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char     kIndexMagic[8] = { 'S', 'W', 'V', 'C', 'S', 'I', 'D', 'X' };
+constexpr char     kPackMagic[8]  = { 'S', 'W', 'V', 'C', 'S', 'P', 'A', 'K' };
+constexpr uint32_t kVersion       = 1;
+
+constexpr size_t kHeaderSize  = 16;
+constexpr size_t kFanoutSize  = 256 * 4;
+constexpr size_t kEntriesAt   = kHeaderSize + kFanoutSize;
+constexpr size_t kEntrySize   = 56;
+constexpr size_t kKeySize     = 33;   // hash[32] + kind
+constexpr size_t kPackHeader  = 16;
+
+using Key = std::array<uint8_t, kKeySize>;
+
+uint32_t GetLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+uint64_t GetLE64(const uint8_t* p) {
+    return uint64_t(GetLE32(p)) | uint64_t(GetLE32(p + 4)) << 32;
+}
+
+void PutLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+void PutLE64(std::string& out, uint64_t v) {
+    PutLE32(out, static_cast<uint32_t>(v));
+    PutLE32(out, static_cast<uint32_t>(v >> 32));
+}
+
+bool MakeKey(ObjectKind kind, const std::string& hash, Key& key) {
+    if (!Utils::FromHex(hash, key.data(), 32)) return false;
+    key[32] = static_cast<uint8_t>(kind);
+    return true;
+}
+
+// Flush a file, or a directory's entries, to disk.  Repack deletes
+// the loose copies right after writing packs, so the packs must be
+// on disk first.  NTFS journals renames itself: directories are a
+// no-op on Windows.
+bool SyncPath(const fs::path& path) {
+#ifdef _WIN32
+    if (fs::is_directory(path)) return true;
+    HANDLE h = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    bool ok = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+// A fanout never decreases and ends at count; anything else would
+// send Find() past the entries
+bool FanoutOk(const uint8_t* fanout, uint32_t count) {
+    uint32_t prev = 0;
+    for (int b = 0; b < 256; ++b) {
+        uint32_t v = GetLE32(fanout + b * 4);
+        if (v < prev || v > count) return false;
+        prev = v;
+    }
+    return prev == count;
+}
+
+std::string NewPackId() {
+    std::mt19937_64 rng{std::random_device{}()};
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(rng()));
+    return id;
+}
+
+// Write one pack (+ index) holding objects[begin, end)
+Result WritePack(const fs::path& dir, const std::vector<PackInput>& objects,
+                 size_t begin, size_t end) {
+    std::string id         = NewPackId();
+    fs::path    pack_path  = dir / ("pack-" + id + ".pack");
+    fs::path    index_path = dir / ("pack-" + id + ".idx");
+    fs::path    pack_tmp   = pack_path;  pack_tmp  += ".tmp";
+    fs::path    index_tmp  = index_path; index_tmp += ".tmp";
+
+    struct Entry {
+        Key      key;
+        uint64_t offset;
+        uint64_t length;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(end - begin);
+
+    std::error_code ec;
+    auto fail = [&](const std::string& msg) {
+        fs::remove(pack_tmp, ec);
+        fs::remove(index_tmp, ec);
+        return Result::failure(msg);
+    };
+
+    {
+        std::ofstream out(pack_tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return fail("Cannot write " + pack_tmp.string());
+
+        std::string header(kPackMagic, sizeof(kPackMagic));
+        PutLE32(header, kVersion);
+        PutLE32(header, 0);
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+        uint64_t          offset = kPackHeader;
+        std::vector<char> buf(1 << 20);
+        for (size_t i = begin; i < end; ++i) {
+            const PackInput& obj = objects[i];
+            Entry e;
+            if (!MakeKey(obj.kind, obj.hash, e.key))
+                return fail("Not an object name: " + obj.path.string());
+
+            std::ifstream in(obj.path, std::ios::binary);
+            if (!in) return fail("Cannot read " + obj.path.string());
+            uint64_t length = 0;
+            while (in) {
+                in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+                auto n = in.gcount();
+                out.write(buf.data(), n);
+                length += static_cast<uint64_t>(n);
+            }
+            if (in.bad()) return fail("Cannot read " + obj.path.string());
+
+            e.offset = offset;
+            e.length = length;
+            entries.push_back(e);
+            offset += length;
+        }
+        out.flush();
+        if (!out) return fail("Failed to write " + pack_tmp.string());
+    }
+    if (!SyncPath(pack_tmp)) return fail("Failed to flush " + pack_tmp.string());
+
+    // Sorted, one entry per key
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const Entry& a, const Entry& b) { return a.key == b.key; }),
+                  entries.end());
+
+    std::string index(kIndexMagic, sizeof(kIndexMagic));
+    PutLE32(index, kVersion);
+    PutLE32(index, static_cast<uint32_t>(entries.size()));
+
+    uint32_t running = 0;
+    size_t   at      = 0;
+    for (int b = 0; b < 256; ++b) {
+        while (at < entries.size() && entries[at].key[0] == b) { ++running; ++at; }
+        PutLE32(index, running);
+    }
+    for (const auto& e : entries) {
+        index.append(reinterpret_cast<const char*>(e.key.data()), kKeySize);
+        index.append(7, '\0');
+        PutLE64(index, e.offset);
+        PutLE64(index, e.length);
+    }
+    {
+        std::ofstream out(index_tmp, std::ios::binary | std::ios::trunc);
+        out.write(index.data(), static_cast<std::streamsize>(index.size()));
+        if (!out) return fail("Failed to write " + index_tmp.string());
+    }
+    if (!SyncPath(index_tmp)) return fail("Failed to flush " + index_tmp.string());
+
+    // Pack first, index last: the pack only becomes visible once
+    // both are complete
+    fs::rename(pack_tmp, pack_path, ec);
+    if (ec) return fail("Failed to store " + pack_path.string() + ": " + ec.message());
+    fs::rename(index_tmp, index_path, ec);
+    if (ec) {
+        std::string msg = ec.message();
+        fs::remove(pack_path, ec);
+        return fail("Failed to store " + index_path.string() + ": " + msg);
+    }
+    return Result::success();
+}
+
+} // namespace
+
+// -------------------------------------------------------
+// Open
+// -------------------------------------------------------
+
+PackSet::PackSet(const fs::path& dir) {
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(dir, ec)) {
+        if (!e.is_regular_file() || e.path().extension() != ".idx") continue;
+
+        Pack p;
+        p.index_path = e.path();
+        p.pack_path  = fs::path(e.path()).replace_extension(".pack");
+        if (!fs::exists(p.pack_path) || !p.index.Open(p.index_path)) continue;
+
+        const uint8_t* d = p.index.Data();
+        size_t         n = p.index.Size();
+        if (n < kEntriesAt || std::memcmp(d, kIndexMagic, sizeof(kIndexMagic)) != 0
+            || GetLE32(d + 8) != kVersion)
+            continue;
+        p.count = GetLE32(d + 12);
+        if (n != kEntriesAt + size_t{p.count} * kEntrySize
+            || !FanoutOk(d + kHeaderSize, p.count))
+            continue;
+
+        packs_.push_back(std::move(p));
+    }
+}
+
+void PackSet::Close() {
+    packs_.clear();
+}
+
+// -------------------------------------------------------
+// Lookup — fanout narrows to the first hash byte, then a
+// binary search over the mapped entries
+// -------------------------------------------------------
+
+bool PackSet::Find(ObjectKind kind, const std::string& hash, Location& loc) const {
+    if (packs_.empty()) return false;
+    Key key;
+    if (!MakeKey(kind, hash, key)) return false;
+
+    for (const auto& p : packs_) {
+        const uint8_t* d      = p.index.Data();
+        const uint8_t* fanout = d + kHeaderSize;
+        size_t lo = key[0] == 0 ? 0 : GetLE32(fanout + (key[0] - 1) * 4);
+        size_t hi = GetLE32(fanout + key[0] * 4);
+
+        while (lo < hi) {
+            size_t         mid   = lo + (hi - lo) / 2;
+            const uint8_t* entry = d + kEntriesAt + mid * kEntrySize;
+            int            cmp   = std::memcmp(entry, key.data(), kKeySize);
+            if (cmp == 0) {
+                loc.pack   = &p.pack_path;
+                loc.offset = GetLE64(entry + 40);
+                loc.length = GetLE64(entry + 48);
+                return true;
+            }
+            if (cmp < 0) lo = mid + 1;
+            else         hi = mid;
+        }
+    }
+    return false;
+}
+
+bool PackSet::Has(ObjectKind kind, const std::string& hash) const {
+    Location loc;
+    return Find(kind, hash, loc);
+}
+
+int64_t PackSet::Size(ObjectKind kind, const std::string& hash) const {
+    Location loc;
+    return Find(kind, hash, loc) ? static_cast<int64_t>(loc.length) : -1;
+}
+
+bool PackSet::Read(ObjectKind kind, const std::string& hash, std::vector<char>& out) const {
+    out.clear();
+    return Stream(kind, hash, [&](const char* data, size_t len) {
+        out.insert(out.end(), data, data + len);
+    });
+}
+
+bool PackSet::Stream(ObjectKind kind, const std::string& hash, const Sink& sink) const {
+    Location loc;
+    if (!Find(kind, hash, loc)) return false;
+
+    std::ifstream in(*loc.pack, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(loc.offset));
+    if (!in) return false;
+
+    std::vector<char> buf(static_cast<size_t>(std::min<uint64_t>(loc.length, 1 << 20)));
+    uint64_t left = loc.length;
+    while (left > 0) {
+        auto want = static_cast<std::streamsize>(std::min<uint64_t>(left, buf.size()));
+        in.read(buf.data(), want);
+        if (in.gcount() != want) return false;
+        sink(buf.data(), static_cast<size_t>(want));
+        left -= static_cast<uint64_t>(want);
+    }
+    return true;
+}
+
+std::vector<std::string> PackSet::List(ObjectKind kind) const {
+    std::vector<std::string> out;
+    for (const auto& p : packs_) {
+        for (uint32_t i = 0; i < p.count; ++i) {
+            const uint8_t* entry = p.index.Data() + kEntriesAt + size_t{i} * kEntrySize;
+            if (entry[32] == static_cast<uint8_t>(kind))
+                out.push_back(Utils::ToHex(entry, 32));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+std::vector<fs::path> PackSet::Files() const {
+    std::vector<fs::path> out;
+    for (const auto& p : packs_) {
+        out.push_back(p.pack_path);
+        out.push_back(p.index_path);
+    }
+    return out;
+}
+
+// -------------------------------------------------------
+// Write
+// -------------------------------------------------------
+
+Result PackSet::Write(const fs::path& dir, const std::vector<PackInput>& objects,
+                      size_t& packs_written) {
+    packs_written = 0;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    size_t   begin = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i <= objects.size(); ++i) {
+        uint64_t size = 0;
+        if (i < objects.size()) {
+            size = fs::file_size(objects[i].path, ec);
+            if (ec) return Result::failure("Cannot read " + objects[i].path.string());
+        }
+        bool last = i == objects.size();
+        if ((last || bytes + size > kMaxPackBytes) && i > begin) {
+            Result r = WritePack(dir, objects, begin, i);
+            if (!r.ok) return r;
+            ++packs_written;
+            begin = i;
+            bytes = 0;
+        }
+        bytes += size;
+    }
+    if (packs_written > 0 && !SyncPath(dir))
+        return Result::failure("Failed to flush " + dir.string());
+    return Result::success();
+}
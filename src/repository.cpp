@@ -1,24 +1,141 @@
 #include "repository.h"
 
+#include "utils.h"
+
 #include <SQLiteCpp/SQLiteCpp.h>
 
 #include <filesystem>
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
 
 namespace fs = std::filesystem;
 
+// -------------------------------------------------------
+// Commit rows
+// -------------------------------------------------------
+// commits.hash and commits.parent_hash hold the raw 32-byte
+// digest rather than 64 hex chars: half the size in the table
+// and in every index, and byte order is hex order, so all
+// hashes starting with a prefix form one contiguous key range.
+
+static constexpr size_t kHashBytes = 32;   // SHA-256 and BLAKE3
+
+static bool BindHash(SQLite::Statement& q, int index, const std::string& hex)
+{
+    uint8_t key[kHashBytes];
+    if (!Utils::FromHex(hex, key, sizeof key)) return false;
+    q.bind(index, key, static_cast<int>(sizeof key));
+    return true;
+}
+
+static std::string ColumnHash(const SQLite::Column& col)
+{
+    if (col.isNull()) return "";
+    if (col.isBlob())
+        return Utils::ToHex(static_cast<const uint8_t*>(col.getBlob()),
+                            static_cast<size_t>(col.getBytes()));
+    return col.getString();   // v3 hex text, only seen by MigrateToV4
+}
+
+static const char* const kInsertCommit = R"(
+    INSERT OR REPLACE INTO commits
+        (hash, message, timestamp, author, parent_hash,
+         doc_path, doc_type, mass, volume, feature_count,
+         surface_area, material, bbox_x, bbox_y, bbox_z,
+         config_count, blob_size_bytes, stored_size_bytes, time, doc_id)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+)";
+
+// doc_id 0 = no documents row (yet)
+static Result BindCommit(SQLite::Statement& q, const Commit& c, int64_t doc_id)
+{
+    if (!BindHash(q, 1, c.hash))
+        return Result::failure("Commit hash is not a " + std::to_string(kHashBytes * 2)
+                               + "-digit hex digest: " + c.hash);
+    if (c.parent_hash.empty())
+        q.bind(5);                                    // root commit: NULL
+    else if (!BindHash(q, 5, c.parent_hash))
+        return Result::failure("Parent hash is not a hex digest: " + c.parent_hash);
+
+    // Unparseable timestamps sort as the epoch rather than failing
+    int64_t time = 0;
+    Utils::ParseTimestamp(c.timestamp, time);
+
+    q.bind(2,  c.message);
+    q.bind(3,  c.timestamp);
+    q.bind(4,  c.author);
+    q.bind(6,  c.sw_meta.doc_path);
+    q.bind(7,  c.sw_meta.doc_type);
+    q.bind(8,  c.sw_meta.mass);
+    q.bind(9,  c.sw_meta.volume);
+    q.bind(10, c.sw_meta.feature_count);
+    q.bind(11, c.sw_meta.surface_area);
+    q.bind(12, c.sw_meta.material);
+    q.bind(13, c.sw_meta.bbox_x);
+    q.bind(14, c.sw_meta.bbox_y);
+    q.bind(15, c.sw_meta.bbox_z);
+    q.bind(16, c.sw_meta.config_count);
+    q.bind(17, static_cast<long long>(c.sw_meta.blob_size_bytes));
+    q.bind(18, static_cast<long long>(c.sw_meta.stored_size_bytes));
+    q.bind(19, static_cast<long long>(time));
+    if (doc_id != 0) q.bind(20, static_cast<long long>(doc_id));
+    else             q.bind(20);
+    return Result::success();
+}
+
+static Commit RowToCommit(SQLite::Statement& q)
+{
+    Commit c;
+    c.hash              = ColumnHash(q.getColumn(0));
+    c.message           = q.getColumn(1).getString();
+    c.timestamp         = q.getColumn(2).getString();
+    c.author            = q.getColumn(3).getString();
+    c.parent_hash       = ColumnHash(q.getColumn(4));
+    c.sw_meta.doc_path  = q.getColumn(5).getString();
+    c.sw_meta.doc_type  = q.getColumn(6).getString();
+    c.sw_meta.mass      = q.getColumn(7).getDouble();
+    c.sw_meta.volume    = q.getColumn(8).getDouble();
+    c.sw_meta.feature_count  = q.getColumn(9).getInt();
+    c.sw_meta.surface_area   = q.getColumn(10).getDouble();
+    c.sw_meta.material       = q.getColumn(11).getString();
+    c.sw_meta.bbox_x         = q.getColumn(12).getDouble();
+    c.sw_meta.bbox_y         = q.getColumn(13).getDouble();
+    c.sw_meta.bbox_z         = q.getColumn(14).getDouble();
+    c.sw_meta.config_count   = q.getColumn(15).getInt();
+    c.sw_meta.blob_size_bytes = static_cast<int64_t>(q.getColumn(16).getInt64());
+    if (q.getColumnCount() > 17)   // v3 databases from before stored_size_bytes lack it
+        c.sw_meta.stored_size_bytes = static_cast<int64_t>(q.getColumn(17).getInt64());
+    if (q.getColumnCount() > 18)
+        c.time = static_cast<int64_t>(q.getColumn(18).getInt64());
+    else
+        Utils::ParseTimestamp(c.timestamp, c.time);   // v3 row
+    if (q.getColumnCount() > 20)
+        c.group_hash = ColumnHash(q.getColumn(20));
+    return c;
+}
+
 // -------------------------------------------------------
 // Construction / destruction
 // -------------------------------------------------------
 
-Repository::Repository(const fs::path& project_dir)
+Repository::Repository(const fs::path& project_dir, OpenMode mode)
     : project_dir_(project_dir)
     , repo_root_(project_dir / ".swvcs")
+    , read_only_(mode == OpenMode::ReadOnly)
 {
     Init();
 }
 
+bool Repository::Exists(const fs::path& project_dir)
+{
+    std::error_code ec;
+    return fs::is_regular_file(project_dir / ".swvcs" / "swvcs.db", ec);
+}
+
 // Must be defined here (not in the header) because
 // SQLite::Database is only a complete type in this TU.
 Repository::~Repository() = default;
@@ -29,23 +146,46 @@ Repository::~Repository() = default;
 
 void Repository::Init()
 {
+    // An existing repository needs no directories created: the
+    // stores create their subfolders as they write
+    fs::path db_path = repo_root_ / "swvcs.db";
     std::error_code ec;
-    fs::create_directories(repo_root_,              ec);
-    fs::create_directories(BlobsDir(),              ec);
-    fs::create_directories(repo_root_ / "thumbs",  ec);
-
-    if (ec) {
-        std::cerr << "[repo] Failed to create repo dirs: " << ec.message() << "\n";
-        return;
+    if (read_only_ && !fs::exists(db_path, ec)) return;   // nothing to read
+    if (!read_only_ && !fs::exists(db_path, ec)) {
+        fs::create_directories(repo_root_,  ec);
+        fs::create_directories(BlobsDir(),  ec);
+        fs::create_directories(ChunksDir(), ec);
+        fs::create_directories(PacksDir(),  ec);
+        fs::create_directories(ThumbsDir(), ec);
+        if (ec) {
+            std::cerr << "[repo] Failed to create repo dirs: " << ec.message() << "\n";
+            return;
+        }
     }
 
     try {
-        fs::path db_path = repo_root_ / "swvcs.db";
         db_ = std::make_unique<SQLite::Database>(
             db_path.string(),
-            SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+            read_only_ ? SQLite::OPEN_READONLY : SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+
+        ConfigureConnection();
+
+        int         version = 0;
+        std::string algo;
+        ReadHeader(version, algo);
+        if (read_only_ && version < kSchemaVersion) {
+            needs_upgrade_ = true;
+            return;
+        }
+        OpenSchema(version);
+        version_ = version;
+        if (algo.empty()) algo = GetConfigUnchecked("hash_algo");   // just created
 
-        InitSchema();
+        if (!ParseHashAlgo(algo, hash_algo_)) {
+            std::cerr << "[repo] Unsupported hash_algo '" << algo
+                      << "' — this repository needs a newer swvcs\n";
+            return;
+        }
         valid_ = true;
         std::cout << "[repo] Repository at: " << repo_root_.string() << "\n";
     }
@@ -54,27 +194,223 @@ void Repository::Init()
     }
 }
 
-void Repository::InitSchema()
+// -------------------------------------------------------
+// ConfigureConnection — journal mode and cache pragmas
+// -------------------------------------------------------
+// WAL lets the GUI keep reading while the CLI commits (readers
+// never block the writer or each other).  With WAL, synchronous
+// = NORMAL only fsyncs at checkpoints: a power cut can lose the
+// last commit or two, but never corrupts the database — and the
+// blobs a lost commit pointed at are simply unreferenced.
+
+void Repository::ConfigureConnection()
+{
+    db_->setBusyTimeout(5000);   // CLI and GUI write the same DB
+
+    // The journal mode is kept in the database file, so a read-only
+    // connection just uses what the writers chose
+    if (!read_only_) {
+        // WAL needs shared memory between processes, which network
+        // filesystems can't provide — SQLite then keeps the rollback
+        // journal, which is still correct, just less concurrent
+        std::string mode = db_->execAndGet("PRAGMA journal_mode = WAL").getString();
+        if (!Utils::IEquals(mode, "wal"))
+            std::cerr << "[repo] WAL unavailable here, using journal_mode=" << mode << "\n";
+        db_->exec("PRAGMA synchronous = NORMAL");
+    }
+
+    db_->exec("PRAGMA cache_size = -16384");       // 16 MB page cache
+    db_->exec("PRAGMA mmap_size = 268435456");     // read up to 256 MB via mmap
+    db_->exec("PRAGMA temp_store = MEMORY");
+}
+
+// -------------------------------------------------------
+// Statement cache
+// -------------------------------------------------------
+// Each SQL string is compiled once per connection and reused.
+
+Repository::CachedStatement::~CachedStatement()
+{
+    // Reset so no read transaction outlives the call (it would pin
+    // an old snapshot of the DB and hold back WAL checkpoints)
+    q_.tryReset();
+    q_.clearBindings();
+}
+
+Repository::CachedStatement Repository::Prepare(const std::string& sql)
+{
+    auto it = statements_.find(sql);
+    if (it == statements_.end())
+        it = statements_.emplace(sql, std::make_unique<SQLite::Statement>(*db_, sql)).first;
+    return CachedStatement(*it->second);
+}
+
+// -------------------------------------------------------
+// Schema
+// -------------------------------------------------------
+// config.version records which schema steps a database has had.
+// A new database is created at v5 in one go (CreateSchema); every
+// step after that — and, for an older database, every step it
+// hasn't had — comes from kMigrations.  Opening a database that is
+// up to date reads its version and hash_algo and nothing else.
+
+const Repository::Migration Repository::kMigrations[] = {
+    { 3, "property columns",            &Repository::MigrateToV3 },
+    { 4, "binary hash keys",            &Repository::MigrateToV4 },
+    { 5, "documents table",             &Repository::MigrateToV5 },
+    { 6, "full-text search index",      &Repository::MigrateToV6 },
+    { 7, "commit groups",               &Repository::MigrateToV7 },
+};
+
+// Reads version and hash_algo in one statement.  version is 0 for a
+// new (empty) database, and 2 for one from before it was recorded.
+void Repository::ReadHeader(int& version, std::string& algo)
+{
+    version = 0;
+    algo.clear();
+    if (!db_->tableExists("config")) return;
+
+    version = 2;
+    auto q = Prepare("SELECT key, value FROM config WHERE key IN ('version', 'hash_algo')");
+    while (q->executeStep()) {
+        std::string key = q->getColumn(0).getString();
+        if (key == "version") version = std::max(2, std::atoi(q->getColumn(1).getString().c_str()));
+        else                  algo    = q->getColumn(1).getString();
+    }
+}
+
+void Repository::OpenSchema(int& version)
+{
+    static_assert(std::size(kMigrations) == kSchemaVersion - 2,
+                  "one step per version from 3 to kSchemaVersion");
+    if (version >= kSchemaVersion) return;   // the usual case
+
+    // All pending steps in one transaction: an interrupted upgrade
+    // leaves the database exactly as it was
+    const bool fresh = version == 0;
+    const int  from  = version;
+    SQLite::Transaction tx(*db_);
+    if (fresh) {
+        CreateSchema();
+        version = 5;
+    }
+    for (const auto& m : kMigrations) {
+        if (m.version <= version) continue;
+        if (!fresh)
+            std::cout << "[repo] Upgrading schema to v" << m.version << " (" << m.what << ")...\n";
+        if (!(this->*m.apply)()) break;   // can't be applied by this build — retried next open
+        version = m.version;
+    }
+    if (version != from) {
+        auto q = Prepare("INSERT OR REPLACE INTO config (key, value) VALUES ('version', ?)");
+        q->bind(1, std::to_string(version));
+        q->exec();
+    }
+    tx.commit();
+}
+
+// The v5 layout, for a new database
+void Repository::CreateSchema()
+{
+    CreateCommitsTable();
+    CreateSupportTables();
+    db_->exec(R"(
+        -- documents table — one row per working file ever committed;
+        -- commits refer to it by doc_id (see DocumentKey)
+        CREATE TABLE documents (
+            id   INTEGER PRIMARY KEY,
+            key  TEXT NOT NULL UNIQUE,
+            path TEXT NOT NULL
+        );
+    )");
+}
+
+// config (key/value store for HEAD, version, settings) and
+// stat_cache — size / mtime / file id of each working file when it
+// was last hashed, so an unchanged file needn't be read again.
+// stat_cache is only a cache: safe to empty at any time.
+void Repository::CreateSupportTables()
+{
+    db_->exec(R"(
+        CREATE TABLE IF NOT EXISTS config (
+            key   TEXT PRIMARY KEY,
+            value TEXT NOT NULL DEFAULT ''
+        );
+
+        CREATE TABLE IF NOT EXISTS stat_cache (
+            doc_path  TEXT PRIMARY KEY,
+            size      INTEGER NOT NULL,
+            mtime_ns  INTEGER NOT NULL,
+            device    INTEGER NOT NULL,
+            inode     INTEGER NOT NULL,
+            hash      TEXT    NOT NULL,
+            cached_ns INTEGER NOT NULL
+        );
+
+        INSERT OR IGNORE INTO config (key, value) VALUES ('HEAD', '');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('hash_algo', 'sha256');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('compression_level', '3');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('compression_long', '0');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('delta_chain', '0');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('delta_max_mb', '512');
+        INSERT OR IGNORE INTO config (key, value) VALUES ('storage', 'chunked');
+    )");
+}
+
+// -------------------------------------------------------
+// commits table
+// -------------------------------------------------------
+// hash / parent_hash are raw digests (see BindHash); parent_hash
+// is NULL for a root commit.  time is the timestamp as Unix
+// seconds — the listing order, compared as an integer instead
+// of as ISO text.  doc_id is the commit's documents row.
+
+void Repository::CreateCommitsTable()
 {
-    // commits table — one row per snapshot (original columns)
     db_->exec(R"(
-        CREATE TABLE IF NOT EXISTS commits (
-            hash          TEXT PRIMARY KEY,
-            message       TEXT NOT NULL DEFAULT '',
-            timestamp     TEXT NOT NULL DEFAULT '',
-            author        TEXT NOT NULL DEFAULT '',
-            parent_hash   TEXT NOT NULL DEFAULT '',
-            doc_path      TEXT NOT NULL DEFAULT '',
-            doc_type      TEXT NOT NULL DEFAULT '',
-            mass          REAL NOT NULL DEFAULT 0.0,
-            volume        REAL NOT NULL DEFAULT 0.0,
-            feature_count INTEGER NOT NULL DEFAULT 0
+        CREATE TABLE commits (
+            hash              BLOB    PRIMARY KEY,
+            message           TEXT    NOT NULL DEFAULT '',
+            timestamp         TEXT    NOT NULL DEFAULT '',
+            author            TEXT    NOT NULL DEFAULT '',
+            parent_hash       BLOB,
+            doc_path          TEXT    NOT NULL DEFAULT '',
+            doc_type          TEXT    NOT NULL DEFAULT '',
+            mass              REAL    NOT NULL DEFAULT 0.0,
+            volume            REAL    NOT NULL DEFAULT 0.0,
+            feature_count     INTEGER NOT NULL DEFAULT 0,
+            surface_area      REAL    NOT NULL DEFAULT 0.0,
+            material          TEXT    NOT NULL DEFAULT '',
+            bbox_x            REAL    NOT NULL DEFAULT 0.0,
+            bbox_y            REAL    NOT NULL DEFAULT 0.0,
+            bbox_z            REAL    NOT NULL DEFAULT 0.0,
+            config_count      INTEGER NOT NULL DEFAULT 0,
+            blob_size_bytes   INTEGER NOT NULL DEFAULT 0,
+            stored_size_bytes INTEGER NOT NULL DEFAULT 0,
+            time              INTEGER NOT NULL DEFAULT 0,
+            doc_id            INTEGER REFERENCES documents (id)
         );
+
+        -- Newest-first listing (see ForEachCommit)
+        CREATE INDEX commits_by_time     ON commits (time, hash);
+        -- History of one document, newest first
+        CREATE INDEX commits_by_document ON commits (doc_id, time, hash);
+        -- Children of a commit
+        CREATE INDEX commits_by_parent   ON commits (parent_hash);
     )");
+}
 
-    // Migration: add new columns if they don't exist yet.
-    // SQLite ALTER TABLE does not support IF NOT EXISTS, so we
-    // silently ignore the "duplicate column name" error.
+// -------------------------------------------------------
+// Migration steps
+// -------------------------------------------------------
+// Each runs inside OpenSchema's transaction and returns false only
+// if this build can't apply it.
+
+// v1 / v2 databases lack the columns added up to v3.  Some may
+// have a few of them, hence the ignored "duplicate column" errors
+// (SQLite's ALTER TABLE has no IF NOT EXISTS).
+bool Repository::MigrateToV3()
+{
     auto tryAlter = [&](const char* sql) {
         try { db_->exec(sql); }
         catch (const SQLite::Exception&) { /* column already exists */ }
@@ -86,18 +422,228 @@ void Repository::InitSchema()
     tryAlter("ALTER TABLE commits ADD COLUMN bbox_z          REAL    NOT NULL DEFAULT 0.0");
     tryAlter("ALTER TABLE commits ADD COLUMN config_count    INTEGER NOT NULL DEFAULT 0");
     tryAlter("ALTER TABLE commits ADD COLUMN blob_size_bytes INTEGER NOT NULL DEFAULT 0");
+    tryAlter("ALTER TABLE commits ADD COLUMN stored_size_bytes INTEGER NOT NULL DEFAULT 0");
+    return true;
+}
+
+// v3 kept hashes as hex TEXT and sorted by the ISO string.
+// SQLite can't change a column's type in place, so the table is
+// rebuilt.  The stat_cache table, the storage settings and the
+// stored_size_bytes column arrived while the version still read 3,
+// so they are added here too.
+
+bool Repository::MigrateToV4()
+{
+    CreateSupportTables();
+    {
+        SQLite::Statement has(*db_,
+            "SELECT COUNT(*) FROM pragma_table_info('commits') WHERE name = 'stored_size_bytes'");
+        if (has.executeStep() && has.getColumn(0).getInt() == 0)
+            db_->exec("ALTER TABLE commits ADD COLUMN stored_size_bytes INTEGER NOT NULL DEFAULT 0");
+    }
+    db_->exec("DROP INDEX IF EXISTS commits_by_time");
+    db_->exec("ALTER TABLE commits RENAME TO commits_v3");
+    CreateCommitsTable();
+
+    int64_t copied = 0;
+    {
+        SQLite::Statement read(*db_, "SELECT * FROM commits_v3");
+        SQLite::Statement write(*db_, kInsertCommit);
+        while (read.executeStep()) {
+            Result r = BindCommit(write, RowToCommit(read), 0);   // MigrateToV5 links documents
+            if (!r.ok) throw SQLite::Exception(r.err, -1);
+            write.exec();
+            write.reset();
+            ++copied;
+        }
+    }
+    db_->exec("DROP TABLE commits_v3");
+    std::cout << "[repo] Converted " << copied << " commit(s)\n";
+    return true;
+}
 
-    // config table — key/value store for HEAD, version, etc.
+// v5 adds the documents table and commits.doc_id.  The table
+// MigrateToV4 rebuilt already has the column, but no values.
+
+bool Repository::MigrateToV5()
+{
     db_->exec(R"(
-        CREATE TABLE IF NOT EXISTS config (
-            key   TEXT PRIMARY KEY,
-            value TEXT NOT NULL DEFAULT ''
+        CREATE TABLE IF NOT EXISTS documents (
+            id   INTEGER PRIMARY KEY,
+            key  TEXT NOT NULL UNIQUE,
+            path TEXT NOT NULL
         );
     )");
+    try { db_->exec("ALTER TABLE commits ADD COLUMN doc_id INTEGER REFERENCES documents (id)"); }
+    catch (const SQLite::Exception&) { /* column already exists */ }
+
+    std::vector<std::string> paths;
+    {
+        SQLite::Statement q(*db_, "SELECT DISTINCT doc_path FROM commits WHERE doc_id IS NULL");
+        while (q.executeStep()) paths.push_back(q.getColumn(0).getString());
+    }
+    {
+        SQLite::Statement link(*db_,
+            "UPDATE commits SET doc_id = ? WHERE doc_path = ? AND doc_id IS NULL");
+        for (const auto& path : paths) {
+            int64_t id = DocumentId(path, true);
+            if (id == 0) continue;
+            link.bind(1, static_cast<long long>(id));
+            link.bind(2, path);
+            link.exec();
+            link.reset();
+        }
+    }
+    db_->exec("DROP INDEX IF EXISTS commits_by_doc");   // v4's doc_path index
+    db_->exec("CREATE INDEX IF NOT EXISTS commits_by_document ON commits (doc_id, time, hash)");
+    if (!paths.empty())
+        std::cout << "[repo] Indexed " << paths.size() << " document(s) for per-file history\n";
+    return true;
+}
+
+// v6 adds commits_fts, a full-text index of message, material and
+// doc_path.  It stores no text of its own (content='commits') and
+// is kept current by triggers, so SaveCommit — and any other
+// writer — updates it in the same statement.  INSERT OR REPLACE
+// of an existing hash deletes the old row without firing delete
+// triggers (recursive_triggers is off), hence the BEFORE INSERT
+// trigger that drops the old row's entry first.
+
+bool Repository::MigrateToV6()
+{
+    // A savepoint, so that an SQLite built without FTS5 can back
+    // out of this step alone: everything but search still works
+    db_->exec("SAVEPOINT search_index");
+    try {
+        db_->exec(R"(
+            CREATE VIRTUAL TABLE commits_fts USING fts5 (
+                message, material, doc_path,
+                content = 'commits', content_rowid = 'rowid',
+                prefix = '2 3', tokenize = 'unicode61 remove_diacritics 2'
+            );
+
+            CREATE TRIGGER commits_fts_replace BEFORE INSERT ON commits BEGIN
+                INSERT INTO commits_fts (commits_fts, rowid, message, material, doc_path)
+                    SELECT 'delete', rowid, message, material, doc_path
+                    FROM commits WHERE hash = new.hash;
+            END;
+            CREATE TRIGGER commits_fts_insert AFTER INSERT ON commits BEGIN
+                INSERT INTO commits_fts (rowid, message, material, doc_path)
+                    VALUES (new.rowid, new.message, new.material, new.doc_path);
+            END;
+            CREATE TRIGGER commits_fts_delete AFTER DELETE ON commits BEGIN
+                INSERT INTO commits_fts (commits_fts, rowid, message, material, doc_path)
+                    VALUES ('delete', old.rowid, old.message, old.material, old.doc_path);
+            END;
+            CREATE TRIGGER commits_fts_update AFTER UPDATE OF message, material, doc_path
+            ON commits BEGIN
+                INSERT INTO commits_fts (commits_fts, rowid, message, material, doc_path)
+                    VALUES ('delete', old.rowid, old.message, old.material, old.doc_path);
+                INSERT INTO commits_fts (rowid, message, material, doc_path)
+                    VALUES (new.rowid, new.message, new.material, new.doc_path);
+            END;
+
+            -- A message match counts most, then material, then the path
+            INSERT INTO commits_fts (commits_fts, rank) VALUES ('rank', 'bm25(10.0, 4.0, 1.0)');
+            INSERT INTO commits_fts (commits_fts) VALUES ('rebuild');
+        )");
+    }
+    catch (const SQLite::Exception& e) {
+        db_->exec("ROLLBACK TO search_index");
+        db_->exec("RELEASE search_index");
+        std::cerr << "[repo] Full-text search unavailable: " << e.what() << "\n";
+        return false;
+    }
+    db_->exec("RELEASE search_index");
+    return true;
+}
+
+// v7 adds commits.group_hash: the group commit a commit was made
+// as part of ('swvcs commit --all-open'), NULL for the rest
+bool Repository::MigrateToV7()
+{
+    db_->exec(R"(
+        ALTER TABLE commits ADD COLUMN group_hash BLOB;
+        CREATE INDEX commits_by_group ON commits (group_hash) WHERE group_hash IS NOT NULL;
+    )");
+    return true;
+}
+
+// -------------------------------------------------------
+// Config
+// -------------------------------------------------------
+
+// Also used during Init(), before valid_ is set
+std::string Repository::GetConfigUnchecked(const std::string& key, const std::string& fallback)
+{
+    auto q = Prepare("SELECT value FROM config WHERE key = ?");
+    q->bind(1, key);
+    if (q->executeStep())
+        return q->getColumn(0).getString();
+    return fallback;
+}
+
+std::string Repository::GetConfig(const std::string& key, const std::string& fallback)
+{
+    if (!valid_) return fallback;
+    try {
+        return GetConfigUnchecked(key, fallback);
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] GetConfig error: " << e.what() << "\n";
+    }
+    return fallback;
+}
 
-    // Seed version on first creation (ignored if already exists)
-    db_->exec("INSERT OR IGNORE INTO config (key, value) VALUES ('version', '3');");
-    db_->exec("INSERT OR IGNORE INTO config (key, value) VALUES ('HEAD', '');");
+Result Repository::SetConfig(const std::string& key, const std::string& value)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        auto q = Prepare("INSERT OR REPLACE INTO config (key, value) VALUES (?, ?)");
+        q->bind(1, key);
+        q->bind(2, value);
+        q->exec();
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("SetConfig DB error: ") + e.what());
+    }
+}
+
+CompressionOptions Repository::GetCompressionOptions()
+{
+    CompressionOptions opts;
+    opts.level         = std::atoi(GetConfig("compression_level", "3").c_str());
+    opts.long_distance = GetConfig("compression_long", "0") == "1";
+    opts.level         = std::clamp(opts.level, 0, 19);
+    return opts;
+}
+
+int Repository::GetDeltaChain()
+{
+    return std::max(0, std::atoi(GetConfig("delta_chain", "0").c_str()));
+}
+
+int64_t Repository::GetDeltaMaxBytes()
+{
+    return int64_t{std::max(0, std::atoi(GetConfig("delta_max_mb", "512").c_str()))} << 20;
+}
+
+bool Repository::GetFullCopies()
+{
+    return GetConfig("storage", "chunked") == "full";
+}
+
+Result Repository::SetHashAlgo(HashAlgo algo)
+{
+    if (algo == hash_algo_) return Result::success();
+    if (CommitCount() > 0)
+        return Result::failure("Repository already has commits — use 'swvcs migrate --hash "
+                               + std::string(HashAlgoName(algo)) + "' to convert it");
+
+    Result r = SetConfig("hash_algo", HashAlgoName(algo));
+    if (r.ok) hash_algo_ = algo;
+    return r;
 }
 
 // -------------------------------------------------------
@@ -108,9 +654,9 @@ std::string Repository::GetHead()
 {
     if (!valid_) return "";
     try {
-        SQLite::Statement q(*db_, "SELECT value FROM config WHERE key = 'HEAD'");
-        if (q.executeStep())
-            return q.getColumn(0).getString();
+        auto q = Prepare("SELECT value FROM config WHERE key = 'HEAD'");
+        if (q->executeStep())
+            return q->getColumn(0).getString();
     }
     catch (const SQLite::Exception& e) {
         std::cerr << "[repo] GetHead error: " << e.what() << "\n";
@@ -122,10 +668,9 @@ Result Repository::SetHead(const std::string& hash)
 {
     if (!valid_) return Result::failure("Repository not valid");
     try {
-        SQLite::Statement q(*db_,
-            "INSERT OR REPLACE INTO config (key, value) VALUES ('HEAD', ?)");
-        q.bind(1, hash);
-        q.exec();
+        auto q = Prepare("INSERT OR REPLACE INTO config (key, value) VALUES ('HEAD', ?)");
+        q->bind(1, hash);
+        q->exec();
         return Result::success();
     }
     catch (const SQLite::Exception& e) {
@@ -133,6 +678,99 @@ Result Repository::SetHead(const std::string& hash)
     }
 }
 
+// -------------------------------------------------------
+// Stat cache
+// -------------------------------------------------------
+
+bool Repository::LoadStatEntry(const std::string& doc_path, StatEntry& out)
+{
+    if (!valid_) return false;
+    try {
+        auto q = Prepare("SELECT size, mtime_ns, device, inode, hash, cached_ns "
+                         "FROM stat_cache WHERE doc_path = ?");
+        q->bind(1, doc_path);
+        if (!q->executeStep()) return false;
+        out.doc_path  = doc_path;
+        out.size      = q->getColumn(0).getInt64();
+        out.mtime_ns  = q->getColumn(1).getInt64();
+        out.device    = static_cast<uint64_t>(q->getColumn(2).getInt64());
+        out.inode     = static_cast<uint64_t>(q->getColumn(3).getInt64());
+        out.hash      = q->getColumn(4).getString();
+        out.cached_ns = q->getColumn(5).getInt64();
+        return true;
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] LoadStatEntry error: " << e.what() << "\n";
+    }
+    return false;
+}
+
+Result Repository::SaveStatEntry(const StatEntry& e)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        auto q = Prepare(R"(
+            INSERT OR REPLACE INTO stat_cache
+                (doc_path, size, mtime_ns, device, inode, hash, cached_ns)
+            VALUES (?, ?, ?, ?, ?, ?, ?)
+        )");
+        q->bind(1, e.doc_path);
+        q->bind(2, static_cast<long long>(e.size));
+        q->bind(3, static_cast<long long>(e.mtime_ns));
+        q->bind(4, static_cast<long long>(e.device));
+        q->bind(5, static_cast<long long>(e.inode));
+        q->bind(6, e.hash);
+        q->bind(7, static_cast<long long>(e.cached_ns));
+        q->exec();
+        return Result::success();
+    }
+    catch (const SQLite::Exception& ex) {
+        return Result::failure(std::string("SaveStatEntry DB error: ") + ex.what());
+    }
+}
+
+Result Repository::LoadStatEntries(std::vector<StatEntry>& out)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        auto q = Prepare("SELECT doc_path, size, mtime_ns, device, inode, hash, cached_ns "
+                         "FROM stat_cache");
+        while (q->executeStep()) {
+            StatEntry e;
+            e.doc_path  = q->getColumn(0).getString();
+            e.size      = q->getColumn(1).getInt64();
+            e.mtime_ns  = q->getColumn(2).getInt64();
+            e.device    = static_cast<uint64_t>(q->getColumn(3).getInt64());
+            e.inode     = static_cast<uint64_t>(q->getColumn(4).getInt64());
+            e.hash      = q->getColumn(5).getString();
+            e.cached_ns = q->getColumn(6).getInt64();
+            out.push_back(std::move(e));
+        }
+        return Result::success();
+    }
+    catch (const SQLite::Exception& ex) {
+        return Result::failure(std::string("LoadStatEntries DB error: ") + ex.what());
+    }
+}
+
+Result Repository::SaveStatEntries(const std::vector<StatEntry>& entries)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    if (entries.empty()) return Result::success();
+    try {
+        SQLite::Transaction tx(*db_);
+        for (const auto& e : entries) {
+            Result r = SaveStatEntry(e);
+            if (!r.ok) return r;
+        }
+        tx.commit();
+        return Result::success();
+    }
+    catch (const SQLite::Exception& ex) {
+        return Result::failure(std::string("SaveStatEntries DB error: ") + ex.what());
+    }
+}
+
 // -------------------------------------------------------
 // Blob / thumbnail paths  (files stay on disk)
 // -------------------------------------------------------
@@ -141,8 +779,24 @@ fs::path Repository::BlobPath(const std::string& hash) const {
     return BlobsDir() / (hash + ".bin");
 }
 
+fs::path Repository::ManifestPath(const std::string& hash) const {
+    return BlobsDir() / (hash + ".manifest");
+}
+
+fs::path Repository::TreePath(const std::string& hash) const {
+    return BlobsDir() / (hash + ".tree");
+}
+
+fs::path Repository::DeltaPath(const std::string& hash) const {
+    return BlobsDir() / (hash + ".delta");
+}
+
+fs::path Repository::ChunkPath(const std::string& chunk_hash) const {
+    return ChunksDir() / chunk_hash.substr(0, 2) / chunk_hash;
+}
+
 fs::path Repository::ThumbnailPath(const std::string& hash) const {
-    return repo_root_ / "thumbs" / (hash + ".bmp");
+    return ThumbsDir() / (hash + ".bmp");
 }
 
 // -------------------------------------------------------
@@ -155,32 +809,12 @@ Result Repository::SaveCommit(const Commit& c)
     if (c.hash.empty()) return Result::failure("Commit has no hash");
 
     try {
-        SQLite::Statement q(*db_, R"(
-            INSERT OR REPLACE INTO commits
-                (hash, message, timestamp, author, parent_hash,
-                 doc_path, doc_type, mass, volume, feature_count,
-                 surface_area, material, bbox_x, bbox_y, bbox_z,
-                 config_count, blob_size_bytes)
-            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        )");
-        q.bind(1,  c.hash);
-        q.bind(2,  c.message);
-        q.bind(3,  c.timestamp);
-        q.bind(4,  c.author);
-        q.bind(5,  c.parent_hash);
-        q.bind(6,  c.sw_meta.doc_path);
-        q.bind(7,  c.sw_meta.doc_type);
-        q.bind(8,  c.sw_meta.mass);
-        q.bind(9,  c.sw_meta.volume);
-        q.bind(10, c.sw_meta.feature_count);
-        q.bind(11, c.sw_meta.surface_area);
-        q.bind(12, c.sw_meta.material);
-        q.bind(13, c.sw_meta.bbox_x);
-        q.bind(14, c.sw_meta.bbox_y);
-        q.bind(15, c.sw_meta.bbox_z);
-        q.bind(16, c.sw_meta.config_count);
-        q.bind(17, static_cast<long long>(c.sw_meta.blob_size_bytes));
-        q.exec();
+        int64_t doc_id = DocumentId(c.sw_meta.doc_path, true);
+        auto    q      = Prepare(kInsertCommit);
+        Result  r      = BindCommit(*q, c, doc_id);
+        if (!r.ok) return r;
+        q->exec();
+        if (!c.group_hash.empty()) SetGroup(c);
         return Result::success();
     }
     catch (const SQLite::Exception& e) {
@@ -188,80 +822,562 @@ Result Repository::SaveCommit(const Commit& c)
     }
 }
 
+// A member's group_hash is written by a statement of its own, so
+// that kInsertCommit keeps the v5 columns MigrateToV4 copies into
+// — and a database still short of v7 (see OpenSchema) saves every
+// commit but a group member.  Throws like the statements around it.
+void Repository::SetGroup(const Commit& c)
+{
+    if (version_ < 7)
+        throw SQLite::Exception("group commits need schema v7, this database is v"
+                                + std::to_string(version_), -1);
+    auto q = Prepare("UPDATE commits SET group_hash = ? WHERE hash = ?");
+    if (!BindHash(*q, 1, c.group_hash) || !BindHash(*q, 2, c.hash))
+        throw SQLite::Exception("group hash is not a hex digest: " + c.group_hash, -1);
+    q->exec();
+}
+
+Result Repository::SaveCommits(const std::vector<Commit>& commits, const std::string& head)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+
+    try {
+        SQLite::Transaction tx(*db_);
+        auto q = Prepare(kInsertCommit);
+        for (const Commit& c : commits) {
+            if (c.hash.empty()) return Result::failure("Commit has no hash");
+            Result r = BindCommit(*q, c, DocumentId(c.sw_meta.doc_path, true));
+            if (!r.ok) return r;
+            q->exec();
+            q->reset();
+            if (!c.group_hash.empty()) SetGroup(c);
+        }
+        if (!head.empty()) {
+            Result r = SetHead(head);
+            if (!r.ok) return r;
+        }
+        tx.commit();
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("SaveCommits DB error: ") + e.what());
+    }
+}
+
 // -------------------------------------------------------
-// LoadCommit  (exact hash or 7+ char prefix)
+// LoadCommit  (full hash or unique prefix)
 // -------------------------------------------------------
+// A prefix p is the key range [p000…, (p+1)000…): one seek in
+// the primary key, whatever the history size.  Reading a second
+// row tells a unique prefix from an ambiguous one.
 
-static Commit RowToCommit(SQLite::Statement& q)
+Result Repository::LoadCommit(const std::string& hash_prefix, Commit& out)
 {
-    Commit c;
-    c.hash              = q.getColumn(0).getString();
-    c.message           = q.getColumn(1).getString();
-    c.timestamp         = q.getColumn(2).getString();
-    c.author            = q.getColumn(3).getString();
-    c.parent_hash       = q.getColumn(4).getString();
-    c.sw_meta.doc_path  = q.getColumn(5).getString();
-    c.sw_meta.doc_type  = q.getColumn(6).getString();
-    c.sw_meta.mass      = q.getColumn(7).getDouble();
-    c.sw_meta.volume    = q.getColumn(8).getDouble();
-    c.sw_meta.feature_count  = q.getColumn(9).getInt();
-    c.sw_meta.surface_area   = q.getColumn(10).getDouble();
-    c.sw_meta.material       = q.getColumn(11).getString();
-    c.sw_meta.bbox_x         = q.getColumn(12).getDouble();
-    c.sw_meta.bbox_y         = q.getColumn(13).getDouble();
-    c.sw_meta.bbox_z         = q.getColumn(14).getDouble();
-    c.sw_meta.config_count   = q.getColumn(15).getInt();
-    c.sw_meta.blob_size_bytes = static_cast<int64_t>(q.getColumn(16).getInt64());
-    return c;
+    if (!valid_) return Result::failure("Repository not valid");
+
+    std::string lo = hash_prefix;
+    std::transform(lo.begin(), lo.end(), lo.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    bool hex = std::all_of(lo.begin(), lo.end(),
+                           [](unsigned char ch) { return std::isxdigit(ch) != 0; });
+    if (!hex || lo.size() < kMinHashPrefix || lo.size() > kHashBytes * 2)
+        return Result::failure("Not a commit hash or prefix (" + std::to_string(kMinHashPrefix)
+                               + "-" + std::to_string(kHashBytes * 2) + " hex digits): "
+                               + hash_prefix);
+
+    // hi = prefix + 1; a prefix of all f's has no upper bound
+    std::string hi = lo;
+    int         i  = static_cast<int>(hi.size()) - 1;
+    for (; i >= 0 && hi[i] == 'f'; --i) hi[i] = '0';
+    if (i >= 0) hi[i] = hi[i] == '9' ? 'a' : static_cast<char>(hi[i] + 1);
+    const bool bounded = i >= 0;
+
+    lo.resize(kHashBytes * 2, '0');
+    hi.resize(kHashBytes * 2, '0');
+
+    try {
+        auto q = Prepare(bounded
+            ? "SELECT * FROM commits WHERE hash >= ? AND hash < ? ORDER BY hash LIMIT 2"
+            : "SELECT * FROM commits WHERE hash >= ? ORDER BY hash LIMIT 2");
+        BindHash(*q, 1, lo);
+        if (bounded) BindHash(*q, 2, hi);
+
+        if (!q->executeStep())
+            return Result::failure("No commit found matching: " + hash_prefix);
+        Commit found = RowToCommit(*q);
+        if (q->executeStep())
+            return Result::failure("Ambiguous hash prefix " + hash_prefix + ": matches "
+                                   + found.hash.substr(0, 12) + "..., "
+                                   + ColumnHash(q->getColumn(0)).substr(0, 12)
+                                   + "... and maybe more — use more digits");
+        out = std::move(found);
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("LoadCommit DB error: ") + e.what());
+    }
 }
 
-Result Repository::LoadCommit(const std::string& hash_prefix, Commit& out)
+// -------------------------------------------------------
+// ForEachCommit / ListCommits  (newest first, keyset paging)
+// -------------------------------------------------------
+// Each page is "the next N rows after (time, hash)" — a
+// range scan of commits_by_time that costs the same on page 1
+// and page 1000, unlike OFFSET, which re-reads every skipped row.
+
+Result Repository::QueryCommitPage(const CommitQuery& query, const char* columns,
+                                   const RowReader& row)
+{
+    // One document: the range (doc_id, ...) of commits_by_document
+    int64_t doc_id = 0;
+    if (!query.doc_path.empty()) {
+        doc_id = DocumentId(query.doc_path, false);
+        if (doc_id == 0) return Result::success();   // never committed
+    }
+
+    std::string sql = std::string("SELECT ") + columns + " FROM commits";
+    const char* glue = " WHERE ";
+    if (doc_id != 0) {
+        sql += glue;
+        sql += "doc_id = ?";
+        glue = " AND ";
+    } else if (version_ >= 7) {
+        sql += glue;
+        sql += "group_hash IS NULL";   // the group stands for its members
+        glue = " AND ";
+    }
+    if (query.since != 0) {
+        sql += glue;
+        sql += "time >= ?";
+        glue = " AND ";
+    }
+    if (!query.after.AtStart()) {
+        sql += glue;
+        sql += "(time, hash) < (?, ?)";
+    }
+    sql += " ORDER BY time DESC, hash DESC LIMIT ?";
+
+    auto q = Prepare(sql);
+    int  i = 0;
+    if (doc_id != 0)
+        q->bind(++i, static_cast<long long>(doc_id));
+    if (query.since != 0)
+        q->bind(++i, static_cast<long long>(query.since));
+    if (!query.after.AtStart()) {
+        q->bind(++i, static_cast<long long>(query.after.time));
+        if (!BindHash(*q, ++i, query.after.hash))
+            return Result::failure("bad cursor hash " + query.after.hash);
+    }
+    q->bind(++i, query.limit > 0 ? static_cast<long long>(query.limit) : -1LL);
+
+    while (q->executeStep())
+        row(*q);
+    return Result::success();
+}
+
+std::vector<Commit> Repository::ListCommits(const CommitQuery& query)
+{
+    std::vector<Commit> page;
+    if (!valid_) return page;
+
+    try {
+        Result r = QueryCommitPage(query, "*", [&](SQLite::Statement& q) {
+            page.push_back(RowToCommit(q));
+        });
+        if (!r.ok) std::cerr << "[repo] ListCommits: " << r.err << "\n";
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] ListCommits error: " << e.what() << "\n";
+    }
+    return page;
+}
+
+std::vector<Commit> Repository::ListGroupMembers(const std::string& group_hash)
+{
+    std::vector<Commit> members;
+    if (!valid_ || version_ < 7) return members;
+
+    try {
+        auto q = Prepare("SELECT * FROM commits WHERE group_hash = ? ORDER BY doc_path");
+        if (!BindHash(*q, 1, group_hash)) return members;
+        while (q->executeStep())
+            members.push_back(RowToCommit(*q));
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] ListGroupMembers error: " << e.what() << "\n";
+    }
+    return members;
+}
+
+// Four text columns and a blob per row, copied straight from
+// SQLite's buffers into the arena — no std::string in between
+Result Repository::ListCommitSummaries(const CommitQuery& query, CommitSummaries& out)
 {
     if (!valid_) return Result::failure("Repository not valid");
+
+    auto text = [](const SQLite::Column& col) {
+        return std::string_view(static_cast<const char*>(col.getText()),
+                                static_cast<size_t>(col.getBytes()));
+    };
     try {
-        // Try exact match first
-        {
-            SQLite::Statement q(*db_,
-                "SELECT * FROM commits WHERE hash = ? LIMIT 1");
-            q.bind(1, hash_prefix);
-            if (q.executeStep()) {
-                out = RowToCommit(q);
-                return Result::success();
-            }
+        if (query.limit > 0) out.rows.reserve(out.rows.size() + query.limit);
+        return QueryCommitPage(query, "hash, timestamp, message, author, time",
+                               [&](SQLite::Statement& q) {
+            CommitSummary row;
+            SQLite::Column hash = q.getColumn(0);
+            auto           len  = static_cast<size_t>(hash.getBytes());
+            char*          hex  = out.strings.Allocate(2 * len);
+            Utils::ToHex(static_cast<const uint8_t*>(hash.getBlob()), len, hex);
+            row.hash      = {hex, 2 * len};
+            row.timestamp = out.strings.Add(text(q.getColumn(1)));
+            row.message   = out.strings.Add(text(q.getColumn(2)));
+            row.author    = out.strings.Intern(text(q.getColumn(3)));
+            row.time      = static_cast<int64_t>(q.getColumn(4).getInt64());
+            out.rows.push_back(row);
+        });
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("ListCommitSummaries DB error: ") + e.what());
+    }
+}
+
+Result Repository::ForEachCommit(const CommitQuery& query, const CommitVisitor& fn,
+                                 CommitCursor* last)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+
+    CommitQuery page_query = query;
+    size_t      left       = query.limit;
+    while (query.limit == 0 || left > 0) {
+        page_query.limit = query.limit == 0 ? kCommitPage : std::min(left, kCommitPage);
+
+        // The page is read and its statement reset before fn runs,
+        // so no read transaction stays open while the caller works
+        std::vector<Commit> page = ListCommits(page_query);
+        for (const auto& c : page) {
+            page_query.after = {c.time, c.hash};
+            if (last) *last = page_query.after;
+            if (!fn(c)) return Result::success();
         }
-        // Fall back to prefix match
-        {
-            SQLite::Statement q(*db_,
-                "SELECT * FROM commits WHERE hash LIKE ? LIMIT 1");
-            q.bind(1, hash_prefix + "%");
-            if (q.executeStep()) {
-                out = RowToCommit(q);
-                return Result::success();
-            }
+        if (page.size() < page_query.limit) break;   // history exhausted
+        if (query.limit > 0) left -= page.size();
+    }
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// SearchCommits  (commits_fts)
+// -------------------------------------------------------
+
+// Free text -> FTS5 query: every word becomes a quoted prefix
+// ("fillet" also finds "fillets") and every "quoted phrase" an
+// exact phrase, so operators and punctuation typed by the user are
+// searched for, never parsed.  "" if nothing searchable.
+static std::string FtsQuery(const std::string& text)
+{
+    std::string query;
+    auto add = [&](const std::string& term, bool phrase) {
+        if (std::none_of(term.begin(), term.end(),
+                         [](unsigned char ch) { return std::isalnum(ch) || ch >= 0x80; }))
+            return;   // no token in it — FTS5 rejects an empty phrase
+        if (!query.empty()) query += ' ';
+        query += '"';
+        for (char ch : term) {
+            if (ch == '"') query += '"';
+            query += ch;
+        }
+        query += phrase ? "\"" : "\"*";
+    };
+
+    std::string term;
+    bool        quoted = false;
+    for (char ch : text) {
+        if (ch == '"' || (!quoted && std::isspace(static_cast<unsigned char>(ch)))) {
+            add(term, quoted);
+            term.clear();
+            if (ch == '"') quoted = !quoted;
+        } else {
+            term += ch;
+        }
+    }
+    add(term, quoted);
+    return query;
+}
+
+static constexpr long long kRankWindow = 2000;
+
+std::vector<Commit> Repository::SearchCommits(const std::string& text, const CommitQuery& query)
+{
+    std::vector<Commit> found;
+    if (!valid_) return found;
+
+    std::string match = FtsQuery(text);
+    if (match.empty()) return found;
+
+    try {
+        int64_t doc_id = 0;
+        if (!query.doc_path.empty()) {
+            doc_id = DocumentId(query.doc_path, false);
+            if (doc_id == 0) return found;
+        }
+
+        const long long limit = query.limit > 0 ? static_cast<long long>(query.limit) : -1LL;
+
+        std::string sql;
+        if (doc_id == 0 && query.since == 0) {
+            // Ranked inside FTS5 (ORDER BY rank, see MigrateToV6) and
+            // only then joined, so commits rows are read for the best
+            // few alone.  bm25 costs about as much per matching row as
+            // the rest of the query, so a word matching much of the
+            // history is ranked among its newest kRankWindow matches
+            // only — older ones show up as the search gets specific.
+            sql = R"(
+                SELECT c.* FROM (
+                    SELECT rowid, rank FROM commits_fts
+                    WHERE commits_fts MATCH ?1
+                      AND rowid >= coalesce((SELECT rowid FROM commits_fts
+                                             WHERE commits_fts MATCH ?1
+                                             ORDER BY rowid DESC LIMIT 1 OFFSET ?2), 0)
+                    ORDER BY rank LIMIT ?3) AS f
+                JOIN commits c ON c.rowid = f.rowid
+                ORDER BY f.rank)";
+            auto q = Prepare(sql);
+            q->bind(1, match);
+            q->bind(2, limit < 0 ? std::numeric_limits<long long>::max()
+                                 : std::max(kRankWindow, limit) - 1);
+            q->bind(3, limit);
+            while (q->executeStep())
+                found.push_back(RowToCommit(*q));
+            return found;
         }
-        return Result::failure("No commit found matching: " + hash_prefix);
+
+        sql = "SELECT c.* FROM commits_fts JOIN commits c ON c.rowid = commits_fts.rowid"
+              " WHERE commits_fts MATCH ?";
+        if (doc_id != 0)      sql += " AND c.doc_id = ?";
+        if (query.since != 0) sql += " AND c.time >= ?";
+        sql += " ORDER BY commits_fts.rank LIMIT ?";
+
+        auto q = Prepare(sql);
+        int  i = 0;
+        q->bind(++i, match);
+        if (doc_id != 0)
+            q->bind(++i, static_cast<long long>(doc_id));
+        if (query.since != 0)
+            q->bind(++i, static_cast<long long>(query.since));
+        q->bind(++i, limit);
+
+        while (q->executeStep())
+            found.push_back(RowToCommit(*q));
     }
     catch (const SQLite::Exception& e) {
-        return Result::failure(std::string("LoadCommit DB error: ") + e.what());
+        std::cerr << "[repo] SearchCommits error: " << e.what() << "\n";
     }
+    return found;
+}
+
+int64_t Repository::CommitCount()
+{
+    if (!valid_) return 0;
+    try {
+        auto q = Prepare("SELECT COUNT(*) FROM commits");
+        if (q->executeStep())
+            return q->getColumn(0).getInt64();
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] CommitCount error: " << e.what() << "\n";
+    }
+    return 0;
 }
 
 // -------------------------------------------------------
-// ListCommits  (newest first)
+// Documents
 // -------------------------------------------------------
 
-std::vector<Commit> Repository::ListCommits()
+std::string Repository::DocumentKey(const std::string& path)
+{
+    // Lexical only: the repository may be opened where the path
+    // doesn't exist, or on another OS than the one that wrote it
+    std::string key = fs::path(path).lexically_normal().make_preferred().string();
+#ifdef _WIN32
+    // NTFS paths are case-insensitive
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+#endif
+    return key;
+}
+
+std::string Repository::GroupIdText(const Commit& group, const std::vector<Commit>& members)
+{
+    std::vector<const Commit*> sorted;
+    for (const auto& m : members) sorted.push_back(&m);
+    std::sort(sorted.begin(), sorted.end(), [](const Commit* a, const Commit* b) {
+        return a->sw_meta.doc_path < b->sw_meta.doc_path;
+    });
+    std::string id = "group\nparent " + group.parent_hash + "\ntime " + group.timestamp + "\n";
+    for (const Commit* m : sorted)
+        id += m->hash + " " + DocumentKey(m->sw_meta.doc_path) + "\n";
+    return id + "\n" + group.message;
+}
+
+// Throws SQLite::Exception (callers are inside a try)
+int64_t Repository::DocumentId(const std::string& path, bool create)
 {
-    std::vector<Commit> commits;
-    if (!valid_) return commits;
+    if (path.empty()) return 0;
+    std::string key = DocumentKey(path);
+    if (create) {
+        auto q = Prepare("INSERT OR IGNORE INTO documents (key, path) VALUES (?, ?)");
+        q->bind(1, key);
+        q->bind(2, path);
+        q->exec();
+    }
+    auto q = Prepare("SELECT id FROM documents WHERE key = ?");
+    q->bind(1, key);
+    return q->executeStep() ? static_cast<int64_t>(q->getColumn(0).getInt64()) : 0;
+}
+
+int64_t Repository::FindDocument(const std::string& path)
+{
+    if (!valid_) return 0;
     try {
-        SQLite::Statement q(*db_,
-            "SELECT * FROM commits ORDER BY timestamp DESC");
-        while (q.executeStep())
-            commits.push_back(RowToCommit(q));
+        return DocumentId(path, false);
     }
     catch (const SQLite::Exception& e) {
-        std::cerr << "[repo] ListCommits error: " << e.what() << "\n";
+        std::cerr << "[repo] FindDocument error: " << e.what() << "\n";
+        return 0;
+    }
+}
+
+std::vector<Document> Repository::ListDocuments()
+{
+    std::vector<Document> docs;
+    if (!valid_) return docs;
+    try {
+        // Counted from commits_by_document alone (no table reads)
+        auto q = Prepare(R"(
+            SELECT d.id, d.path,
+                   (SELECT COUNT(*) FROM commits c WHERE c.doc_id = d.id)
+            FROM documents d ORDER BY d.path
+        )");
+        while (q->executeStep()) {
+            Document d;
+            d.id      = static_cast<int64_t>(q->getColumn(0).getInt64());
+            d.path    = q->getColumn(1).getString();
+            d.commits = static_cast<int64_t>(q->getColumn(2).getInt64());
+            docs.push_back(std::move(d));
+        }
+    }
+    catch (const SQLite::Exception& e) {
+        std::cerr << "[repo] ListDocuments error: " << e.what() << "\n";
+    }
+    return docs;
+}
+
+// -------------------------------------------------------
+// ForEachCommitLink  (CommitGraph input)
+// -------------------------------------------------------
+
+Result Repository::ForEachCommitLink(int64_t after_seq, const LinkVisitor& fn)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        auto q = Prepare(
+            "SELECT rowid, hash, parent_hash, time FROM commits WHERE rowid > ? ORDER BY rowid");
+        q->bind(1, static_cast<long long>(after_seq));
+        CommitLink link;
+        while (q->executeStep()) {
+            link.seq    = static_cast<int64_t>(q->getColumn(0).getInt64());
+            link.hash   = q->getColumn(1).getString();
+            link.parent = q->getColumn(2).getString();   // NULL reads as ""
+            link.time   = static_cast<int64_t>(q->getColumn(3).getInt64());
+            fn(link);
+        }
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("ForEachCommitLink DB error: ") + e.what());
+    }
+}
+
+// -------------------------------------------------------
+// ForEachCommitMetrics  (TrendCache input)
+// -------------------------------------------------------
+
+Result Repository::ForEachCommitMetrics(int64_t after_seq, const MetricsVisitor& fn)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        // Column order = Metric
+        auto q = Prepare(R"(
+            SELECT rowid, doc_id, time, hash,
+                   mass, volume, surface_area, bbox_x, bbox_y, bbox_z, feature_count
+            FROM commits WHERE rowid > ? ORDER BY rowid
+        )");
+        q->bind(1, static_cast<long long>(after_seq));
+        CommitMetrics m;
+        while (q->executeStep()) {
+            m.seq    = static_cast<int64_t>(q->getColumn(0).getInt64());
+            m.doc_id = static_cast<int64_t>(q->getColumn(1).getInt64());   // NULL reads as 0
+            m.time   = static_cast<int64_t>(q->getColumn(2).getInt64());
+            m.hash   = ColumnHash(q->getColumn(3));
+            for (size_t i = 0; i < kMetricCount; ++i)
+                m.values[i] = q->getColumn(static_cast<int>(4 + i)).getDouble();
+            fn(m);
+        }
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("ForEachCommitMetrics DB error: ") + e.what());
+    }
+}
+
+// -------------------------------------------------------
+// RewriteHashes  (hash algorithm migration)
+// -------------------------------------------------------
+
+Result Repository::RewriteHashes(
+    const std::vector<std::pair<std::string, std::string>>& old_to_new, HashAlgo algo)
+{
+    if (!valid_) return Result::failure("Repository not valid");
+    try {
+        SQLite::Transaction tx(*db_);
+
+        SQLite::Statement set_hash(*db_,
+            "UPDATE commits SET hash = ? WHERE hash = ?");
+        SQLite::Statement set_parent(*db_,
+            "UPDATE commits SET parent_hash = ? WHERE parent_hash = ?");
+        SQLite::Statement set_group(*db_,
+            "UPDATE commits SET group_hash = ? WHERE group_hash = ?");
+        SQLite::Statement set_head(*db_,
+            "UPDATE config SET value = ? WHERE key = 'HEAD' AND value = ?");
+
+        for (const auto& [from, to] : old_to_new) {
+            for (auto* q : {&set_hash, &set_parent, &set_group}) {
+                if (!BindHash(*q, 1, to) || !BindHash(*q, 2, from))
+                    return Result::failure("RewriteHashes: not a hex digest: " + from + " -> " + to);
+                q->exec();
+                q->reset();
+            }
+            set_head.bind(1, to);          // HEAD stays hex text
+            set_head.bind(2, from);
+            set_head.exec();
+            set_head.reset();
+        }
+
+        db_->exec("DELETE FROM stat_cache");
+
+        SQLite::Statement set_algo(*db_,
+            "INSERT OR REPLACE INTO config (key, value) VALUES ('hash_algo', ?)");
+        set_algo.bind(1, HashAlgoName(algo));
+        set_algo.exec();
+
+        tx.commit();
+        hash_algo_ = algo;
+
+        std::error_code ec;
+        fs::remove(CommitGraphPath(), ec);   // rebuilt on next use
+        return Result::success();
+    }
+    catch (const SQLite::Exception& e) {
+        return Result::failure(std::string("RewriteHashes DB error: ") + e.what());
     }
-    return commits;
 }
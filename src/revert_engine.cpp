@@ -1,4 +1,9 @@
 #include "revert_engine.h"
+#include "blob_store.h"
+#include "stat_cache.h"
+
+#include "utils.h"
+
 #include <filesystem>
 #include <iostream>
 
@@ -13,8 +18,11 @@ Result RevertEngine::Revert(const std::string& hash_prefix) {
     Result r = repo_.LoadCommit(hash_prefix, target);
     if (!r.ok) return r;
 
-    fs::path blob_path = repo_.BlobPath(target.hash);
-    if (!fs::exists(blob_path))
+    if (target.IsGroup()) return RevertGroup(target);
+    if (target.IsTree())  return RevertTree(target);
+
+    BlobStore store(repo_);
+    if (!store.Has(target.hash))
         return Result::failure("Blob missing for commit " + target.hash.substr(0,8)
                                + " — was the repo moved?");
 
@@ -38,13 +46,12 @@ Result RevertEngine::Revert(const std::string& hash_prefix) {
         }
     }
 
-    // 3. Overwrite working file with blob
-    std::error_code ec;
-    fs::copy_file(blob_path, doc_path, fs::copy_options::overwrite_existing, ec);
-    if (ec)
-        return Result::failure("Failed to restore file: " + ec.message());
+    // 3. Overwrite working file with the stored snapshot
+    std::string method;
+    r = store.Restore(target.hash, doc_path, &method);
+    if (!r.ok) return r;
 
-    std::cout << "[revert] Restored: " << doc_path.string() << "\n";
+    std::cout << "[revert] Restored: " << doc_path.string() << " (via " << method << ")\n";
 
     // 4. Reopen in SolidWorks
     if (sw_.IsConnected() && doc_was_open) {
@@ -61,3 +68,102 @@ Result RevertEngine::Revert(const std::string& hash_prefix) {
     std::cout << "[revert] Done. HEAD is now " << target.hash.substr(0,8) << "\n";
     return Result::success();
 }
+
+// -------------------------------------------------------
+// RevertGroup / RevertTree
+// -------------------------------------------------------
+
+Result RevertEngine::RevertGroup(const Commit& group) {
+    std::vector<FileVersion> files;
+    for (const auto& m : repo_.ListGroupMembers(group.hash))
+        files.push_back({ m.hash, m.sw_meta.doc_path });
+    if (files.empty())
+        return Result::failure("Group commit " + group.hash.substr(0,8) + " has no files");
+
+    std::cout << "[revert] Reverting " << files.size() << " files to group commit "
+              << group.hash.substr(0,8) << " \"" << group.message << "\"\n";
+    return RestoreAll(group, files);
+}
+
+Result RevertEngine::RevertTree(const Commit& tree_commit) {
+    BlobStore store(repo_);
+    Tree      tree;
+    Result r = store.LoadTree(tree_commit.hash, tree);
+    if (!r.ok) return r;
+
+    // Only files that differ from the snapshot: the stat cache
+    // vouches for the rest without reading them
+    StatCache stat_cache(repo_);
+    r = stat_cache.Preload();
+    if (!r.ok) return r;
+    std::vector<FileVersion> files;
+    for (const auto& e : tree) {
+        fs::path path = repo_.ProjectDir() / fs::path(e.path);
+        if (stat_cache.Lookup(path, StatCache::Stat(path)) != e.hash)
+            files.push_back({ e.hash, path.string() });
+    }
+
+    std::cout << "[revert] Reverting to project snapshot " << tree_commit.hash.substr(0,8)
+              << " \"" << tree_commit.message << "\": " << files.size() << " of "
+              << tree.size() << " files differ\n";
+    return RestoreAll(tree_commit, files);
+}
+
+// -------------------------------------------------------
+// RestoreAll — several files, then HEAD
+// -------------------------------------------------------
+
+Result RevertEngine::RestoreAll(const Commit& target, const std::vector<FileVersion>& files) {
+    // Check every snapshot first: better to restore none than half
+    BlobStore store(repo_);
+    for (const auto& f : files)
+        if (!store.Has(f.hash))
+            return Result::failure("Blob missing for " + f.path + " (snapshot "
+                                   + f.hash.substr(0,8) + ") — was the repo moved?");
+
+    // Close the files open in SolidWorks, remembering which was
+    // active so it can be reopened last (and so be active again)
+    std::vector<std::string> reopen;
+    std::string              active;
+    if (sw_.IsConnected() && !files.empty()) {
+        ActiveDocInfo info;
+        if (sw_.GetActiveDocInfo(info).ok) active = info.path;
+
+        std::vector<ActiveDocInfo> open;
+        sw_.ListOpenDocs(open);
+        for (const auto& doc : open) {
+            bool restored = false;
+            for (const auto& f : files)
+                restored = restored || Utils::IEquals(f.path, doc.path);
+            if (!restored) continue;
+
+            std::cout << "[revert] Closing " << doc.path << " in SolidWorks...\n";
+            Result cr = sw_.CloseDoc(doc.path);
+            if (!cr.ok)
+                std::cerr << "[revert] Warning: could not close " << doc.path << ": " << cr.err
+                          << "\n         Attempting to overwrite anyway.\n";
+            if (Utils::IEquals(doc.path, active)) reopen.push_back(doc.path);
+            else                                   reopen.insert(reopen.begin(), doc.path);
+        }
+    }
+
+    for (const auto& f : files) {
+        std::string method;
+        Result r = store.Restore(f.hash, f.path, &method);
+        if (!r.ok) return Result::failure(f.path + ": " + r.err);
+        std::cout << "[revert] Restored: " << f.path << " (via " << method << ")\n";
+    }
+
+    for (const auto& path : reopen) {
+        std::cout << "[revert] Reopening " << path << " in SolidWorks...\n";
+        Result or_ = sw_.OpenDoc(path);
+        if (!or_.ok)
+            std::cerr << "[revert] Warning: could not reopen " << path << ": " << or_.err << "\n";
+    }
+
+    Result r = repo_.SetHead(target.hash);
+    if (!r.ok) return r;
+
+    std::cout << "[revert] Done. HEAD is now " << target.hash.substr(0,8) << "\n";
+    return Result::success();
+}
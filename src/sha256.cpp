@@ -0,0 +1,476 @@
+#include "sha256.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SWVCS_SHA256_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define SWVCS_TARGET(x)
+    #else
+        #include <cpuid.h>
+        #define SWVCS_TARGET(x) __attribute__((target(x)))
+    #endif
+#endif
+
+// -------------------------------------------------------
+// Constants
+// -------------------------------------------------------
+
+alignas(16) static const uint32_t kK[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t kInit[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t LoadBE32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static inline void StoreBE32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v);
+}
+
+// -------------------------------------------------------
+// Scalar compression (portable fallback)
+// -------------------------------------------------------
+
+static inline uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static void CompressScalar(uint32_t state[8], const uint8_t* data, size_t nblocks) {
+    uint32_t w[64];
+    for (; nblocks > 0; --nblocks, data += 64) {
+        for (int t = 0; t < 16; ++t)
+            w[t] = LoadBE32(data + 4 * t);
+        for (int t = 16; t < 64; ++t) {
+            uint32_t s0 = Rotr(w[t-15], 7) ^ Rotr(w[t-15], 18) ^ (w[t-15] >> 3);
+            uint32_t s1 = Rotr(w[t-2], 17) ^ Rotr(w[t-2], 19)  ^ (w[t-2] >> 10);
+            w[t] = w[t-16] + s0 + w[t-7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; ++t) {
+            uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25))
+                            + ((e & f) ^ (~e & g)) + kK[t] + w[t];
+            uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22))
+                            + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef SWVCS_SHA256_X86
+
+// -------------------------------------------------------
+// CPU feature detection
+// -------------------------------------------------------
+
+struct CpuFeatures {
+    bool sha_ni = false;
+    bool avx2   = false;
+};
+
+static void Cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#if defined(_MSC_VER)
+    int x[4];
+    __cpuidex(x, static_cast<int>(leaf), static_cast<int>(sub));
+    for (int i = 0; i < 4; ++i) r[i] = static_cast<unsigned>(x[i]);
+#else
+    r[0] = r[1] = r[2] = r[3] = 0;
+    __get_cpuid_count(leaf, sub, &r[0], &r[1], &r[2], &r[3]);
+#endif
+}
+
+static uint64_t Xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (uint64_t(hi) << 32) | lo;
+#endif
+}
+
+static CpuFeatures DetectCpu() {
+    CpuFeatures f;
+    unsigned r1[4], r7[4];
+    Cpuid(0, 0, r1);
+    if (r1[0] < 7) return f;
+
+    Cpuid(1, 0, r1);
+    Cpuid(7, 0, r7);
+    bool ssse3   = (r1[2] >> 9)  & 1;
+    bool sse41   = (r1[2] >> 19) & 1;
+    bool osxsave = (r1[2] >> 27) & 1;
+    bool avx     = (r1[2] >> 28) & 1;
+
+    f.sha_ni = ssse3 && sse41 && ((r7[1] >> 29) & 1);
+
+    // AVX2 also needs the OS to save YMM state across context switches
+    if (osxsave && avx && ((Xgetbv0() & 0x6) == 0x6))
+        f.avx2 = (r7[1] >> 5) & 1;
+    return f;
+}
+
+// -------------------------------------------------------
+// SHA-NI compression (Intel SHA extensions)
+// -------------------------------------------------------
+// State is kept as ABEF / CDGH as the sha256rnds2 instruction
+// expects.  Each QUAD does four rounds and schedules the message
+// words needed three quads later.
+
+#define SHA_QUAD(i, cur, prev, next)                                              \
+    MSG    = _mm_add_epi32(cur, _mm_load_si128(reinterpret_cast<const __m128i*>(&kK[4 * (i)]))); \
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);                          \
+    if ((i) >= 3 && (i) <= 14) {                                                  \
+        TMP  = _mm_alignr_epi8(cur, prev, 4);                                     \
+        next = _mm_sha256msg2_epu32(_mm_add_epi32(next, TMP), cur);               \
+    }                                                                             \
+    MSG    = _mm_shuffle_epi32(MSG, 0x0E);                                        \
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);                          \
+    if ((i) >= 1 && (i) <= 12)                                                    \
+        prev = _mm_sha256msg1_epu32(prev, cur);
+
+SWVCS_TARGET("sha,sse4.1,ssse3")
+static void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t nblocks) {
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i TMP    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i STATE1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    TMP            = _mm_shuffle_epi32(TMP, 0xB1);           // CDAB
+    STATE1         = _mm_shuffle_epi32(STATE1, 0x1B);        // EFGH
+    __m128i STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);        // ABEF
+    STATE1         = _mm_blend_epi16(STATE1, TMP, 0xF0);     // CDGH
+
+    for (; nblocks > 0; --nblocks, data += 64) {
+        const __m128i ABEF_SAVE = STATE0;
+        const __m128i CDGH_SAVE = STATE1;
+        __m128i MSG;
+
+        __m128i M0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data +  0)), MASK);
+        __m128i M1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), MASK);
+        __m128i M2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), MASK);
+        __m128i M3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), MASK);
+
+        SHA_QUAD( 0, M0, M3, M1)  SHA_QUAD( 1, M1, M0, M2)
+        SHA_QUAD( 2, M2, M1, M3)  SHA_QUAD( 3, M3, M2, M0)
+        SHA_QUAD( 4, M0, M3, M1)  SHA_QUAD( 5, M1, M0, M2)
+        SHA_QUAD( 6, M2, M1, M3)  SHA_QUAD( 7, M3, M2, M0)
+        SHA_QUAD( 8, M0, M3, M1)  SHA_QUAD( 9, M1, M0, M2)
+        SHA_QUAD(10, M2, M1, M3)  SHA_QUAD(11, M3, M2, M0)
+        SHA_QUAD(12, M0, M3, M1)  SHA_QUAD(13, M1, M0, M2)
+        SHA_QUAD(14, M2, M1, M3)  SHA_QUAD(15, M3, M2, M0)
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    }
+
+    TMP    = _mm_shuffle_epi32(STATE0, 0x1B);                // FEBA
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);                // DCHG
+    STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0);             // DCBA
+    STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);                // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), STATE0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), STATE1);
+}
+
+#undef SHA_QUAD
+
+// -------------------------------------------------------
+// AVX2 8-lane compression (multi-buffer)
+// -------------------------------------------------------
+// Eight independent messages advance one block each per
+// iteration; lane j of every vector belongs to message j.
+// states[j] is the state of lane j.
+
+template <int N>
+SWVCS_TARGET("avx2")
+static inline __m256i Rotr8(__m256i x) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, N), _mm256_slli_epi32(x, 32 - N));
+}
+
+SWVCS_TARGET("avx2")
+static void CompressAvx2x8(uint32_t states[8][8], const uint8_t* const data[8], size_t nblocks) {
+    __m256i s[8];
+    for (int i = 0; i < 8; ++i)
+        s[i] = _mm256_setr_epi32(states[0][i], states[1][i], states[2][i], states[3][i],
+                                 states[4][i], states[5][i], states[6][i], states[7][i]);
+
+    __m256i w[16];
+    for (size_t blk = 0; blk < nblocks; ++blk) {
+        const size_t off = blk * 64;
+        for (int t = 0; t < 16; ++t) {
+            const size_t o = off + 4 * t;
+            w[t] = _mm256_setr_epi32(
+                int(LoadBE32(data[0] + o)), int(LoadBE32(data[1] + o)),
+                int(LoadBE32(data[2] + o)), int(LoadBE32(data[3] + o)),
+                int(LoadBE32(data[4] + o)), int(LoadBE32(data[5] + o)),
+                int(LoadBE32(data[6] + o)), int(LoadBE32(data[7] + o)));
+        }
+
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+        __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int t = 0; t < 64; ++t) {
+            if (t >= 16) {
+                __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+                __m256i s0  = _mm256_xor_si256(_mm256_xor_si256(Rotr8<7>(w15), Rotr8<18>(w15)),
+                                               _mm256_srli_epi32(w15, 3));
+                __m256i s1  = _mm256_xor_si256(_mm256_xor_si256(Rotr8<17>(w2), Rotr8<19>(w2)),
+                                               _mm256_srli_epi32(w2, 10));
+                w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0),
+                                             _mm256_add_epi32(w[(t - 7) & 15], s1));
+            }
+            __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(Rotr8<6>(e), Rotr8<11>(e)), Rotr8<25>(e));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1),
+                         _mm256_add_epi32(_mm256_add_epi32(ch, w[t & 15]),
+                                          _mm256_set1_epi32(int(kK[t]))));
+            __m256i S0  = _mm256_xor_si256(_mm256_xor_si256(Rotr8<2>(a), Rotr8<13>(a)), Rotr8<22>(a));
+            __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b),
+                                          _mm256_and_si256(c, _mm256_or_si256(a, b)));
+            __m256i t2  = _mm256_add_epi32(S0, maj);
+            h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+            d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+        }
+        s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+        s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+        s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+        s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    }
+
+    alignas(32) uint32_t lanes[8];
+    for (int i = 0; i < 8; ++i) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), s[i]);
+        for (int j = 0; j < 8; ++j) states[j][i] = lanes[j];
+    }
+}
+
+#endif // SWVCS_SHA256_X86
+
+// -------------------------------------------------------
+// Dispatch
+// -------------------------------------------------------
+
+using CompressFn = void (*)(uint32_t state[8], const uint8_t* data, size_t nblocks);
+
+struct Dispatch {
+    Sha256Impl impl     = Sha256Impl::Scalar;
+    CompressFn compress = CompressScalar;
+};
+
+static Dispatch MakeDispatch(Sha256Impl impl) {
+    Dispatch d;
+    d.impl = impl;
+#ifdef SWVCS_SHA256_X86
+    if (impl == Sha256Impl::ShaNi) d.compress = CompressShaNi;
+#endif
+    return d;
+}
+
+static Dispatch& Current() {
+    static Dispatch d = MakeDispatch(
+        Sha256::Supported(Sha256Impl::ShaNi) ? Sha256Impl::ShaNi :
+        Sha256::Supported(Sha256Impl::Avx2)  ? Sha256Impl::Avx2  :
+                                               Sha256Impl::Scalar);
+    return d;
+}
+
+bool Sha256::Supported(Sha256Impl impl) {
+#ifdef SWVCS_SHA256_X86
+    static const CpuFeatures cpu = DetectCpu();
+    switch (impl) {
+        case Sha256Impl::Scalar: return true;
+        case Sha256Impl::Avx2:   return cpu.avx2;
+        case Sha256Impl::ShaNi:  return cpu.sha_ni;
+    }
+    return false;
+#else
+    return impl == Sha256Impl::Scalar;
+#endif
+}
+
+bool Sha256::Force(Sha256Impl impl) {
+    if (!Supported(impl)) return false;
+    Current() = MakeDispatch(impl);
+    return true;
+}
+
+Sha256Impl Sha256::Active() { return Current().impl; }
+
+const char* Sha256::Name(Sha256Impl impl) {
+    switch (impl) {
+        case Sha256Impl::Scalar: return "scalar";
+        case Sha256Impl::Avx2:   return "avx2";
+        case Sha256Impl::ShaNi:  return "sha-ni";
+    }
+    return "?";
+}
+
+// -------------------------------------------------------
+// Streaming interface
+// -------------------------------------------------------
+
+Sha256::Sha256() {
+    std::memcpy(state_, kInit, sizeof(state_));
+}
+
+void Sha256::Update(const void* data, size_t len) {
+    auto*      p        = static_cast<const uint8_t*>(data);
+    CompressFn compress = Current().compress;
+    total_ += len;
+
+    if (block_len_ > 0) {
+        size_t take = std::min(len, 64 - block_len_);
+        std::memcpy(block_ + block_len_, p, take);
+        block_len_ += take;
+        p   += take;
+        len -= take;
+        if (block_len_ < 64) return;
+        compress(state_, block_, 1);
+        block_len_ = 0;
+    }
+
+    // Whole blocks straight from the caller's buffer — no copy
+    if (len >= 64) {
+        compress(state_, p, len / 64);
+        p   += len & ~size_t(63);
+        len &= 63;
+    }
+
+    if (len > 0) {
+        std::memcpy(block_, p, len);
+        block_len_ = len;
+    }
+}
+
+Sha256::Digest Sha256::Final() {
+    const uint64_t bits = total_ * 8;
+
+    // Padding: 0x80, zeros, then the 64-bit big-endian bit length
+    uint8_t pad[72] = {0x80};
+    size_t  pad_len = (block_len_ < 56) ? (56 - block_len_) : (120 - block_len_);
+    for (int i = 0; i < 8; ++i)
+        pad[pad_len + i] = uint8_t(bits >> (56 - 8 * i));
+    Update(pad, pad_len + 8);
+
+    Digest out;
+    for (int i = 0; i < 8; ++i)
+        StoreBE32(out.data() + 4 * i, state_[i]);
+    return out;
+}
+
+std::string Sha256::HexDigest() {
+    Digest d = Final();
+    return Utils::ToHex(d.data(), d.size());
+}
+
+std::string Sha256::Of(const void* data, size_t len) {
+    Sha256 h;
+    h.Update(data, len);
+    return h.HexDigest();
+}
+
+// -------------------------------------------------------
+// HashMany
+// -------------------------------------------------------
+// AVX2 path: eight lanes each hold one message.  All lanes run
+// for as many blocks as the shortest one has left; a lane whose
+// message has no whole blocks left is finished on the scalar path
+// (its tail is < 64 bytes) and refilled with the next message, so
+// messages of different lengths keep every lane busy.
+
+void Sha256::HashMany(const uint8_t* const* data, const size_t* lens,
+                      size_t count, Digest* out) {
+#ifdef SWVCS_SHA256_X86
+    if (Current().impl == Sha256Impl::Avx2 && count > 1) {
+        struct Lane {
+            size_t         msg    = 0;       // index into data/lens/out
+            const uint8_t* ptr    = nullptr;
+            size_t         blocks = 0;       // whole blocks still to do
+            bool           active = false;
+        };
+        Lane     lanes[8];
+        uint32_t states[8][8];
+        size_t   next = 0;
+
+        auto finish = [&](int j) {
+            Lane&  l = lanes[j];
+            Sha256 h;
+            std::memcpy(h.state_, states[j], sizeof(h.state_));
+            h.total_ = lens[l.msg] & ~size_t(63);
+            h.Update(l.ptr, lens[l.msg] & 63);
+            out[l.msg] = h.Final();
+            l.active = false;
+        };
+        auto refill = [&](int j) {
+            // Messages shorter than a block never enter a lane
+            while (next < count && lens[next] < 64) {
+                Sha256 h;
+                h.Update(data[next], lens[next]);
+                out[next] = h.Final();
+                ++next;
+            }
+            if (next == count) return;
+            Lane& l = lanes[j];
+            l.msg    = next++;
+            l.ptr    = data[l.msg];
+            l.blocks = lens[l.msg] / 64;
+            l.active = true;
+            std::memcpy(states[j], kInit, sizeof(states[j]));
+        };
+
+        for (int j = 0; j < 8; ++j) refill(j);
+
+        for (;;) {
+            size_t run = SIZE_MAX;
+            int    any = -1;
+            for (int j = 0; j < 8; ++j) {
+                if (!lanes[j].active) continue;
+                run = std::min(run, lanes[j].blocks);
+                any = j;
+            }
+            if (any < 0) break;
+
+            // Idle lanes shadow an active one; their results are ignored
+            const uint8_t* ptrs[8];
+            for (int j = 0; j < 8; ++j)
+                ptrs[j] = lanes[j].active ? lanes[j].ptr : lanes[any].ptr;
+            CompressAvx2x8(states, ptrs, run);
+
+            for (int j = 0; j < 8; ++j) {
+                if (!lanes[j].active) continue;
+                lanes[j].ptr    += run * 64;
+                lanes[j].blocks -= run;
+                if (lanes[j].blocks == 0) {
+                    finish(j);
+                    refill(j);
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i) {
+        Sha256 h;
+        h.Update(data[i], lens[i]);
+        out[i] = h.Final();
+    }
+}
@@ -0,0 +1,195 @@
+#include "stat_cache.h"
+#include "repository.h"
+#include "content_hash.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+StatCache::StatCache(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Stat / NowNs
+// -------------------------------------------------------
+
+#ifdef _WIN32
+
+namespace {
+
+// FILETIME counts 100 ns ticks since 1601-01-01
+int64_t FileTimeToUnixNs(const FILETIME& ft) {
+    constexpr int64_t kEpochDiff = 116444736000000000LL;
+    int64_t ticks = (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    return (ticks - kEpochDiff) * 100;
+}
+
+} // namespace
+
+FileStat StatCache::Stat(const fs::path& path) {
+    FileStat st;
+    HANDLE h = CreateFileW(path.wstring().c_str(), FILE_READ_ATTRIBUTES,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return st;
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(h, &info)) {
+        st.valid    = true;
+        st.size     = (static_cast<int64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        st.mtime_ns = FileTimeToUnixNs(info.ftLastWriteTime);
+        st.device   = info.dwVolumeSerialNumber;
+        st.inode    = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    }
+    CloseHandle(h);
+    return st;
+}
+
+int64_t StatCache::NowNs() {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return FileTimeToUnixNs(ft);
+}
+
+#else
+
+FileStat StatCache::Stat(const fs::path& path) {
+    FileStat    st;
+    struct stat s;
+    if (::stat(path.c_str(), &s) != 0) return st;
+
+#ifdef __APPLE__
+    const struct timespec& mtime = s.st_mtimespec;
+#else
+    const struct timespec& mtime = s.st_mtim;
+#endif
+    st.valid    = true;
+    st.size     = static_cast<int64_t>(s.st_size);
+    st.mtime_ns = static_cast<int64_t>(mtime.tv_sec) * 1'000'000'000 + mtime.tv_nsec;
+    st.device   = static_cast<uint64_t>(s.st_dev);
+    st.inode    = static_cast<uint64_t>(s.st_ino);
+    return st;
+}
+
+int64_t StatCache::NowNs() {
+    struct timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+#endif
+
+// -------------------------------------------------------
+// Lookup / Record
+// -------------------------------------------------------
+
+std::string StatCache::Key(const fs::path& path) {
+    std::error_code ec;
+    fs::path abs = fs::absolute(path, ec);
+    return (ec ? path : abs).lexically_normal().string();
+}
+
+std::string StatCache::Lookup(const fs::path& path, FileStat* now) {
+    FileStat st = Stat(path);
+    if (now) *now = st;
+    if (!st.valid) return "";
+
+    StatEntry e;
+    if (!repo_.LoadStatEntry(Key(path), e)) return "";
+    return Matches(e, st) ? e.hash : "";
+}
+
+bool StatCache::Matches(const StatEntry& e, const FileStat& st) {
+    if (e.size != st.size || e.mtime_ns != st.mtime_ns
+        || e.device != st.device || e.inode != st.inode)
+        return false;
+
+    // Racy: the file was written so close to the moment it was
+    // hashed that a later write could share its timestamp
+    return e.mtime_ns <= e.cached_ns - kRacyWindowNs;
+}
+
+void StatCache::Record(const fs::path& path, const FileStat& seen, const std::string& hash) {
+    if (!seen.valid || hash.empty() || repo_.IsReadOnly()) return;
+    repo_.SaveStatEntry(Entry(path, seen, hash));   // best-effort — a missing row only costs a rehash
+}
+
+StatEntry StatCache::Entry(const fs::path& path, const FileStat& seen, const std::string& hash) const {
+    StatEntry e;
+    e.doc_path  = Key(path);
+    e.size      = seen.size;
+    e.mtime_ns  = seen.mtime_ns;
+    e.device    = seen.device;
+    e.inode     = seen.inode;
+    e.hash      = hash;
+    e.cached_ns = NowNs();
+    return e;
+}
+
+// -------------------------------------------------------
+// Preload / batch Lookup / RecordAll
+// -------------------------------------------------------
+
+Result StatCache::Preload() {
+    std::vector<StatEntry> rows;
+    Result r = repo_.LoadStatEntries(rows);
+    if (!r.ok) return r;
+    preloaded_.clear();
+    preloaded_.reserve(rows.size());
+    for (auto& e : rows) {
+        std::string key = e.doc_path;
+        preloaded_.emplace(std::move(key), std::move(e));
+    }
+    return Result::success();
+}
+
+std::string StatCache::Lookup(const fs::path& path, const FileStat& now) const {
+    if (!now.valid) return "";
+    auto it = preloaded_.find(Key(path));
+    return it != preloaded_.end() && Matches(it->second, now) ? it->second.hash : "";
+}
+
+void StatCache::RecordAll(const std::vector<StatEntry>& entries) {
+    if (repo_.IsReadOnly()) return;
+    Result r = repo_.SaveStatEntries(entries);   // best-effort, as Record
+    if (!r.ok) std::cerr << "[stat] " << r.err << "\n";
+}
+
+// -------------------------------------------------------
+// Hash
+// -------------------------------------------------------
+
+Result StatCache::Hash(const fs::path& path, std::string& hash, bool& from_cache) {
+    FileStat seen;
+    hash       = Lookup(path, &seen);
+    from_cache = !hash.empty();
+    if (from_cache) return Result::success();
+
+    Result r = HashContents(path, hash);
+    if (!r.ok) return r;
+    Record(path, seen, hash);
+    return Result::success();
+}
+
+Result StatCache::HashContents(const fs::path& path, std::string& hash) const {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return Result::failure("Cannot open for reading: " + path.string());
+
+    ContentHasher     hasher(repo_.GetHashAlgo());
+    std::vector<char> buf(1 << 20);
+    while (in) {
+        in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if (in.gcount() > 0) hasher.Update(buf.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) return Result::failure("Read error: " + path.string());
+
+    hash = hasher.HexDigest();
+    if (hash.empty()) return Result::failure("Failed to hash " + path.string());
+    return Result::success();
+}
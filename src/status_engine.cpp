@@ -0,0 +1,82 @@
+#include "status_engine.h"
+#include "repository.h"
+#include "blob_store.h"
+#include "stat_cache.h"
+#include "thread_pool.h"
+#include "tree_snapshot.h"
+
+#include <algorithm>
+
+StatusEngine::StatusEngine(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Run
+// -------------------------------------------------------
+
+Result StatusEngine::Run(WorkspaceStatus& status) {
+    status = {};
+
+    std::vector<WorkFile> files;
+    Result r = TreeSnapshot::Walk(repo_.ProjectDir(), files);
+    if (!r.ok) return r;
+    status.files = files.size();
+
+    TreeSnapshot snapshot(repo_);
+    r = snapshot.Latest(status.snapshot, status.have_snapshot);
+    if (!r.ok || !status.have_snapshot) return r;
+
+    Tree tree;
+    r = BlobStore(repo_).LoadTree(status.snapshot.hash, tree);
+    if (!r.ok) return r;
+
+    StatCache stat_cache(repo_);
+    r = stat_cache.Preload();
+    if (!r.ok) return r;
+
+    // Both lists are sorted by path: one merge pass pairs them up
+    // and settles the new and deleted files
+    struct Pair { const WorkFile* file; const TreeEntry* entry; };
+    std::vector<Pair> both;
+    size_t i = 0, j = 0;
+    while (i < files.size() || j < tree.size()) {
+        if (j == tree.size() || (i < files.size() && files[i].rel < tree[j].path)) {
+            status.changes.push_back({ FileChange::Kind::New, files[i++].rel });
+        } else if (i == files.size() || tree[j].path < files[i].rel) {
+            status.changes.push_back({ FileChange::Kind::Deleted, tree[j++].path });
+        } else {
+            both.push_back({ &files[i++], &tree[j++] });
+        }
+    }
+
+    // A cache lookup is a hash-map probe, so it runs in the same
+    // parallel pass as the reads it saves
+    const size_t             n = both.size();
+    std::vector<std::string> hashes(n);
+    std::vector<Result>      results(n);
+    std::vector<uint8_t>     hashed(n, 0);
+    ThreadPool::Shared().ParallelFor(n, [&](size_t k) {
+        const WorkFile& f = *both[k].file;
+        hashes[k] = stat_cache.Lookup(f.path, f.stat);
+        if (!hashes[k].empty() || f.stat.size != both[k].entry->size) return;
+        results[k] = stat_cache.HashContents(f.path, hashes[k]);
+        hashed[k]  = 1;
+    });
+
+    std::vector<StatEntry> recorded;
+    for (size_t k = 0; k < n; ++k) {
+        const WorkFile& f = *both[k].file;
+        if (!results[k].ok) return Result::failure(f.rel + ": " + results[k].err);
+        if (hashed[k]) {
+            recorded.push_back(stat_cache.Entry(f.path, f.stat, hashes[k]));
+            ++status.hashed;
+        }
+        // An empty hash here is a size mismatch — changed, unread
+        if (hashes[k] != both[k].entry->hash)
+            status.changes.push_back({ FileChange::Kind::Modified, f.rel });
+    }
+    stat_cache.RecordAll(recorded);
+
+    std::sort(status.changes.begin(), status.changes.end(),
+              [](const FileChange& a, const FileChange& b) { return a.path < b.path; });
+    return Result::success();
+}
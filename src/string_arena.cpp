@@ -0,0 +1,45 @@
+#include "string_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+char* StringArena::Allocate(size_t n) {
+    if (n > left_) {
+        // The rest of the current block is given up; with blocks
+        // doubling that wastes at most a few percent
+        size_t size = std::clamp(block_size_ * 2, kFirstBlock, kMaxBlock);
+        size        = std::max(size, n);
+        blocks_.push_back(std::make_unique<char[]>(size));
+        block_size_ = size;
+        next_       = blocks_.back().get();
+        left_       = size;
+    }
+    char* out = next_;
+    next_ += n;
+    left_ -= n;
+    return out;
+}
+
+std::string_view StringArena::Add(std::string_view s) {
+    if (s.empty()) return {};
+    char* out = Allocate(s.size());
+    std::memcpy(out, s.data(), s.size());
+    return {out, s.size()};
+}
+
+std::string_view StringArena::Intern(std::string_view s) {
+    auto it = interned_.find(s);
+    if (it != interned_.end()) return *it;
+    return *interned_.insert(Add(s)).first;
+}
+
+void StringArena::Clear() {
+    interned_.clear();
+    if (blocks_.empty()) return;
+
+    auto keep = std::move(blocks_.back());
+    blocks_.clear();
+    blocks_.push_back(std::move(keep));
+    next_ = blocks_.back().get();
+    left_ = block_size_;
+}
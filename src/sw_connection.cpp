@@ -166,21 +166,27 @@ Result SwConnection::GetActiveDocInfo(ActiveDocInfo& out) {
     if (FAILED(hr) || !sw_doc_)
         return Result::failure("No active document in SolidWorks");
 
+    ReadDocInfo(sw_doc_, out);
+    return Result::success();
+}
+
+// Path, title, type and dirty flag of any IModelDoc2
+void SwConnection::ReadDocInfo(IDispatch* doc, ActiveDocInfo& out) {
     // --- path ---
     VARIANT vPath; VariantInit(&vPath);
-    if (SUCCEEDED(Invoke(sw_doc_, L"GetPathName", DISPATCH_METHOD, &vPath)))
+    if (SUCCEEDED(Invoke(doc, L"GetPathName", DISPATCH_METHOD, &vPath)))
         out.path = FromBSTR(vPath.bstrVal);
     VariantClear(&vPath);
 
     // --- title ---
     VARIANT vTitle; VariantInit(&vTitle);
-    if (SUCCEEDED(Invoke(sw_doc_, L"GetTitle", DISPATCH_METHOD, &vTitle)))
+    if (SUCCEEDED(Invoke(doc, L"GetTitle", DISPATCH_METHOD, &vTitle)))
         out.title = FromBSTR(vTitle.bstrVal);
     VariantClear(&vTitle);
 
     // --- type (GetType returns swDocPART=1, swDocASSEMBLY=2, swDocDRAWING=3) ---
     VARIANT vType; VariantInit(&vType);
-    if (SUCCEEDED(Invoke(sw_doc_, L"GetType", DISPATCH_METHOD, &vType))) {
+    if (SUCCEEDED(Invoke(doc, L"GetType", DISPATCH_METHOD, &vType))) {
         switch (vType.lVal) {
             case 1:  out.type = "Part";     break;
             case 2:  out.type = "Assembly"; break;
@@ -192,10 +198,64 @@ Result SwConnection::GetActiveDocInfo(ActiveDocInfo& out) {
 
     // --- dirty flag ---
     VARIANT vDirty; VariantInit(&vDirty);
-    if (SUCCEEDED(Invoke(sw_doc_, L"GetSaveFlag", DISPATCH_METHOD, &vDirty)))
+    if (SUCCEEDED(Invoke(doc, L"GetSaveFlag", DISPATCH_METHOD, &vDirty)))
         out.is_dirty = (vDirty.boolVal != VARIANT_FALSE);
     VariantClear(&vDirty);
+}
+
+// -------------------------------------------------------
+// ListOpenDocs / SelectDoc
+// -------------------------------------------------------
+Result SwConnection::ListOpenDocs(std::vector<ActiveDocInfo>& out) {
+    out.clear();
+    if (!connected_) return Result::failure("Not connected to SolidWorks");
+
+    // GetDocuments returns every loaded IModelDoc2 as a SAFEARRAY,
+    // of VARIANTs or directly of IDispatch pointers by SW version
+    VARIANT vDocs; VariantInit(&vDocs);
+    HRESULT hr = Invoke(sw_app_, L"GetDocuments", DISPATCH_METHOD, &vDocs);
+    if (FAILED(hr) || !(vDocs.vt & VT_ARRAY) || !vDocs.parray) {
+        VariantClear(&vDocs);
+        return Result::failure("GetDocuments() failed");
+    }
 
+    LONG lo = 0, hi = -1;
+    SafeArrayGetLBound(vDocs.parray, 1, &lo);
+    SafeArrayGetUBound(vDocs.parray, 1, &hi);
+    void* data = nullptr;
+    if (SUCCEEDED(SafeArrayAccessData(vDocs.parray, &data))) {
+        for (LONG i = 0; i <= hi - lo; ++i) {
+            IDispatch* doc = (vDocs.vt & VT_TYPEMASK) == VT_DISPATCH
+                ? static_cast<IDispatch**>(data)[i]
+                : static_cast<VARIANT*>(data)[i].vt == VT_DISPATCH
+                    ? static_cast<VARIANT*>(data)[i].pdispVal : nullptr;
+            if (!doc) continue;
+            ActiveDocInfo info{};
+            ReadDocInfo(doc, info);
+            out.push_back(std::move(info));
+        }
+        SafeArrayUnaccessData(vDocs.parray);
+    }
+    VariantClear(&vDocs);
+    return Result::success();
+}
+
+Result SwConnection::SelectDoc(const std::string& path) {
+    if (!connected_) return Result::failure("Not connected to SolidWorks");
+
+    VARIANT vPath; VariantInit(&vPath);
+    vPath.vt      = VT_BSTR;
+    vPath.bstrVal = ToBSTR(path);
+    VARIANT vDoc; VariantInit(&vDoc);
+    HRESULT hr = Invoke(sw_app_, L"GetOpenDocumentByName", DISPATCH_METHOD, &vDoc, 1, vPath);
+    SysFreeString(vPath.bstrVal);
+
+    if (FAILED(hr) || vDoc.vt != VT_DISPATCH || !vDoc.pdispVal) {
+        VariantClear(&vDoc);
+        return Result::failure("Not open in SolidWorks: " + path);
+    }
+    if (sw_doc_) sw_doc_->Release();
+    sw_doc_ = vDoc.pdispVal;   // takes over the VARIANT's reference
     return Result::success();
 }
 
@@ -228,12 +288,20 @@ Result SwConnection::CloseActiveDoc(bool force_close) {
     ActiveDocInfo info;
     if (!GetActiveDocInfo(info).ok)
         return Result::failure("No active document to close");
+    return CloseDoc(info.path);
+}
+
+// -------------------------------------------------------
+// CloseDoc
+// -------------------------------------------------------
+Result SwConnection::CloseDoc(const std::string& path) {
+    if (!connected_) return Result::failure("Not connected");
 
     // CloseDoc(string path)
     VARIANT vPath;
     VariantInit(&vPath);
     vPath.vt      = VT_BSTR;
-    vPath.bstrVal = ToBSTR(info.path);
+    vPath.bstrVal = ToBSTR(path);
 
     HRESULT hr = Invoke(sw_app_, L"CloseDoc", DISPATCH_METHOD, nullptr, 1, vPath);
     SysFreeString(vPath.bstrVal);
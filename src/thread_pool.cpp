@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        workers_.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;   // stopping and drained
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
+
+// -------------------------------------------------------
+// ParallelFor
+// -------------------------------------------------------
+// Items are claimed from a shared counter.  Helpers posted to
+// the pool and the calling thread all claim until none are
+// left; the caller then waits only for items already running.
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (count == 1 || Size() <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t>     next{0};
+        size_t                  done = 0;
+        std::mutex              mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+
+    auto run = [state, count, &fn] {
+        size_t finished = 0;
+        for (size_t i; (i = state->next.fetch_add(1)) < count; ++finished)
+            fn(i);
+        if (finished == 0) return;
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->done += finished;
+        if (state->done == count) state->cv.notify_all();
+    };
+
+    size_t helpers = std::min<size_t>(Size(), count - 1);
+    for (size_t h = 0; h < helpers; ++h) Post(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done == count; });
+}
@@ -0,0 +1,203 @@
+#include "tree_snapshot.h"
+#include "repository.h"
+#include "blob_store.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+#include <unordered_map>
+
+namespace {
+
+// One directory: its SolidWorks files here, then each subdirectory
+// as a task of its own (ParallelFor may nest — the caller takes
+// items too), appended in name order once they are all done
+Result WalkDir(const fs::path& root, const fs::path& dir, std::vector<WorkFile>& out) {
+    std::vector<fs::path> subdirs;
+    std::error_code       ec;
+    fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        const fs::path& p    = it->path();
+        std::string     name = p.filename().string();
+        std::error_code type_ec;
+        if (it->is_directory(type_ec)) {
+            // never snapshot a repository's own store, nor follow links out of the project
+            if (name != ".swvcs" && !it->is_symlink(type_ec)) subdirs.push_back(p);
+            continue;
+        }
+        // ~$bracket.SLDPRT is the lock file SolidWorks keeps next to an open document
+        if (Utils::SwDocType(name).empty() || name.rfind("~$", 0) == 0
+            || !it->is_regular_file(type_ec))
+            continue;
+
+        WorkFile f;
+        f.path = p;
+        f.rel  = p.lexically_relative(root).generic_string();
+        f.stat = StatCache::Stat(p);
+        if (!f.stat.valid) return Result::failure("Cannot stat: " + p.string());
+        out.push_back(std::move(f));
+    }
+    if (ec) return Result::failure("Cannot list " + dir.string() + ": " + ec.message());
+
+    std::sort(subdirs.begin(), subdirs.end());
+    std::vector<std::vector<WorkFile>> found(subdirs.size());
+    std::vector<Result>                results(subdirs.size());
+    ThreadPool::Shared().ParallelFor(subdirs.size(), [&](size_t i) {
+        results[i] = WalkDir(root, subdirs[i], found[i]);
+    });
+    for (size_t i = 0; i < subdirs.size(); ++i) {
+        if (!results[i].ok) return results[i];
+        std::move(found[i].begin(), found[i].end(), std::back_inserter(out));
+    }
+    return Result::success();
+}
+
+} // namespace
+
+TreeSnapshot::TreeSnapshot(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Walk
+// -------------------------------------------------------
+
+Result TreeSnapshot::Walk(const fs::path& root, std::vector<WorkFile>& out) {
+    out.clear();
+    std::error_code ec;
+    if (!fs::is_directory(root, ec))
+        return Result::failure("Not a directory: " + root.string());
+
+    Result r = WalkDir(root, root, out);
+    if (!r.ok) return r;
+
+    // Tree order: by relative path, byte for byte
+    std::sort(out.begin(), out.end(),
+              [](const WorkFile& a, const WorkFile& b) { return a.rel < b.rel; });
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Latest
+// -------------------------------------------------------
+
+Result TreeSnapshot::Latest(::Commit& c, bool& found) {
+    // Usually HEAD.  Otherwise a project snapshot's document is the
+    // project folder, so the newest is the first row of that
+    // document's history (timestamps are whole seconds, which is
+    // why HEAD goes first: two snapshots in one second tie there)
+    std::string head = repo_.GetHead();
+    found = !head.empty() && repo_.LoadCommit(head, c).ok && c.IsTree();
+    if (found) return Result::success();
+
+    CommitQuery query;
+    query.doc_path = repo_.ProjectDir().string();
+    query.limit    = 1;
+    auto newest    = repo_.ListCommits(query);
+    found = !newest.empty() && newest.front().IsTree();
+    if (found) c = std::move(newest.front());
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Build
+// -------------------------------------------------------
+
+Result TreeSnapshot::Build(Tree& tree, std::string& hash, TreeStats& stats) {
+    stats = {};
+    tree.clear();
+
+    std::vector<WorkFile> files;
+    Result r = Walk(repo_.ProjectDir(), files);
+    if (!r.ok) return r;
+
+    StatCache stat_cache(repo_);
+    r = stat_cache.Preload();
+    if (!r.ok) return r;
+
+    // Each file's entry in the previous snapshot: its delta base
+    ::Commit                                     latest;
+    bool                                         have_latest = false;
+    std::unordered_map<std::string, std::string> previous;
+    BlobStore                                    store(repo_);
+    r = Latest(latest, have_latest);
+    if (!r.ok) return r;
+    if (have_latest) {
+        Tree old;
+        if (store.LoadTree(latest.hash, old).ok)
+            for (auto& e : old) previous.emplace(std::move(e.path), std::move(e.hash));
+    }
+
+    // The stat cache check is a hash-map lookup and the store
+    // check an exists(), so they go in the same parallel pass
+    // as the reads they save
+    const size_t             n = files.size();
+    std::vector<std::string> hashes(n);
+    std::vector<StoreStats>  stored(n);
+    std::vector<Result>      results(n);
+    std::vector<uint8_t>     hashed(n, 0);
+    ThreadPool::Shared().ParallelFor(n, [&](size_t i) {
+        const WorkFile& f = files[i];
+        hashes[i] = stat_cache.Lookup(f.path, f.stat);
+        if (!hashes[i].empty() && store.Has(hashes[i])) return;
+
+        auto base  = previous.find(f.rel);
+        results[i] = store.Store(f.path, hashes[i], stored[i],
+                                 base == previous.end() ? "" : base->second);
+        hashed[i]  = 1;
+    });
+
+    std::vector<StatEntry> recorded;
+    tree.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const WorkFile& f = files[i];
+        if (!results[i].ok) return Result::failure(f.rel + ": " + results[i].err);
+        if (hashed[i]) {
+            recorded.push_back(stat_cache.Entry(f.path, f.stat, hashes[i]));
+            ++stats.hashed;
+            stats.written_bytes += stored[i].written_bytes;
+        }
+        stats.logical_bytes += f.stat.size;
+        tree.push_back({ f.rel, hashes[i], f.stat.size, f.stat.mtime_ns });
+    }
+    stat_cache.RecordAll(recorded);
+    stats.files = n;
+
+    int64_t written = 0;
+    r = store.StoreTree(tree, hash, written);
+    if (!r.ok) return r;
+    stats.written_bytes += written;
+    return Result::success();
+}
+
+// -------------------------------------------------------
+// Commit
+// -------------------------------------------------------
+
+Result TreeSnapshot::Commit(const std::string& message, TreeStats& stats) {
+    Tree        tree;
+    std::string hash;
+    Result r = Build(tree, hash, stats);
+    if (!r.ok) return r;
+    if (tree.empty())
+        return Result::failure("No SolidWorks files under " + repo_.ProjectDir().string());
+
+    ::Commit latest;
+    bool     have_latest = false;
+    r = Latest(latest, have_latest);
+    if (!r.ok) return r;
+    if (have_latest && latest.hash == hash)
+        return Result::failure("Nothing changed since project snapshot " + hash.substr(0, 8) + ".");
+
+    ::Commit c;
+    c.hash        = hash;
+    c.message     = message;
+    c.timestamp   = Utils::FormatTimestamp(static_cast<int64_t>(std::time(nullptr)));
+    c.parent_hash = repo_.GetHead();
+    c.author      = Utils::UserName();
+    c.sw_meta.doc_path          = repo_.ProjectDir().string();
+    c.sw_meta.doc_type          = ::Commit::kTreeType;
+    c.sw_meta.blob_size_bytes   = stats.logical_bytes;
+    c.sw_meta.stored_size_bytes = stats.written_bytes;
+    return repo_.SaveCommits({ c }, c.hash);
+}
@@ -0,0 +1,172 @@
+#include "trend_cache.h"
+#include "repository.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+struct MetricInfo {
+    const char* name;
+    const char* unit;
+};
+
+// Indexed by Metric
+constexpr MetricInfo kMetrics[kMetricCount] = {
+    { "mass",          "kg" },
+    { "volume",        "m^3" },
+    { "surface_area",  "m^2" },
+    { "bbox_x",        "mm" },
+    { "bbox_y",        "mm" },
+    { "bbox_z",        "mm" },
+    { "feature_count", ""   },
+};
+
+} // namespace
+
+const char* MetricName(Metric m) { return kMetrics[static_cast<size_t>(m)].name; }
+const char* MetricUnit(Metric m) { return kMetrics[static_cast<size_t>(m)].unit; }
+
+bool ParseMetric(const std::string& name, Metric& out) {
+    for (size_t i = 0; i < kMetricCount; ++i) {
+        if (Utils::IEquals(name, kMetrics[i].name)) {
+            out = static_cast<Metric>(i);
+            return true;
+        }
+    }
+    // The spellings 'swvcs log' prints
+    if (Utils::IEquals(name, "features"))    { out = Metric::FeatureCount; return true; }
+    if (Utils::IEquals(name, "surfacearea")) { out = Metric::SurfaceArea;  return true; }
+    return false;
+}
+
+TrendCache::TrendCache(Repository& repo) : repo_(repo) {}
+
+// -------------------------------------------------------
+// Sync
+// -------------------------------------------------------
+
+void TrendCache::Clear() {
+    seq_ = 0;
+    series_.clear();
+    known_.clear();
+}
+
+void TrendCache::Add(const CommitMetrics& m) {
+    Series& s = series_[m.doc_id];
+    if (!s.time.empty() && m.time < s.time.back()) s.sorted = false;
+    s.time.push_back(m.time);
+    s.hash.push_back(m.hash);
+    for (size_t i = 0; i < kMetricCount; ++i) s.values[i].push_back(m.values[i]);
+}
+
+Result TrendCache::Sync() {
+    if (repo_.GetHashAlgo() != algo_) {
+        Clear();
+        algo_ = repo_.GetHashAlgo();
+    }
+
+    // A re-saved commit (INSERT OR REPLACE) comes back with a new
+    // row id; its old values are somewhere in a column already, so
+    // start over rather than hunt for them
+    std::vector<CommitMetrics> newer;
+    bool                       resaved = false;
+    Result r = repo_.ForEachCommitMetrics(seq_, [&](const CommitMetrics& m) {
+        resaved = resaved || known_.count(m.hash) > 0;
+        newer.push_back(m);
+    });
+    if (!r.ok) return r;
+
+    if (resaved) {
+        Clear();
+        newer.clear();
+        r = repo_.ForEachCommitMetrics(0, [&](const CommitMetrics& m) { newer.push_back(m); });
+        if (!r.ok) return r;
+    }
+    for (const auto& m : newer) {
+        seq_ = std::max(seq_, m.seq);
+        known_.insert(m.hash);
+        Add(m);
+    }
+    return Result::success();
+}
+
+void TrendCache::Sort(Series& s) {
+    if (s.sorted) return;
+
+    // Commits imported later can be older than the ones already
+    // read: order by (time, hash), as 'swvcs log' does, then apply
+    // the same permutation to every column
+    std::vector<size_t> order(s.time.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return s.time[a] != s.time[b] ? s.time[a] < s.time[b] : s.hash[a] < s.hash[b];
+    });
+
+    auto permute = [&](auto& column) {
+        std::remove_reference_t<decltype(column)> sorted;
+        sorted.reserve(column.size());
+        for (size_t i : order) sorted.push_back(std::move(column[i]));
+        column = std::move(sorted);
+    };
+    permute(s.time);
+    permute(s.hash);
+    for (auto& column : s.values) permute(column);
+    s.sorted = true;
+}
+
+// -------------------------------------------------------
+// Analyse
+// -------------------------------------------------------
+
+Result TrendCache::Analyse(const std::string& doc_path, Metric metric, double threshold,
+                           int64_t since, TrendReport& out) {
+    out = TrendReport{};
+
+    Result r = Sync();
+    if (!r.ok) return r;
+
+    int64_t doc_id = repo_.FindDocument(doc_path);
+    auto    it     = series_.find(doc_id);
+    if (doc_id == 0 || it == series_.end()) return Result::success();   // no commits
+    Series& s = it->second;
+    Sort(s);
+
+    // Window, then drop the commits that didn't capture the value
+    // (0 — no SolidWorks connection, or a property the file lacks)
+    const size_t        first  = std::lower_bound(s.time.begin(), s.time.end(), since) - s.time.begin();
+    const double*       column = s.values[static_cast<size_t>(metric)].data();
+    std::vector<size_t> rows;
+    rows.reserve(s.time.size() - first);
+    for (size_t i = first; i < s.time.size(); ++i)
+        if (column[i] != 0.0) rows.push_back(i);
+    const size_t n = rows.size();
+    if (n == 0) return Result::success();
+
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; ++i) values[i] = column[rows[i]];
+
+    // The scans below are straight loops over contiguous doubles
+    // with no branches in the body, which the compiler vectorizes
+    std::vector<double> change(n, 0.0);
+    for (size_t i = 1; i < n; ++i) change[i] = values[i] / values[i - 1] - 1.0;
+
+    std::vector<uint8_t> flagged(n);
+    for (size_t i = 0; i < n; ++i) flagged[i] = std::fabs(change[i]) > threshold;
+
+    out.min = static_cast<size_t>(std::min_element(values.begin(), values.end()) - values.begin());
+    out.max = static_cast<size_t>(std::max_element(values.begin(), values.end()) - values.begin());
+
+    out.steps.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        TrendStep& step = out.steps[i];
+        step.time   = s.time[rows[i]];
+        step.hash   = s.hash[rows[i]];
+        step.value  = values[i];
+        step.change = change[i];
+        if (flagged[i]) out.regressions.push_back(i);
+    }
+    return Result::success();
+}
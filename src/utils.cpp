@@ -4,6 +4,8 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
 
 namespace Utils {
 
@@ -11,8 +13,13 @@ void PrintCommit(const Commit& c, bool show_full_hash) {
     std::string display_hash = show_full_hash ? c.hash : c.hash.substr(0, 8);
     std::cout << "commit " << display_hash << "\n"
               << "Author:  " << c.author    << "\n"
-              << "Date:    " << c.timestamp << "\n"
-              << "File:    " << c.sw_meta.doc_path << " (" << c.sw_meta.doc_type << ")\n";
+              << "Date:    " << c.timestamp << "\n";
+    if (c.IsGroup())
+        std::cout << "Files:   group commit ('swvcs show " << display_hash << "' lists them)\n";
+    else if (c.IsTree())
+        std::cout << "Files:   project snapshot of " << c.sw_meta.doc_path << "\n";
+    else
+        std::cout << "File:    " << c.sw_meta.doc_path << " (" << c.sw_meta.doc_type << ")\n";
 
     if (c.sw_meta.mass > 0 || c.sw_meta.volume > 0) {
         std::cout << std::fixed << std::setprecision(4)
@@ -35,6 +42,84 @@ std::string FormatBytes(uintmax_t bytes) {
     return oss.str();
 }
 
+std::string ToHex(const uint8_t* bytes, size_t len) {
+    std::string out(len * 2, '\0');
+    ToHex(bytes, len, out.data());
+    return out;
+}
+
+void ToHex(const uint8_t* bytes, size_t len, char* out) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; ++i) {
+        out[2 * i]     = kDigits[bytes[i] >> 4];
+        out[2 * i + 1] = kDigits[bytes[i] & 0x0f];
+    }
+}
+
+bool ParseTimestamp(const std::string& iso, int64_t& epoch) {
+    int  y = 0, mo = 0, d = 0, h = 0, mi = 0, s = 0;
+    char tail[2] = {};
+    int  n = std::sscanf(iso.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%1s", &y, &mo, &d, &h, &mi, &s, tail);
+    if (n != 3 && n != 5 && n != 6 && !(n == 7 && tail[0] == 'Z')) return false;
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || s > 60) return false;
+
+    // Days since 1970-01-01 of a proleptic Gregorian date
+    // (Howard Hinnant's days_from_civil)
+    y -= mo <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+
+    epoch = days * 86400 + h * 3600 + mi * 60 + s;
+    return true;
+}
+
+std::string FormatDate(int64_t epoch) {
+    // The inverse: civil_from_days
+    int64_t days = (epoch >= 0 ? epoch : epoch - 86399) / 86400 + 719468;
+    int64_t era  = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe  = days - era * 146097;
+    int64_t yoe  = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy  = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp   = (5 * doy + 2) / 153;
+    int64_t d    = doy - (153 * mp + 2) / 5 + 1;
+    int64_t mo   = mp < 10 ? mp + 3 : mp - 9;
+    int64_t y    = yoe + era * 400 + (mo <= 2);
+
+    char out[16];
+    std::snprintf(out, sizeof out, "%04d-%02d-%02d",
+                  static_cast<int>(y), static_cast<int>(mo), static_cast<int>(d));
+    return out;
+}
+
+std::string FormatTimestamp(int64_t epoch) {
+    int64_t secs = ((epoch % 86400) + 86400) % 86400;
+    char    out[32];
+    std::snprintf(out, sizeof out, "%sT%02d:%02d:%02dZ", FormatDate(epoch).c_str(),
+                  static_cast<int>(secs / 3600), static_cast<int>(secs / 60 % 60),
+                  static_cast<int>(secs % 60));
+    return out;
+}
+
+bool FromHex(const std::string& hex, uint8_t* out, size_t len) {
+    if (hex.size() != len * 2) return false;
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < len; ++i) {
+        int hi = nibble(hex[2 * i]);
+        int lo = nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
 std::string Trim(const std::string& s) {
     size_t start = s.find_first_not_of(" \t\r\n");
     size_t end   = s.find_last_not_of(" \t\r\n");
@@ -49,4 +134,21 @@ bool IEquals(const std::string& a, const std::string& b) {
     });
 }
 
+std::string SwDocType(const std::string& filename) {
+    auto has_ext = [&](const char* ext) {
+        size_t n = std::char_traits<char>::length(ext);
+        return filename.size() > n && IEquals(filename.substr(filename.size() - n), ext);
+    };
+    if (has_ext(".sldprt")) return "Part";
+    if (has_ext(".sldasm")) return "Assembly";
+    if (has_ext(".slddrw")) return "Drawing";
+    return "";
+}
+
+std::string UserName() {
+    for (const char* var : { "USERNAME", "USER" })
+        if (const char* name = std::getenv(var)) return name;
+    return "";
+}
+
 } // namespace Utils
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "watch_engine.h"
+#include "repository.h"
+#include "blob_store.h"
+#include "stat_cache.h"
+#include "thread_pool.h"
+#include "tree_snapshot.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A file being written, until it has been quiet for the debounce
+struct Pending {
+    fs::path          path;
+    FileStat          seen;              // at the last write
+    Clock::time_point due;
+    bool              deferred = false;  // found the queue full (logged once)
+};
+
+bool IsDocument(const fs::path& p) {
+    // ~$bracket.SLDPRT is the lock file SolidWorks keeps next to an open document
+    std::string name = p.filename().string();
+    if (Utils::SwDocType(name).empty() || name.rfind("~$", 0) == 0) return false;
+    for (const auto& part : p)
+        if (part == ".swvcs") return false;
+    return true;
+}
+
+bool SameStat(const FileStat& a, const FileStat& b) {
+    return a.size == b.size && a.mtime_ns == b.mtime_ns && a.device == b.device && a.inode == b.inode;
+}
+
+} // namespace
+
+WatchEngine::WatchEngine(Repository& repo) : repo_(repo) {}
+
+void WatchEngine::Stop() {
+    stop_ = true;
+    watcher_.Interrupt();
+}
+
+// -------------------------------------------------------
+// Run
+// -------------------------------------------------------
+
+Result WatchEngine::Run(const WatchOptions& options, WatchStats& stats) {
+    stats = {};
+    Result r = watcher_.Open(repo_.ProjectDir());
+    if (!r.ok) return r;
+
+    const auto   debounce  = std::chrono::milliseconds(std::max(options.debounce_ms, 0));
+    const auto   interval  = std::chrono::seconds(std::max(options.interval_s, 0));
+    const size_t max_queue = std::max<size_t>(options.max_queue, 1);
+
+    // The commit thread takes the whole queue at a time, so a save
+    // of an assembly and its parts becomes one transaction
+    std::mutex                      mutex;   // guards queue, queued, stopping and stats
+    std::condition_variable         cv;
+    std::vector<fs::path>           queue;
+    std::unordered_set<std::string> queued;
+    bool                            stopping = false;
+    std::thread committer([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            cv.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;   // stopping, and everything committed
+            std::vector<fs::path> batch;
+            batch.swap(queue);
+            queued.clear();
+            lock.unlock();
+
+            WatchStats done;
+            CommitBatch(batch, done);
+            lock.lock();
+            stats.commits   += done.commits;
+            stats.unchanged += done.unchanged;
+            stats.failed    += done.failed;
+        }
+    });
+
+    std::cout << "[watch] Watching " << repo_.ProjectDir().string() << " (quiet time "
+              << debounce.count() << " ms, at most one commit per file every "
+              << interval.count() << " s)\n";
+
+    std::unordered_map<std::string, Pending>           pending;       // by path
+    std::unordered_map<std::string, Clock::time_point> last_queued;   // by path
+    while (!stop_) {
+        // Sleep until the next file is due, or indefinitely when
+        // nothing is pending
+        int timeout_ms = -1;
+        if (!pending.empty()) {
+            auto next = std::min_element(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+                return a.second.due < b.second.due;
+            })->second.due;
+            auto ms = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+            timeout_ms = static_cast<int>(std::clamp<int64_t>(ms, 0, INT_MAX));
+        }
+
+        WatchBatch batch;
+        r = watcher_.Wait(timeout_ms, batch);
+        if (!r.ok || batch.interrupted) break;
+        if (batch.overflow) {
+            // The OS dropped events: every file may have changed
+            std::cerr << "[watch] Too many changes at once, rescanning the project folder\n";
+            std::vector<WorkFile> files;
+            if (TreeSnapshot::Walk(repo_.ProjectDir(), files).ok)
+                for (auto& f : files) batch.paths.push_back(std::move(f.path));
+        }
+
+        auto now = Clock::now();
+        for (auto& p : batch.paths) {
+            if (!IsDocument(p)) continue;
+            Pending& e = pending[p.lexically_normal().string()];
+            e.path = std::move(p);
+            e.seen = StatCache::Stat(e.path);
+            e.due  = now + debounce;
+        }
+
+        for (auto it = pending.begin(); it != pending.end();) {
+            Pending& e = it->second;
+            if (e.due > now) {
+                ++it;
+                continue;
+            }
+            // Written since the last event (a network share may not
+            // report every write): wait again
+            FileStat st = StatCache::Stat(e.path);
+            if (!st.valid) {   // deleted, or renamed away
+                it = pending.erase(it);
+                continue;
+            }
+            if (!SameStat(st, e.seen)) {
+                e.seen = st;
+                e.due  = now + debounce;
+                ++it;
+                continue;
+            }
+            auto last = last_queued.find(it->first);
+            if (last != last_queued.end() && now < last->second + interval) {
+                e.due = last->second + interval;
+                ++it;
+                continue;
+            }
+
+            bool taken = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (queued.count(it->first)) {
+                    taken = true;
+                } else if (queue.size() < max_queue) {
+                    queue.push_back(e.path);
+                    queued.insert(it->first);
+                    taken = true;
+                } else if (!e.deferred) {
+                    e.deferred = true;
+                    ++stats.deferred;
+                    std::cerr << "[watch] " << queue.size() << " files waiting to be committed, "
+                              << e.path.filename().string() << " waits its turn\n";
+                }
+            }
+            if (!taken) {
+                e.due = now + debounce;
+                ++it;
+                continue;
+            }
+            cv.notify_one();
+            last_queued[it->first] = now;
+            it = pending.erase(it);
+        }
+    }
+
+    watcher_.Close();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (!queue.empty())
+            std::cout << "[watch] Stopping: committing " << queue.size() << " queued files first...\n";
+    }
+    cv.notify_one();
+    committer.join();
+    return r;
+}
+
+// -------------------------------------------------------
+// CommitBatch
+// -------------------------------------------------------
+
+void WatchEngine::CommitBatch(const std::vector<fs::path>& files, WatchStats& stats) {
+    struct Item {
+        fs::path    path;
+        FileStat    seen;
+        std::string hash;
+        std::string base;       // the file's last commit ("" = none)
+        StoreStats  stored;
+        Result      result;
+        bool        cached = false;
+    };
+    std::vector<Item> items(files.size());
+
+    // The stat cache, and each file's last commit as its delta
+    // base — database reads, so before going parallel
+    BlobStore store(repo_);
+    StatCache stat_cache(repo_);
+    for (size_t i = 0; i < files.size(); ++i) {
+        Item& item = items[i];
+        item.path  = files[i];
+        item.hash  = stat_cache.Lookup(item.path, &item.seen);
+        if (!item.hash.empty() && store.Has(item.hash)) {
+            item.cached                = true;
+            item.stored.already_stored = true;
+            item.stored.logical_bytes  = item.seen.size;
+        }
+        CommitQuery last;
+        last.doc_path = item.path.string();
+        last.limit    = 1;
+        auto prev = repo_.ListCommits(last);
+        if (!prev.empty()) item.base = prev.front().hash;
+    }
+
+    ThreadPool::Shared().ParallelFor(items.size(), [&](size_t i) {
+        Item& item = items[i];
+        if (!item.cached) item.result = store.Store(item.path, item.hash, item.stored, item.base);
+    });
+
+    std::string parent    = repo_.GetHead();
+    std::string timestamp = Utils::FormatTimestamp(static_cast<int64_t>(std::time(nullptr)));
+    std::string author    = Utils::UserName();
+    std::vector<Commit>             commits;
+    std::unordered_set<std::string> committed;
+    for (const Item& item : items) {
+        std::string rel = item.path.lexically_relative(repo_.ProjectDir()).generic_string();
+        if (!item.result.ok) {
+            ++stats.failed;
+            std::cerr << "[watch] Cannot store " << rel << ": " << item.result.err << "\n";
+            continue;
+        }
+        if (!item.cached) stat_cache.Record(item.path, item.seen, item.hash);
+
+        // Saved without changes, or back to a version already
+        // committed (a revert, an undone edit)
+        Commit existing;
+        if (item.hash == item.base || committed.count(item.hash)
+            || repo_.LoadCommit(item.hash, existing).ok) {
+            ++stats.unchanged;
+            continue;
+        }
+
+        Commit c;
+        c.hash        = item.hash;
+        c.message     = "Auto-commit: saved " + item.path.filename().string();
+        c.timestamp   = timestamp;
+        c.parent_hash = parent;
+        c.author      = author;
+        c.sw_meta.doc_path          = item.path.string();
+        c.sw_meta.doc_type          = Utils::SwDocType(item.path.filename().string());
+        c.sw_meta.blob_size_bytes   = item.stored.logical_bytes;
+        c.sw_meta.stored_size_bytes = item.stored.written_bytes;
+        std::cout << "[watch] " << c.hash.substr(0,8) << "  " << rel << " ("
+                  << Utils::FormatBytes(static_cast<uintmax_t>(item.stored.written_bytes))
+                  << " written)\n";
+        committed.insert(c.hash);
+        parent = c.hash;
+        commits.push_back(std::move(c));
+    }
+    if (commits.empty()) return;
+
+    Result r = repo_.SaveCommits(commits, parent);
+    if (!r.ok) {
+        stats.failed += commits.size();
+        std::cerr << "[watch] Commit failed: " << r.err << "\n";
+        return;
+    }
+    stats.commits += commits.size();
+}